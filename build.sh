@@ -42,11 +42,11 @@ mkdir "$DIST_ROOT"
 
 if [[ -z $SB_DEBUG ]]; then
     gcc -c $SB_VERBOSE ./s_buffer.c -o ./s_buffer.o -fPIC -v &&      \
-    gcc -shared ./s_buffer.o -o "$DIST_ROOT/libsbuffer.so" -lm -v && \
+    gcc -shared ./s_buffer.o -o "$DIST_ROOT/libsbuffer.so" -lm -pthread -v && \
     rm -rf ./s_buffer.o
 else
     gcc -shared $SB_DEBUG $SB_VERBOSE \
         ./s_buffer.c                  \
         -o "$DIST_ROOT/libsbuffer.so" \
-        -lm -fPIC -v -g
+        -lm -pthread -fPIC -v -g
 fi
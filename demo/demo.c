@@ -423,21 +423,23 @@ void DrawAxes ()
     DrawLineBresenham(ox - 2, z - 5, ox + 2, z - 5, 0xffffffff); //
 }
 
-void DrawSpan (const span_t* span)
+void DrawSpan (const sbuffer_t* sbuffer, const span_t* span)
 {
+    const color_t color = SB_PRIM(sbuffer, span)->color;
+
     /* fill out the "S-buffer representation" */
     const int screen_x0 = ceil(span->x0 - 0.5);
     const int screen_width = ceil(span->x1 - 0.5) - screen_x0;
-    FillRect(screen_x0, WIN_H, screen_width, S_BUFFER_REPR_H, span->color);
+    FillRect(screen_x0, WIN_H, screen_width, S_BUFFER_REPR_H, color);
 
     // draw the segment in "screen space", i.e., onto the projection plane
-    FillRect(screen_x0, PROJ_PLANE_Y, screen_width, 1, span->color);
+    FillRect(screen_x0, PROJ_PLANE_Y, screen_width, 1, color);
 }
 
 size_t
 DrawSBufferDfs
 ( sbuffer_t* sbuffer,
-  void       (*drawhook) (const span_t* span) )
+  void       (*drawhook) (const sbuffer_t* sbuffer, const span_t* span) )
 {
     // draw the background for the "S-Buffer representation"
     FillRect(0, WIN_H, BUFFER_W, S_BUFFER_REPR_H, 0xffffffff);
@@ -464,7 +466,7 @@ DrawSBufferDfs
         else if (cp < 2 && curr->next)
         {
             ++count;
-            drawhook(curr);
+            drawhook(sbuffer, curr);
 
             cp = 0; // reset child pointer as we're about to enter a new subtree
             *(bookmarks + sp - 1) = 1; // update parent's bookmark to `next`
@@ -478,7 +480,7 @@ DrawSBufferDfs
             if (!curr->next)
             {
                 ++count;
-                drawhook(curr);
+                drawhook(sbuffer, curr);
             }
 
             curr = *(stack + --sp);
@@ -489,7 +491,7 @@ DrawSBufferDfs
             if (!curr->next)    //
             {                   // we need to account for cases where the
                 ++count;        // S-Buffer only has a single `prev` child
-                drawhook(curr); // and a maximum depth of one
+                drawhook(sbuffer, curr); // and a maximum depth of one
             }                   //
 
             curr = 0; // exit condition
@@ -633,23 +635,6 @@ Update
         seg.dst.y = CLAMP(seg.dst.y, 0, PROJ_PLANE_Y);
         *(segs + head++) = seg; // store in the world space segments list
 
-        /* store the segment in the s-buffer for any potential clipping to take
-         * place appropriately
-         */
-        float screen_src = S_ToScreenSpace(&seg.src, BUFFER_W_2, WIN_H, Z_NEAR);
-        float screen_dst = S_ToScreenSpace(&seg.dst, BUFFER_W_2, WIN_H, Z_NEAR);
-        /* sort the endpoints in ascending screen space x before pushing the
-         * segment onto the buffer
-         */
-        float screen_x0, screen_x1, screen_w0, screen_w1;
-        const byte_t src_min = screen_src <= screen_dst;
-        screen_x0 = src_min * screen_src + !src_min * screen_dst;
-        screen_w0 = src_min * S_ZToScreenSpace(seg.src.y, WIN_H) +
-                    !src_min * S_ZToScreenSpace(seg.dst.y, WIN_H);
-        screen_x1 = src_min * screen_dst + !src_min * screen_src;
-        screen_w1 = src_min * S_ZToScreenSpace(seg.dst.y, WIN_H) +
-                    !src_min * S_ZToScreenSpace(seg.src.y, WIN_H);
-
 #ifdef SB_DEBUG
         printf("{ { %d, %d }, { %d, %d }, %d }\n",
                 seg.src.x, seg.src.y, seg.dst.x, seg.dst.y, seg.color);
@@ -657,12 +642,15 @@ Update
 
         struct timespec start, end;
 
+        /* store the segment in the s-buffer for any potential clipping to take
+         * place appropriately
+         */
         timespec_get(&start, TIME_UTC);
-        SB_Push(sbuffer,
-                screen_x0, screen_x1,
-                screen_w0, screen_w1,
-                ID++,
-                seg.color);
+        SB_PushView(sbuffer,
+                    seg.src.x - BUFFER_W_2, WIN_H - seg.src.y,
+                    seg.dst.x - BUFFER_W_2, WIN_H - seg.dst.y,
+                    ID++,
+                    seg.color);
         timespec_get(&end, TIME_UTC);
 
         *push_time_millis = (end.tv_sec - start.tv_sec +
@@ -712,26 +700,12 @@ Prepopulate
     {
         const seg2_t seg = *(tc->segs + i);
         *(segs + i) = seg;
-        float screen_src = S_ToScreenSpace(&seg.src, BUFFER_W_2, WIN_H, Z_NEAR);
-        float screen_dst = S_ToScreenSpace(&seg.dst, BUFFER_W_2, WIN_H, Z_NEAR);
-        float screen_x0, screen_x1, screen_w0, screen_w1;
-        const byte_t src_min = screen_src <= screen_dst;
 
-        /* sort the endpoints in ascending screen space x before pushing the
-         * segment onto the buffer
-         */
-        screen_x0 = src_min * screen_src + !src_min * screen_dst;
-        screen_w0 = src_min * S_ZToScreenSpace(seg.src.y, WIN_H) +
-                    !src_min * S_ZToScreenSpace(seg.dst.y, WIN_H);
-        screen_x1 = src_min * screen_dst + !src_min * screen_src;
-        screen_w1 = src_min * S_ZToScreenSpace(seg.dst.y, WIN_H) +
-                    !src_min * S_ZToScreenSpace(seg.src.y, WIN_H);
-
-        SB_Push(sbuffer,
-                screen_x0, screen_x1,
-                screen_w0, screen_w1,
-                ID++,
-                seg.color);
+        SB_PushView(sbuffer,
+                    seg.src.x - BUFFER_W_2, WIN_H - seg.src.y,
+                    seg.dst.x - BUFFER_W_2, WIN_H - seg.dst.y,
+                    ID++,
+                    seg.color);
     }
 
     *seg_head = tc->segs_count;
@@ -0,0 +1,35 @@
+#!/bin/bash
+
+SB_DEBUG=""
+
+while [[ $# -gt 0 ]]; do
+    key="$1"
+
+    case $key in
+    -d|--debug)
+        SB_DEBUG="-DSB_DEBUG"
+        shift
+        ;;
+    -h|--help)
+        echo "Options:
+-d,    --debug    Build in debug mode
+-h,    --help     Display this help message and exit"
+        exit 0
+        ;;
+    -*)
+        echo "fatal: Unknown argument $1"
+        exit 1
+        ;;
+    esac
+done
+
+cd "$(dirname "$0")"
+
+# ==============================================================================
+# build the tool, with s-buffer included in the source
+# ==============================================================================
+if [[ -z $SB_DEBUG ]]; then
+    gcc ./pvs.c -o ./sbuffer-pvs -I../ -lm -pthread -O2
+else
+    gcc ./pvs.c -o ./sbuffer-pvs -I../ -lm -pthread $SB_DEBUG -g
+fi
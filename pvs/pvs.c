@@ -0,0 +1,542 @@
+/*
+ *  pvs.c
+ *  s-buffer
+ *
+ *  Created by agent on 2026-10-18.
+ *
+ *  SYNOPSIS:
+ *      An offline tool that precomputes the potentially visible set of each
+ *      cell of a grid laid over a map of segments, for static levels.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "s_buffer.h"
+
+#define PVS_MAGIC "SBPVS2\0"
+#define PVS_MAGIC_SIZE 8
+#define MAX_DEPTH 16
+
+// the potentially visible sets of a grid of cells laid over the map, stored one
+// after another as bit sets of `bytes` bytes each -- see `WritePvs` for how
+// they are laid out on disk
+typedef struct {
+    float   x, y;    // where the corner of the first cell is in world space
+    float   cell;    // how wide each cell is
+    int     cols, rows;
+    float   range;   // how far the viewpoints can see
+    int     samples; // how many viewpoints per side of a cell
+    int     resolution; // how many pixels wide each face of a viewpoint is
+    float   z_near;  // and how near it clips the segments
+    float*  segs;    // each segment as `(src_x, src_y, dst_x, dst_y)`
+    size_t  count;   // how many segments there are
+    size_t  bytes;   // how many bytes the set of each cell takes up
+    byte_t* bits;
+} pvs_t;
+
+// a segment along with where it is in its map, for matching the segments of
+// two maps against each other
+typedef struct {
+    float  coords[4];
+    size_t index;
+} keyed_t;
+
+// the cells one thread takes on, and the engine it keeps around from one cell
+// to the next
+typedef struct {
+    pvs_t*          pvs;
+    const sbgrid_t* grid;
+    const int*      cells;
+    int             count;
+    int             first, stride;
+    size_t          seen; // how many segments were seen from the cells
+} worker_t;
+
+//
+// ReadMap
+// Read the segments in the map at `path` -- one segment per line as `x0 y0 x1
+// y1`, blank lines and lines starting with `#` left out -- into `pvs`. Returns
+// non-zero if the map could not be read.
+//
+static int ReadMap (const char* path, pvs_t* pvs)
+{
+    FILE* file = fopen(path, "r");
+    size_t capacity = 256;
+    char line[256];
+
+    if (!file) return 1;
+
+    pvs->segs = malloc(capacity * 4 * sizeof(float));
+    pvs->count = 0;
+
+    while (fgets(line, sizeof(line), file))
+    {
+        float* seg;
+
+        if (*line == '#') continue;
+
+        if (pvs->count == capacity)
+        {
+            capacity <<= 1;
+            pvs->segs = realloc(pvs->segs, capacity * 4 * sizeof(float));
+        }
+
+        seg = pvs->segs + (pvs->count << 2);
+
+        if (sscanf(line, "%f %f %f %f", seg, seg + 1, seg + 2, seg + 3) == 4)
+            ++pvs->count;
+    }
+
+    fclose(file);
+
+    return 0;
+}
+
+//
+// LayOut
+// Lay a grid of cells `cell` wide over the segments of `pvs`, its corner
+// snapped to a multiple of `cell` so that the cells stay put as long as the
+// extents of the map do.
+//
+static void LayOut (pvs_t* pvs, float cell)
+{
+    float min_x = 0, min_y = 0, max_x = cell, max_y = cell;
+
+    for (size_t i = 0; i < pvs->count; ++i)
+    {
+        const float* seg = pvs->segs + (i << 2);
+
+        if (!i)
+        {
+            min_x = max_x = *seg;
+            min_y = max_y = *(seg + 1);
+        }
+
+        min_x = SB_MIN(min_x, SB_MIN(*seg, *(seg + 2)));
+        min_y = SB_MIN(min_y, SB_MIN(*(seg + 1), *(seg + 3)));
+        max_x = SB_MAX(max_x, SB_MAX(*seg, *(seg + 2)));
+        max_y = SB_MAX(max_y, SB_MAX(*(seg + 1), *(seg + 3)));
+    }
+
+    pvs->cell = cell;
+    pvs->x = floorf(min_x / cell) * cell;
+    pvs->y = floorf(min_y / cell) * cell;
+    pvs->cols = SB_MAX((int) ceilf((max_x - pvs->x) / cell), 1);
+    pvs->rows = SB_MAX((int) ceilf((max_y - pvs->y) / cell), 1);
+    pvs->bytes = (pvs->count + 7) >> 3;
+    pvs->bits = calloc((size_t) pvs->cols * pvs->rows * pvs->bytes + 1, 1);
+}
+
+//
+// WritePvs
+// Write `pvs` out to `path` -- `PVS_MAGIC`, then the layout of the grid, then
+// the segments it was computed from, and then the bit set of each cell one row
+// of cells after another, the lowest bit of the first byte of each standing
+// for the first segment. Returns non-zero if the file could not be written.
+//
+static int WritePvs (const char* path, const pvs_t* pvs)
+{
+    FILE* file = fopen(path, "wb");
+    const unsigned int count = pvs->count;
+    const size_t cells = (size_t) pvs->cols * pvs->rows;
+    int failed;
+
+    if (!file) return 1;
+
+    failed = fwrite(PVS_MAGIC, PVS_MAGIC_SIZE, 1, file) != 1 ||
+             fwrite(&count, sizeof(count), 1, file) != 1 ||
+             fwrite(&pvs->cols, sizeof(int), 1, file) != 1 ||
+             fwrite(&pvs->rows, sizeof(int), 1, file) != 1 ||
+             fwrite(&pvs->samples, sizeof(int), 1, file) != 1 ||
+             fwrite(&pvs->resolution, sizeof(int), 1, file) != 1 ||
+             fwrite(&pvs->x, sizeof(float), 1, file) != 1 ||
+             fwrite(&pvs->y, sizeof(float), 1, file) != 1 ||
+             fwrite(&pvs->cell, sizeof(float), 1, file) != 1 ||
+             fwrite(&pvs->range, sizeof(float), 1, file) != 1 ||
+             fwrite(&pvs->z_near, sizeof(float), 1, file) != 1 ||
+             fwrite(pvs->segs, 4 * sizeof(float), count, file) != count ||
+             fwrite(pvs->bits, pvs->bytes, cells, file) != cells;
+
+    return fclose(file) || failed;
+}
+
+//
+// ReadPvs
+// Read what `WritePvs` wrote to `path` back into `pvs`. Returns non-zero if the
+// file could not be read, or is not one.
+//
+static int ReadPvs (const char* path, pvs_t* pvs)
+{
+    FILE* file = fopen(path, "rb");
+    char magic[PVS_MAGIC_SIZE];
+    unsigned int count;
+    size_t cells;
+    int failed;
+
+    if (!file) return 1;
+
+    failed = fread(magic, PVS_MAGIC_SIZE, 1, file) != 1 ||
+             memcmp(magic, PVS_MAGIC, PVS_MAGIC_SIZE) ||
+             fread(&count, sizeof(count), 1, file) != 1 ||
+             fread(&pvs->cols, sizeof(int), 1, file) != 1 ||
+             fread(&pvs->rows, sizeof(int), 1, file) != 1 ||
+             fread(&pvs->samples, sizeof(int), 1, file) != 1 ||
+             fread(&pvs->resolution, sizeof(int), 1, file) != 1 ||
+             fread(&pvs->x, sizeof(float), 1, file) != 1 ||
+             fread(&pvs->y, sizeof(float), 1, file) != 1 ||
+             fread(&pvs->cell, sizeof(float), 1, file) != 1 ||
+             fread(&pvs->range, sizeof(float), 1, file) != 1 ||
+             fread(&pvs->z_near, sizeof(float), 1, file) != 1 ||
+             pvs->cols <= 0 || pvs->rows <= 0;
+
+    if (failed)
+    {
+        fclose(file);
+        return 1;
+    }
+
+    cells = (size_t) pvs->cols * pvs->rows;
+    pvs->count = count;
+    pvs->bytes = (pvs->count + 7) >> 3;
+    pvs->segs = malloc(pvs->count * 4 * sizeof(float) + 1);
+    pvs->bits = malloc(cells * pvs->bytes + 1);
+
+    failed = fread(pvs->segs, 4 * sizeof(float), count, file) != count ||
+             fread(pvs->bits, pvs->bytes, cells, file) != cells;
+
+    fclose(file);
+
+    return failed;
+}
+
+static int CompareKeyed (const void* a, const void* b)
+{
+    return memcmp(((const keyed_t*) a)->coords,
+                  ((const keyed_t*) b)->coords,
+                  sizeof(((const keyed_t*) a)->coords));
+}
+
+//
+// KeySegments
+// The segments of `pvs` along with where they are in it, sorted by their
+// coordinates.
+//
+static keyed_t* KeySegments (const pvs_t* pvs)
+{
+    keyed_t* keyed = malloc(pvs->count * sizeof(keyed_t) + 1);
+
+    for (size_t i = 0; i < pvs->count; ++i)
+    {
+        memcpy((keyed + i)->coords, pvs->segs + (i << 2), 4 * sizeof(float));
+        (keyed + i)->index = i;
+    }
+
+    qsort(keyed, pvs->count, sizeof(keyed_t), CompareKeyed);
+
+    return keyed;
+}
+
+//
+// Touch
+// Flag each cell of `pvs` in `flags` that is within `reach` of the box around
+// `seg` -- every cell `seg` could be seen from, or hide anything from.
+//
+static void Touch (const pvs_t* pvs, const float* seg, float reach,
+                   byte_t* flags)
+{
+    const float x0 = SB_MIN(*seg, *(seg + 2)) - reach - pvs->x;
+    const float y0 = SB_MIN(*(seg + 1), *(seg + 3)) - reach - pvs->y;
+    const float x1 = SB_MAX(*seg, *(seg + 2)) + reach - pvs->x;
+    const float y1 = SB_MAX(*(seg + 1), *(seg + 3)) + reach - pvs->y;
+    const int col0 = SB_MAX((int) floorf(x0 / pvs->cell), 0);
+    const int row0 = SB_MAX((int) floorf(y0 / pvs->cell), 0);
+    const int col1 = SB_MIN((int) floorf(x1 / pvs->cell), pvs->cols - 1);
+    const int row1 = SB_MIN((int) floorf(y1 / pvs->cell), pvs->rows - 1);
+
+    for (int row = row0; row <= row1; ++row)
+        for (int col = col0; col <= col1; ++col)
+            *(flags + row * pvs->cols + col) = 0xff;
+}
+
+//
+// Reuse
+// Carry the sets of `old` over to `pvs` for the cells that nothing changed
+// around since -- both laid out the same way -- matching the segments up by
+// their coordinates. A segment can only be seen from, or hide anything from,
+// the cells that are `range` off along the axis of some face away from it, so
+// only the cells that close to the segments that are gone or new are left for
+// `Compute`, listed in `dirty`. Returns how many of them there are.
+//
+static int Reuse (pvs_t* pvs, const pvs_t* old, int* dirty)
+{
+    const size_t cells = (size_t) pvs->cols * pvs->rows;
+    /* the faces reach `range` along their diagonal axes */
+    const float reach = pvs->range * (float) M_SQRT2;
+    keyed_t* a = KeySegments(old);
+    keyed_t* b = KeySegments(pvs);
+    long* remap = malloc(old->count * sizeof(long) + 1);
+    byte_t* flags = calloc(cells, 1);
+    size_t i = 0, j = 0;
+    int count = 0;
+
+    /* walk the two maps in lockstep, the segments that are in one but not the
+     * other being the ones that changed
+     */
+    while (i < old->count || j < pvs->count)
+    {
+        const int order = i == old->count ? 1
+                        : j == pvs->count ? -1
+                        : CompareKeyed(a + i, b + j);
+
+        if (order < 0)
+        {
+            *(remap + (a + i)->index) = -1;
+            Touch(pvs, (a + i++)->coords, reach, flags);
+        }
+        else if (order > 0)
+            Touch(pvs, (b + j++)->coords, reach, flags);
+        else
+            *(remap + (a + i++)->index) = (b + j++)->index;
+    }
+
+    for (size_t c = 0; c < cells; ++c)
+    {
+        const byte_t* from = old->bits + c * old->bytes;
+        byte_t* to = pvs->bits + c * pvs->bytes;
+
+        if (*(flags + c))
+        {
+            *(dirty + count++) = c;
+            continue;
+        }
+
+        for (size_t s = 0; s < old->count; ++s)
+        {
+            const long t = *(remap + s);
+
+            if (t >= 0 && *(from + (s >> 3)) >> (s & 7) & 1)
+                *(to + (t >> 3)) |= 1 << (t & 7);
+        }
+    }
+
+    free(a);
+    free(b);
+    free(remap);
+    free(flags);
+
+    return count;
+}
+
+//
+// Worker
+// Run through every `stride`-th cell in the list starting from `first`, seeing
+// all around from a square of viewpoints spread evenly over each, and gather
+// what they see into the set of the cell.
+//
+static void* Worker (void* arg)
+{
+    worker_t* worker = (worker_t*) arg;
+    pvs_t* pvs = worker->pvs;
+    const int n = pvs->samples * pvs->samples;
+    float xs[n], ys[n];
+    sbsight_t* sight = SB_InitSight(worker->grid, n,
+                                    pvs->range,
+                                    pvs->resolution,
+                                    pvs->z_near,
+                                    MAX_DEPTH);
+
+    for (int i = worker->first; i < worker->count; i += worker->stride)
+    {
+        const int c = *(worker->cells + i);
+        const float x0 = pvs->x + (c % pvs->cols) * pvs->cell;
+        const float y0 = pvs->y + (c / pvs->cols) * pvs->cell;
+        byte_t* bits = pvs->bits + (size_t) c * pvs->bytes;
+
+        for (int k = 0; k < n; ++k)
+        {
+            *(xs + k) = x0 + (k % pvs->samples + 0.5f) / pvs->samples *
+                             pvs->cell;
+            *(ys + k) = y0 + (k / pvs->samples + 0.5f) / pvs->samples *
+                             pvs->cell;
+        }
+
+        memset(bits, 0, pvs->bytes);
+        SB_PlaceAgents(sight, xs, ys);
+
+        for (int k = 0; k < n; ++k)
+            worker->seen += SB_SeenBy(sight, k, bits);
+    }
+
+    SB_DestroySight(sight);
+
+    return 0;
+}
+
+//
+// Compute
+// Compute the sets of the `count` cells in `cells` on `threads` threads.
+// Returns how many segments were seen from the cells in total.
+//
+static size_t
+Compute
+( pvs_t*     pvs,
+  const int* cells,
+  int count,
+  int threads )
+{
+    /* as many as there are segments in the map -- too many for the stack */
+    float* src_x = malloc(4 * pvs->count * sizeof(float) + 1);
+    float* src_y = src_x + pvs->count;
+    float* dst_x = src_y + pvs->count;
+    float* dst_y = dst_x + pvs->count;
+    worker_t workers[threads];
+    pthread_t ids[threads];
+    int spawned[threads];
+    size_t seen = 0;
+
+    for (size_t i = 0; i < pvs->count; ++i)
+    {
+        const float* seg = pvs->segs + (i << 2);
+
+        *(src_x + i) = *seg;       *(src_y + i) = *(seg + 1);
+        *(dst_x + i) = *(seg + 2); *(dst_y + i) = *(seg + 3);
+    }
+
+    sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, pvs->count,
+                                 pvs->cell);
+
+    for (int i = 0; i < threads; ++i)
+    {
+        const worker_t worker = {
+            pvs, grid, cells, count, i, threads, 0
+        };
+
+        *(workers + i) = worker;
+    }
+
+    for (int i = 1; i < threads; ++i)
+        *(spawned + i) = !pthread_create(ids + i, 0, Worker, workers + i);
+
+    Worker(workers);
+
+    /* the workers that could not get a thread of their own are run on the
+     * calling one instead, once it's done with its own share
+     */
+    for (int i = 1; i < threads; ++i)
+    {
+        if (*(spawned + i)) pthread_join(*(ids + i), 0);
+        else Worker(workers + i);
+    }
+
+    for (int i = 0; i < threads; ++i) seen += (workers + i)->seen;
+
+    SB_DestroyGrid(grid);
+    free(src_x);
+
+    return seen;
+}
+
+static void Usage ()
+{
+    printf("Usage: sbuffer-pvs [options] <map> <pvs>\n"
+"\n"
+"Options:\n"
+"-c <size>    Width of each cell (default: 64)\n"
+"-h           Display this help message and exit\n"
+"-p <pvs>     Reuse the sets of a previous run for cells the changes to the\n"
+"             map are out of range of\n"
+"-r <range>   How far the viewpoints can see (default: 1024)\n"
+"-s <n>       Sample n by n viewpoints per cell (default: 3)\n"
+"-t <n>       Compute the cells on n threads (default: 4)\n"
+"-w <pixels>  Resolution of each face of the polar buffers (default: 512)\n"
+"-z <z_near>  Near-clipping distance of the polar buffers (default: 0.1)\n");
+}
+
+int main (int argc, char** argv)
+{
+    const char* previous = 0;
+    float cell = 64, range = 1024, z_near = 0.1f;
+    int samples = 3, threads = 4, resolution = 512, opt;
+    pvs_t pvs = { 0 }, old = { 0 };
+
+    while ((opt = getopt(argc, argv, "c:hp:r:s:t:w:z:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c': cell = atof(optarg); break;
+        case 'p': previous = optarg; break;
+        case 'r': range = atof(optarg); break;
+        case 's': samples = atoi(optarg); break;
+        case 't': threads = atoi(optarg); break;
+        case 'w': resolution = atoi(optarg); break;
+        case 'z': z_near = atof(optarg); break;
+        case 'h': Usage(); return 0;
+        default: Usage(); return 1;
+        }
+    }
+
+    if (argc - optind != 2 || cell <= 0 || range <= 0 || samples < 1 ||
+        threads < 1 || resolution < 1 || z_near <= 0)
+    {
+        Usage();
+        return 1;
+    }
+
+    if (ReadMap(*(argv + optind), &pvs))
+    {
+        fprintf(stderr, "fatal: Could not read the map %s\n", *(argv + optind));
+        return 1;
+    }
+
+    pvs.range = range;
+    pvs.samples = samples;
+    pvs.resolution = resolution;
+    pvs.z_near = z_near;
+    LayOut(&pvs, cell);
+
+    const size_t cells = (size_t) pvs.cols * pvs.rows;
+    int* dirty = malloc(cells * sizeof(int));
+    int count = cells;
+
+    for (size_t c = 0; c < cells; ++c) *(dirty + c) = c;
+
+    /* only worth it if the grid and the viewpoints are laid out the same, and
+     * see through the same buffers
+     */
+    if (previous && !ReadPvs(previous, &old) &&
+        old.x == pvs.x && old.y == pvs.y && old.cell == pvs.cell &&
+        old.cols == pvs.cols && old.rows == pvs.rows &&
+        old.range == pvs.range && old.samples == pvs.samples &&
+        old.resolution == pvs.resolution && old.z_near == pvs.z_near)
+        count = Reuse(&pvs, &old, dirty);
+    else if (previous)
+        fprintf(stderr, "warning: Could not reuse %s, computing all cells\n",
+                previous);
+
+    const size_t seen = Compute(&pvs, dirty, count, threads);
+
+    if (WritePvs(*(argv + optind + 1), &pvs))
+    {
+        fprintf(stderr, "fatal: Could not write %s\n", *(argv + optind + 1));
+        return 1;
+    }
+
+    printf("[pvs] %zu segments, %d x %d cells, %d computed "
+           "(%.1f segments seen per cell), %zu bytes of sets\n",
+           pvs.count, pvs.cols, pvs.rows, count,
+           count ? (double) seen / count : 0.0,
+           cells * pvs.bytes);
+
+    free(dirty);
+    free(pvs.segs);
+    free(pvs.bits);
+    free(old.segs);
+    free(old.bits);
+
+    return 0;
+}
@@ -41,6 +41,9 @@
  *          sbuffer_t* sbuffer = SB_Init(width, z_near, max_depth);
  *          sbuffer_t* sbuffer = SB_Init(640, 2, 1024);
  *
+ *          // ...or with spans kept in 32 pixel wide buckets instead of a tree
+ *          sbuffer_t* sbuffer = SB_InitBuckets(640, 2, 5);
+ *
  *      Insertion
  *
  *          unsigned char A = 65;
@@ -49,10 +52,149 @@
  *          SB_Push(sbuffer, 5,   8,   1.0f / 9,  1.0f / 12, A + 1); // _AAABBB_
  *          SB_Push(sbuffer, 2.6, 7.4, 1.0f / 10, 1.0f / 10, A + 2); // _ACABCB_
  *
+ *          // ...or in view space, clipped against the near-clipping plane
+ *          SB_PushView(sbuffer, x0, z0, x1, z1, A + 3);
+ *
+ *          // ...or in clip space, without reciprocals in the hot loop
+ *          SB_PushHomogeneous(sbuffer, x0_clip, w0_clip, x1_clip, w1_clip,
+ *                             A + 4);
+ *
+ *      Batch insertion
+ *
+ *          sbcamera_t camera = { eye_x, eye_y, angle };
+ *          sbprojection_t* projection = SB_InitProjection(n);
+ *
+ *          // world space segments as a structure of arrays
+ *          SB_ProjectMany(sbuffer, &camera, src_x, src_y, dst_x, dst_y, n,
+ *                         projection);
+ *          SB_PushMany(sbuffer, projection, ids, colors);
+ *
+ *          SB_DestroyProjection(projection);
+ *
+ *      Multi-row insertion
+ *
+ *          sbrows_t* rows = SB_InitRows(width, height, z_near, max_depth);
+ *
+ *          // a convex polygon in screen space, 8 rows at a time
+ *          SB_PushPolygon(rows, x, y, w, n, A + 5, color);
+ *
+ *          // ...or a whole scene onto empty rows, each row derived from the
+ *          // one above it
+ *          sbpolygon_t polygons[] = { { x, y, w, n, A + 6, color }, ... };
+ *          SB_PushCoherent(rows, polygons, count);
+ *
+ *          // ...or onto every 4th row only, filling in the rows in between
+ *          SB_PushInterpolated(rows, polygons, count, 4);
+ *
+ *          // identical rows share a buffer, copied on write -- `SB_Row` hands
+ *          // out a row ready to be pushed onto
+ *          SB_ShareRows(rows);
+ *          SB_Push(SB_Row(rows, y), x0, x1, w0, w1, A + 7, color);
+ *
+ *          SB_DestroyRows(rows);
+ *
+ *      Multi-column insertion
+ *
+ *          sbcolumns_t* columns = SB_InitColumns(width, height, z_near, depth);
+ *
+ *          // a wall slice in between `y0' and `y1' at reciprocal depth `w'
+ *          SB_PushSlice(columns, x, y0, y1, w, A + 8, color);
+ *
+ *          // ...or a whole wall, its top and bottom edges and depths affine
+ *          // across the screen
+ *          SB_PushWall(columns, x0, x1, top0, top1, bottom0, bottom1, w0, w1,
+ *                      A + 9, color);
+ *
+ *          SB_DestroyColumns(columns);
+ *
+ *      Polar insertion
+ *
+ *          sbpolar_t* polar = SB_InitPolar(x, y, resolution, z_near, depth);
+ *
+ *          // a segment in world space, seen from all around `(x, y)'
+ *          SB_PushPolar(polar, x0, y0, x1, y1, A + 10, color);
+ *
+ *          // the distance to whatever lies at `angle', and the visibility
+ *          // polygon, boxed in `range' away
+ *          float distance = SB_PolarDistance(polar, angle);
+ *          size_t n = SB_VisibilityPolygon(polar, range, xs, ys);
+ *
+ *          SB_DestroyPolar(polar);
+ *
+ *      Batched lights
+ *
+ *          sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, n, cell);
+ *
+ *          // the visibility polygons of many lights at once, on 4 threads
+ *          sblights_t lights = { x, y, poly_x, poly_y, counts, n, capacity };
+ *          SB_LightMany(grid, &lights, range, resolution, z_near, depth, 4);
+ *
+ *          // ...or whether agents can see points and segments, each agent's
+ *          // buffer kept around until it moves
+ *          sbsight_t* sight = SB_InitSight(grid, n, range, resolution, z_near,
+ *                                          depth);
+ *          SB_PlaceAgents(sight, x, y);
+ *          SB_SeeMany(sight, agents, target_x, target_y, count, seen);
+ *          SB_SeeSegments(sight, agents, src_x, src_y, dst_x, dst_y, count,
+ *                         seen);
+ *          // ...or gather every segment an agent can see into a bit set
+ *          SB_SeenBy(sight, agent, bits);
+ *          SB_DestroySight(sight);
+ *
+ *          SB_DestroyGrid(grid);
+ *
+ *      Multiple cameras
+ *
+ *          // one buffer per camera, each taking up to `capacity' segments
+ *          sbcameras_t* cameras = SB_InitCameras(count, width, z_near,
+ *                                                max_depth, capacity);
+ *
+ *          // all cameras at once, SB_LANES cameras being projected at a time
+ *          SB_ProjectCameras(cameras, poses, src_x, src_y, dst_x, dst_y, n);
+ *          SB_PushCameras(cameras, ids, colors);
+ *
+ *          // every segment camera `i' sees, one bit per segment
+ *          SB_CameraSeen(cameras, i, bits);
+ *          SB_DestroyCameras(cameras);
+ *
+ *      Multiple views
+ *
+ *          // the eyes of a stereo rig, placed relative to the rig
+ *          sbviews_t* views = SB_InitViews(2, width, z_near, max_depth,
+ *                                          capacity);
+ *          sbcamera_t eyes[] = { { -ipd / 2, 0, 0 }, { ipd / 2, 0, 0 } };
+ *
+ *          SB_ProjectViews(views, &rig, eyes, src_x, src_y, dst_x, dst_y, n);
+ *          SB_PushViews(views, ids, colors);
+ *          SB_DestroyViews(views);
+ *
+ *      Cylindrical buffers
+ *
+ *          // `size / z_near` radians across, less than half a turn
+ *          sbuffer_t* sbuffer = SB_InitCylindrical(size, z_near, max_depth);
+ *          SB_PushCylindrical(sbuffer, x0, z0, x1, z1, id, color);
+ *
+ *          // turning in place shifts the screen in O(1), exposing at most a
+ *          // single stretch `[from, to)' of it to push onto
+ *          if (SB_Turn(sbuffer, angle, &from, &to))
+ *          {
+ *              SB_PushClipWindow(sbuffer, from, to);
+ *              SB_PushCylindrical(sbuffer, x0, z0, x1, z1, id, color);
+ *              SB_PopClipWindow(sbuffer);
+ *          }
+ *
+ *          // ...whereas moving starts the buffer over
+ *          SB_ClearCylindrical(sbuffer);
+ *
  *      Rasterization
  *
  *          SB_Print(sbuffer); // `_' denotes empty pixels
  *
+ *      Queries
+ *
+ *          float covered, max_z;
+ *          SB_Coverage(sbuffer, x0, x1, &covered, &max_z); // O(log n)
+ *
  *      Lifetime
  *
  *          SB_Destroy(sbuffer); // Releases all memory owned by the buffer
@@ -82,7 +224,8 @@
 
 // FIXME: find a sensible way of using `e_malloc` in this library!
 
-#ifndef s_buffer_h
+#if !defined(s_buffer_h) || defined(S_BUFFER_WIDE)
+#ifndef S_BUFFER_WIDE
 
 #include <stdlib.h>
 // FIXME: Only dependency is `ceil()' - consider adding a custom implementation
@@ -90,10 +233,78 @@
 #include <math.h>
 
 #define s_buffer_h
+#define s_buffer_h_sbprim_t sbprim_t
 #define s_buffer_h_span_t span_t
 #define s_buffer_h_sbuffer_t sbuffer_t
+#define s_buffer_h_sbentry_t sbentry_t
+#define s_buffer_h_sbbucket_t sbbucket_t
+#define s_buffer_h_sbcamera_t sbcamera_t
+#define s_buffer_h_sbprojection_t sbprojection_t
+#define s_buffer_h_sbpairs_t sbpairs_t
+#define s_buffer_h_sbrows_t sbrows_t
+#define s_buffer_h_sbpolygon_t sbpolygon_t
+#define s_buffer_h_sbcolumns_t sbcolumns_t
+#define s_buffer_h_sbpolar_t sbpolar_t
+#define s_buffer_h_sbgrid_t sbgrid_t
+#define s_buffer_h_sblights_t sblights_t
+#define s_buffer_h_sbsight_t sbsight_t
+#define s_buffer_h_sbcameras_t sbcameras_t
+#define s_buffer_h_sbviews_t sbviews_t
 #define s_buffer_h_SB_Init SB_Init
+#define s_buffer_h_SB_InitBuckets SB_InitBuckets
 #define s_buffer_h_SB_Push SB_Push
+#define s_buffer_h_SB_PushView SB_PushView
+#define s_buffer_h_SB_PushHomogeneous SB_PushHomogeneous
+#define s_buffer_h_SB_InitProjection SB_InitProjection
+#define s_buffer_h_SB_DestroyProjection SB_DestroyProjection
+#define s_buffer_h_SB_ProjectMany SB_ProjectMany
+#define s_buffer_h_SB_PushMany SB_PushMany
+#define s_buffer_h_SB_IntersectMany SB_IntersectMany
+#define s_buffer_h_SB_PushClipped SB_PushClipped
+#define s_buffer_h_SB_PushClipWindow SB_PushClipWindow
+#define s_buffer_h_SB_PopClipWindow SB_PopClipWindow
+#define s_buffer_h_SB_BeginBatch SB_BeginBatch
+#define s_buffer_h_SB_EndBatch SB_EndBatch
+#define s_buffer_h_SB_InitRows SB_InitRows
+#define s_buffer_h_SB_PushPolygon SB_PushPolygon
+#define s_buffer_h_SB_PushCoherent SB_PushCoherent
+#define s_buffer_h_SB_PushInterpolated SB_PushInterpolated
+#define s_buffer_h_SB_Row SB_Row
+#define s_buffer_h_SB_ShareRows SB_ShareRows
+#define s_buffer_h_SB_DestroyRows SB_DestroyRows
+#define s_buffer_h_SB_InitColumns SB_InitColumns
+#define s_buffer_h_SB_PushSlice SB_PushSlice
+#define s_buffer_h_SB_PushWall SB_PushWall
+#define s_buffer_h_SB_DestroyColumns SB_DestroyColumns
+#define s_buffer_h_SB_InitPolar SB_InitPolar
+#define s_buffer_h_SB_PushPolar SB_PushPolar
+#define s_buffer_h_SB_PolarDistance SB_PolarDistance
+#define s_buffer_h_SB_VisibilityPolygon SB_VisibilityPolygon
+#define s_buffer_h_SB_DestroyPolar SB_DestroyPolar
+#define s_buffer_h_SB_InitGrid SB_InitGrid
+#define s_buffer_h_SB_LightMany SB_LightMany
+#define s_buffer_h_SB_DestroyGrid SB_DestroyGrid
+#define s_buffer_h_SB_InitSight SB_InitSight
+#define s_buffer_h_SB_PlaceAgents SB_PlaceAgents
+#define s_buffer_h_SB_SeeMany SB_SeeMany
+#define s_buffer_h_SB_SeeSegments SB_SeeSegments
+#define s_buffer_h_SB_SeenBy SB_SeenBy
+#define s_buffer_h_SB_DestroySight SB_DestroySight
+#define s_buffer_h_SB_InitCameras SB_InitCameras
+#define s_buffer_h_SB_ProjectCameras SB_ProjectCameras
+#define s_buffer_h_SB_PushCameras SB_PushCameras
+#define s_buffer_h_SB_CameraSeen SB_CameraSeen
+#define s_buffer_h_SB_DestroyCameras SB_DestroyCameras
+#define s_buffer_h_SB_InitViews SB_InitViews
+#define s_buffer_h_SB_ProjectViews SB_ProjectViews
+#define s_buffer_h_SB_PushViews SB_PushViews
+#define s_buffer_h_SB_DestroyViews SB_DestroyViews
+#define s_buffer_h_SB_InitCylindrical SB_InitCylindrical
+#define s_buffer_h_SB_PushCylindrical SB_PushCylindrical
+#define s_buffer_h_SB_Turn SB_Turn
+#define s_buffer_h_SB_ClearCylindrical SB_ClearCylindrical
+#define s_buffer_h_SB_CylindricalW SB_CylindricalW
+#define s_buffer_h_SB_Coverage SB_Coverage
 #define s_buffer_h_SB_Dump SB_Dump
 #define s_buffer_h_SB_Print SB_Print
 #define s_buffer_h_SB_Destroy SB_Destroy
@@ -117,6 +328,49 @@
 
 #define SB_EPS 1e-3
 
+#define SB_PI 3.14159265358979f
+
+#define SB_MAX_CLIP_DEPTH 64
+
+// how much of a segment needs to be seen for it to count -- in pixels, more
+// than clipping against the faces of a polar buffer is off by
+#define SB_SLIVER 1e-2f
+
+// how many segments the batched routines process at a time...
+#define SB_LANES 8
+// ...and how many their AVX-512 builds do instead
+#define SB_WIDE_LANES 16
+// how many float arrays a projection is made up of
+#define SB_PROJECTION_FLOATS 8
+// ...and pairs of spans
+#define SB_PAIRS_FLOATS 10
+// how many views a multi-view buffer can have, a bit each -- see `sbviews_t`
+#define SB_MAX_VIEWS 8
+
+#define SB_ISA_GENERIC 0x0
+#define SB_ISA_SSE42 0x1
+#define SB_ISA_AVX2 0x2
+#define SB_ISA_AVX512 0x3
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SB_X86
+#endif
+
+/* `SB_LightMany` spreads the lights out over threads wherever there are POSIX
+ * threads to be had, and runs through them one after another otherwise
+ */
+#if defined(__unix__) || defined(__APPLE__)
+#define SB_PTHREADS
+#endif
+
+/* in reference mode, the batched routines agree with their scalar counterparts
+ * bit-for-bit no matter what the compiler is allowed to fuse -- debug builds
+ * always run in reference mode and check that they do
+ */
+#if defined(SB_DEBUG) && !defined(SB_REFERENCE)
+#define SB_REFERENCE
+#endif
+
 #define SB_ASSERT(a, ...) if (!(a)) { fprintf(stderr, __VA_ARGS__); exit(1); }
 
 #define SB_MAX(a, b) ((((a) > (b)) * (a)) + (((b) >= (a)) * (b)))
@@ -135,25 +389,213 @@
 
 #define SB_CROSS_SPAN2(u, v) (SB_CROSS_2D((u)->x, (u)->z, (v)->x, (v)->z))
 
+#define SB_DOT_SPAN2(u, v) ((u)->x * (v)->x + (u)->z * (v)->z)
+
 typedef unsigned char byte_t;
 
+// a segment pushed onto the buffer -- spans are the visible parts of these, and
+// read their depths, `id` and `color` off of the primitive they were cut from,
+// so that splitting and trimming them never has to interpolate
+typedef struct {
+    float  x0, w0;  // a point on the primitive in perspective-correct space
+    float  dw;      // ...and how fast the reciprocal depth changes along it
+    byte_t id;
+    int    color;
+    int    payload; // index of the input it came from, or -1 if there is none
+} sbprim_t;
+
 typedef struct span {
     struct span *prev, *next; // pointers to left & right subtrees, respectively
     float        x0,    x1;   // start and end endpoints in screen space
-    float        w0,    w1;   // reciprocal depths associated with each endpoint
-    int          height;      // how tall is this span?
-    byte_t       id;
-    int          color;
+    int          prim;        // the primitive this span is a part of
+    float        cover;       // total width covered by this span's subtree
+    float        w_far;       // smallest reciprocal depth within the subtree
+    byte_t       height;      // how tall is this span?
+    byte_t       dirty;       // whether `cover` and `w_far` need refreshing
 } span_t;
 
+// the visible part of a primitive within a single bucket of the x-bucket
+// backend -- a primitive crossing bucket boundaries leaves one in each bucket
+// it touches, all referring to the very same entry in the primitive table
+typedef struct {
+    float x0, x1; // start and end endpoints in screen space
+    int   prim;   // the primitive this span is a part of
+} sbentry_t;
+
+// a fixed-width slice of the buffer, holding the spans within it sorted by
+// their start endpoints
+typedef struct {
+    sbentry_t* spans;
+    int        count, capacity;
+} sbbucket_t;
+
 typedef struct {
     span_t* root;      // the root of the buffer
     int     size;      // the buffer width
     float   z_near;    // distance from the eye to the near-clipping plane
     size_t  max_depth; // the maximum depth the root span is allowed to grow to
+    // nested clip windows `[left, right)` each span is clipped against prior to
+    // insertion -- only the innermost one (at `clip_depth - 1`) is in effect
+    float   clip_stack[SB_MAX_CLIP_DEPTH][2];
+    int     clip_depth;
+    // the widest instruction set the batched routines make use of -- detected
+    // at `SB_Init`, and may be lowered afterwards, but never raised
+    int     isa;
+    // whether rebalancing is deferred until `SB_EndBatch`, and how tall the
+    // tree is allowed to grow in the meantime
+    byte_t  batch;
+    int     batch_height;
+    // every primitive pushed so far, referred to by index from the spans
+    sbprim_t* prims;
+    int       prims_count, prims_capacity;
+    // the x-bucket backend, in place of the tree unless `buckets` is zero --
+    // each bucket is `1 << bucket_shift` pixels wide (see `SB_InitBuckets`)
+    sbbucket_t* buckets;
+    int         buckets_count, bucket_shift;
+    // cylindrical buffers (see `SB_InitCylindrical`): the angle each pixel
+    // spans, zero for the rest, and where the screen starts in the buffer's
+    // own coordinates the spans are kept in -- zero for the rest as well
+    float   turn;
+    float   offset;
+    // the stretch `[seen_x0, seen_x1)` of the buffer's own coordinates that
+    // has been pushed onto so far -- the screen itself for the rest
+    float   seen_x0, seen_x1;
 } sbuffer_t;
 
-sbuffer_t* SB_Init (int size, float z_near, size_t max_depth);
+// the primitive `span` is a part of, and the reciprocal depth along `prim` at
+// screen space `x` -- see `SB_CylindricalW` for cylindrical buffers
+#define SB_PRIM(sbuffer, span) ((sbuffer)->prims + (span)->prim)
+#define SB_PRIM_W(prim, x) ((prim)->w0 + ((x) - (prim)->x0) * (prim)->dw)
+
+// a camera looking toward `(sin(angle), -cos(angle))` from `(x, y)` in world
+// space -- an `angle` of zero puts the eye in the same orientation as the one
+// in the test cases and the demo
+typedef struct {
+    float x, y, angle;
+} sbcamera_t;
+
+// segments projected onto the buffer by `SB_ProjectMany`, stored as a structure
+// of arrays so they can be processed in bulk
+typedef struct {
+    float  *x0, *x1;   // endpoints in screen space, sorted in ascending order
+    float  *w0, *w1;   // reciprocal depths associated with each endpoint
+    float  *vx0, *vz0; // the very same endpoints in view space
+    float  *vx1, *vz1; //
+    size_t *index;     // index of the input segment each one was projected from
+    size_t  count;     // how many segments survived the projection
+    size_t  capacity;  // how many segments there is room for
+} sbprojection_t;
+
+// pairs of spans to be tested for intersection by `SB_IntersectMany`, stored
+// as a structure of arrays -- the former span of each pair is given the same
+// way `SB_Push` hands it to the intersection tests, the latter the way it is
+// stored in the buffer
+typedef struct {
+    const float *ax, *az;     // the former span's endpoints in view space
+    const float *bx, *bz;     //
+    const float *u_x0, *u_x1; // ...the part of it still to be inserted
+    const float *v_x0, *v_w0; // the latter span in screen space
+    const float *v_x1, *v_w1; //
+} sbpairs_t;
+
+// a stack of buffers, one for each row of the screen, that polygons are pushed
+// onto rather than segments -- see `SB_PushPolygon`
+typedef struct {
+    sbuffer_t** rows;
+    int         width, height;
+} sbrows_t;
+
+// a convex polygon with `n` vertices `(x, y, w)` to be pushed onto the rows by
+// `SB_PushCoherent` -- see `SB_PushPolygon`
+typedef struct {
+    const float *x, *y, *w;
+    int          n;
+    byte_t       id;
+    int          color;
+} sbpolygon_t;
+
+// a row of buffers, one for each column of the screen, each spanning it from
+// top to bottom -- see `SB_PushWall`
+typedef struct {
+    sbuffer_t** columns;
+    int         width, height;
+} sbcolumns_t;
+
+// four buffers all around a viewer in the plane, a quarter turn each, the angle
+// running counterclockwise off of +x -- see `SB_PushPolar`
+typedef struct {
+    sbuffer_t* faces[4];
+    float      x, y;   // where the viewer is in world space
+    float      z_near; // distance from the viewer to the near-clipping planes
+} sbpolar_t;
+
+// segments in world space bucketed into a uniform grid of square cells, looked
+// up by many lights at once -- see `SB_LightMany`
+typedef struct {
+    float  x, y;        // where the corner of the first cell is in world space
+    float  cell;        // how wide each cell is
+    int    cols, rows;
+    float* segs;        // each segment as `(src_x, src_y, dst_x, dst_y)`
+    size_t count;       // how many segments there are
+    int*   cell_start;  // where each cell starts in `cell_segs`, and ends
+    int*   cell_segs;   // the segments in each cell, one cell after another
+} sbgrid_t;
+
+// lights to compute the visibility polygons of by `SB_LightMany`, stored as a
+// structure of arrays -- the polygon of each light is stored `capacity`
+// vertices apart from the one before it
+typedef struct {
+    const float *x, *y;           // where each light is in world space
+    float       *poly_x, *poly_y; // room for `capacity` vertices per light
+    size_t      *counts;          // how many vertices each polygon has
+    size_t       count, capacity;
+} sblights_t;
+
+// agents asking whether they can see points or segments, all against the same
+// segments in a grid -- see `SB_SeeMany`
+typedef struct {
+    const sbgrid_t* grid;
+    sbpolar_t**     agents; // each agent's buffer, zero until first asked about
+    float          *x, *y;  // where each agent is in world space
+    int             count;
+    float           range;  // how far the agents can see
+    int             resolution;
+    float           z_near;
+    size_t          max_depth;
+    unsigned int*   stamps; // the last build each segment was pushed for
+    unsigned int    stamp;
+    int             isa;    // see `sbuffer_t`
+} sbsight_t;
+
+// a buffer for each of many cameras looking at the very same segments, the
+// segments projected for `SB_LANES` cameras at a time -- see
+// `SB_ProjectCameras`
+typedef struct {
+    sbuffer_t**      buffers;     // one for each camera
+    sbprojection_t** projections; // what each camera has to push
+    int              count;
+    int              isa;         // see `sbuffer_t`
+} sbcameras_t;
+
+// a buffer for each of a few views close together -- the eyes of a stereo rig,
+// the players of a split-screen game huddled up -- all looking at the very
+// same segments. The segments are taken into the frame of the rig once, and
+// projected for each view from there -- see `SB_ProjectViews`
+typedef struct {
+    sbuffer_t*      buffers[SB_MAX_VIEWS];
+    sbprojection_t* projections[SB_MAX_VIEWS]; // the same segment at the same
+                                               // place in each one
+    byte_t*         masks;    // which views each segment is in, a bit each
+    float          *src_x, *src_y; // the segments in the frame of the rig,
+    float          *dst_x, *dst_y; // from the nearest to the farthest
+    size_t          count;    // how many segments made it into the frame
+    size_t          capacity;
+    int             views;
+    int             isa;      // see `sbuffer_t`
+} sbviews_t;
+
+sbuffer_t* SB_Init        (int size, float z_near, size_t max_depth);
+sbuffer_t* SB_InitBuckets (int size, float z_near, int bucket_shift);
 
 int
 SB_Push
@@ -163,16 +605,302 @@ SB_Push
   byte_t id,
   int    color );
 
+int
+SB_PushView
+( sbuffer_t* sbuffer,
+  float  x0, float z0,
+  float  x1, float z1,
+  byte_t id,
+  int    color );
+
+int
+SB_PushHomogeneous
+( sbuffer_t* sbuffer,
+  float  x0, float w0,
+  float  x1, float w1,
+  byte_t id,
+  int    color );
+
+int
+SB_PushClipped
+( sbuffer_t* sbuffer,
+  float  clip_x0, float clip_x1,
+  float  x0,      float x1,
+  float  w0,      float w1,
+  byte_t id,
+  int    color );
+
+sbprojection_t* SB_InitProjection    (size_t capacity);
+void            SB_DestroyProjection (sbprojection_t* projection);
+
+void
+SB_ProjectMany
+( const sbuffer_t*  sbuffer,
+  const sbcamera_t* camera,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  sbprojection_t* out );
+
+size_t
+SB_PushMany
+( sbuffer_t*            sbuffer,
+  const sbprojection_t* projection,
+  const byte_t*         ids,
+  const int*            colors );
+
+void
+SB_IntersectMany
+( const sbuffer_t* sbuffer,
+  const sbpairs_t* pairs,
+  size_t           n,
+  byte_t*          codes,
+  float*           out,
+  float*           leftness );
+
+int  SB_PushClipWindow (sbuffer_t* sbuffer, float x0, float x1);
+void SB_PopClipWindow  (sbuffer_t* sbuffer);
+
+void SB_BeginBatch (sbuffer_t* sbuffer, int max_height);
+void SB_EndBatch   (sbuffer_t* sbuffer);
+
+sbrows_t*
+SB_InitRows
+( int width, int height,
+  float  z_near,
+  size_t max_depth );
+
+size_t
+SB_PushPolygon
+( sbrows_t*    rows,
+  const float* x, const float* y,
+  const float* w,
+  int          n,
+  byte_t       id,
+  int          color );
+
+size_t
+SB_PushCoherent
+( sbrows_t*          rows,
+  const sbpolygon_t* polygons,
+  int                n );
+
+size_t
+SB_PushInterpolated
+( sbrows_t*          rows,
+  const sbpolygon_t* polygons,
+  int                n,
+  int                stride );
+
+sbuffer_t* SB_Row       (sbrows_t* rows, int row);
+size_t     SB_ShareRows (sbrows_t* rows);
+
+void SB_DestroyRows (sbrows_t* rows);
+
+sbcolumns_t*
+SB_InitColumns
+( int width, int height,
+  float  z_near,
+  size_t max_depth );
+
+int
+SB_PushSlice
+( sbcolumns_t* columns,
+  int    column,
+  float  y0, float y1,
+  float  w,
+  byte_t id,
+  int    color );
+
+size_t
+SB_PushWall
+( sbcolumns_t* columns,
+  float  x0,      float x1,
+  float  top0,    float top1,
+  float  bottom0, float bottom1,
+  float  w0,      float w1,
+  byte_t id,
+  int    color );
+
+void SB_DestroyColumns (sbcolumns_t* columns);
+
+sbpolar_t*
+SB_InitPolar
+( float x, float y,
+  int    resolution,
+  float  z_near,
+  size_t max_depth );
+
+int
+SB_PushPolar
+( sbpolar_t* polar,
+  float  x0, float y0,
+  float  x1, float y1,
+  byte_t id,
+  int    color );
+
+float SB_PolarDistance (const sbpolar_t* polar, float angle);
+
+size_t
+SB_VisibilityPolygon
+( const sbpolar_t* polar,
+  float  range,
+  float* x, float* y );
+
+void SB_DestroyPolar (sbpolar_t* polar);
+
+sbgrid_t*
+SB_InitGrid
+( const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  float  cell );
+
+size_t
+SB_LightMany
+( const sbgrid_t* grid,
+  sblights_t*     lights,
+  float  range,
+  int    resolution,
+  float  z_near,
+  size_t max_depth,
+  int    threads );
+
+void SB_DestroyGrid (sbgrid_t* grid);
+
+sbsight_t*
+SB_InitSight
+( const sbgrid_t* grid,
+  int    count,
+  float  range,
+  int    resolution,
+  float  z_near,
+  size_t max_depth );
+
+void SB_PlaceAgents (sbsight_t* sight, const float* x, const float* y);
+
+size_t
+SB_SeeMany
+( sbsight_t*   sight,
+  const int*   agents,
+  const float* tx, const float* ty,
+  size_t  n,
+  byte_t* out );
+
+size_t
+SB_SeeSegments
+( sbsight_t*   sight,
+  const int*   agents,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t  n,
+  byte_t* out );
+
+size_t SB_SeenBy (sbsight_t* sight, int agent, byte_t* bits);
+
+void SB_DestroySight (sbsight_t* sight);
+
+sbcameras_t*
+SB_InitCameras
+( int    count,
+  int    size,
+  float  z_near,
+  size_t max_depth,
+  size_t capacity );
+
+void
+SB_ProjectCameras
+( sbcameras_t*      cameras,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n );
+
+size_t
+SB_PushCameras
+( sbcameras_t*  cameras,
+  const byte_t* ids,
+  const int*    colors );
+
+size_t SB_CameraSeen (const sbcameras_t* cameras, int camera, byte_t* bits);
+
+void SB_DestroyCameras (sbcameras_t* cameras);
+
+sbviews_t*
+SB_InitViews
+( int    views,
+  int    size,
+  float  z_near,
+  size_t max_depth,
+  size_t capacity );
+
+size_t
+SB_ProjectViews
+( sbviews_t*        views,
+  const sbcamera_t* rig,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n );
+
+size_t
+SB_PushViews
+( sbviews_t*    views,
+  const byte_t* ids,
+  const int*    colors );
+
+void SB_DestroyViews (sbviews_t* views);
+
+sbuffer_t* SB_InitCylindrical (int size, float z_near, size_t max_depth);
+
+int
+SB_PushCylindrical
+( sbuffer_t* sbuffer,
+  float  x0, float z0,
+  float  x1, float z1,
+  byte_t id,
+  int    color );
+
+int SB_Turn (sbuffer_t* sbuffer, float angle, float* x0, float* x1);
+
+void SB_ClearCylindrical (sbuffer_t* sbuffer);
+
+float
+SB_CylindricalW
+( const sbuffer_t* sbuffer,
+  const sbprim_t*  prim,
+  float x );
+
+int
+SB_Coverage
+( const sbuffer_t* sbuffer,
+  float  x0, float x1,
+  float* covered,
+  float* max_z );
+
 void SB_Dump    (const sbuffer_t* sbuffer);
 void SB_Print   (const sbuffer_t* sbuffer);
 void SB_Destroy (sbuffer_t* sbuffer);
 //
 // HEADER END //////////////////////////////////////////////////////////////////
 
+#endif // S_BUFFER_WIDE
 #ifndef S_BUFFER_DEFS_ONLY
+#ifndef S_BUFFER_WIDE
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <float.h>
+
+#ifdef SB_PTHREADS
+#include <pthread.h>
+#endif // SB_PTHREADS
+
+#ifdef SB_REFERENCE
+#pragma GCC push_options
+#pragma GCC optimize ("fp-contract=off")
+#endif // SB_REFERENCE
 
 #define _SB_Falmeq_Select(_arg0, _arg1, _arg2, Fn_Name, ...) Fn_Name
 #define _SB_Falmeq_Eps(a, b, eps) SB_Falmeq_Impl(a, b, eps)
@@ -186,6 +914,94 @@ typedef struct {
     float x, z;
 } span2_t;
 
+/* the batched routines are written once as kernels, always inlined into a
+ * handful of wrappers each built for a different instruction set. The widest
+ * one the host supports is picked at `SB_Init`, so a single build runs well
+ * everywhere
+ */
+#define SB_KERNEL static inline __attribute__((always_inline))
+
+#ifdef SB_X86
+#define SB_VARIANT(ret, name, suffix, isa, params, args)                      \
+    static __attribute__((target(isa))) ret name##_##suffix params          \
+    { return _##name args; }
+#else
+#define SB_VARIANT(ret, name, suffix, isa, params, args)                      \
+    static ret name##_##suffix params { return _##name args; }
+#endif // SB_X86
+
+/* the AVX-512 wrappers are `SB_WIDE_LANES` lanes wide rather than `SB_LANES`,
+ * so they are built from kernels of their own -- see the end of the file
+ */
+#define SB_VARIANTS(ret, name, params, args)                                  \
+    static ret name##_Generic params { return _##name args; }                \
+    SB_VARIANT(ret, name, SSE42, "sse4.2", params, args)                     \
+    SB_VARIANT(ret, name, AVX2, "avx2", params, args)                        \
+    static ret name##_AVX512 params;
+
+#define SB_DISPATCH(isa, name, ...)                                           \
+    switch (isa)                                                              \
+    {                                                                         \
+    case SB_ISA_AVX512: name##_AVX512(__VA_ARGS__); break;                    \
+    case SB_ISA_AVX2:   name##_AVX2(__VA_ARGS__); break;                      \
+    case SB_ISA_SSE42:  name##_SSE42(__VA_ARGS__); break;                     \
+    default:            name##_Generic(__VA_ARGS__);                          \
+    }
+
+#else
+/* the second time around, the very same kernels are built `SB_WIDE_LANES`
+ * lanes wide under names of their own, for the AVX-512 wrappers alone -- see
+ * the end of the file
+ */
+#undef SB_LANES
+#define SB_LANES SB_WIDE_LANES
+
+#define sb_vf sb_wvf
+#define sb_vi sb_wvi
+
+#define SB_ProjectVectors  SB_ProjectVectors_Wide
+#define SB_ProjectLanes    SB_ProjectLanes_Wide
+#define _SB_ProjectMany    _SB_ProjectMany_Wide
+#define SB_IntersectLanes  SB_IntersectLanes_Wide
+#define _SB_IntersectMany  _SB_IntersectMany_Wide
+#define SB_RowLanes        SB_RowLanes_Wide
+#define _SB_PushPolygon    _SB_PushPolygon_Wide
+#define SB_SightLanes      SB_SightLanes_Wide
+#define _SB_SeeMany        _SB_SeeMany_Wide
+#define _SB_ProjectCameras _SB_ProjectCameras_Wide
+#define _SB_ProjectViews   _SB_ProjectViews_Wide
+
+#undef SB_VARIANTS
+#define SB_VARIANTS(ret, name, params, args)                                  \
+    static ret name##_AVX512 params { return _##name args; }
+#endif // S_BUFFER_WIDE
+
+typedef float sb_vf __attribute__((vector_size(SB_LANES * sizeof(float))));
+typedef int   sb_vi __attribute__((vector_size(SB_LANES * sizeof(int))));
+
+// pick lanes from `a` where `mask` is set, and from `b` everywhere else
+#define SB_SELECT(mask, a, b) ((sb_vf) (((sb_vi) (a) & (mask)) | \
+                                        ((sb_vi) (b) & ~(mask))))
+
+#ifndef S_BUFFER_WIDE
+
+//
+// SB_DetectIsa
+// The widest instruction set the batched routines can make use of on this host
+//
+static int SB_DetectIsa ()
+{
+#ifdef SB_X86
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f")) return SB_ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SB_ISA_AVX2;
+    if (__builtin_cpu_supports("sse4.2")) return SB_ISA_SSE42;
+#endif // SB_X86
+
+    return SB_ISA_GENERIC;
+}
+
 //
 // (p)ush scope
 // Stores context across span pushes -- useful when clipping spans or
@@ -196,6 +1012,31 @@ typedef struct {
     float   left, right; // left and right extremities of the 'push scope'
 } pscope_t;
 
+//
+// (intersection) hit
+// What is known about the intersection of the line a span is pushed along and
+// one of the spans in the buffer, regardless of which part of the former is
+// still left to insert -- so that it can be reused across the sub-segments of
+// a single push. See `SB_LineIntersect`.
+//
+typedef struct {
+    float  x0, x1;   // the span in the buffer at the time of the test
+    int    prim;     // ...and the primitive it is a part of
+    float  out;      // screen space x of the point of intersection
+    float  leftness; // leftness, should they intersect
+    float  touching; // leftness, should they merely touch
+    byte_t res;      // `SB_Intersect2D` result
+} sbhit_t;
+
+// how many hits a single push remembers -- a power of two
+#define SB_MEMO_SIZE 32
+
+// the reciprocal depth along `prim` at screen space `x` in the buffer it was
+// pushed onto, whichever kind it is -- the routines that only ever see planar
+// buffers go with `SB_PRIM_W` instead
+#define SB_BUFFER_W(sbuffer, prim, x)                                         \
+    ((sbuffer)->turn ? SB_CylindricalW(sbuffer, prim, x) : SB_PRIM_W(prim, x))
+
 // DEBUGGING UTILITIES /////////////////////////////////////////////////////////
 //
 #ifdef SB_DEBUG
@@ -308,6 +1149,56 @@ static byte_t SB_VerifyHealth (const sbuffer_t* sbuffer)
     return 0;
 }
 
+static
+byte_t
+_SB_VerifyAggregates
+( const sbuffer_t* sbuffer,
+  const span_t*    span,
+  float* cover,
+  float* w_far )
+{
+    byte_t res = 1;
+    float sub_cover, sub_w_far;
+    const sbprim_t* prim = SB_PRIM(sbuffer, span);
+
+    *cover = span->x1 - span->x0;
+    *w_far = SB_MIN(SB_BUFFER_W(sbuffer, prim, span->x0),
+                    SB_BUFFER_W(sbuffer, prim, span->x1));
+
+    if (span->prev)
+    {
+        res &= _SB_VerifyAggregates(sbuffer, span->prev,
+                                    &sub_cover, &sub_w_far);
+        *cover += sub_cover;
+        *w_far = SB_MIN(*w_far, sub_w_far);
+    }
+
+    if (span->next)
+    {
+        res &= _SB_VerifyAggregates(sbuffer, span->next,
+                                    &sub_cover, &sub_w_far);
+        *cover += sub_cover;
+        *w_far = SB_MIN(*w_far, sub_w_far);
+    }
+
+    return res && !span->dirty &&
+           *cover == span->cover && *w_far == span->w_far;
+}
+
+//
+// SB_VerifyAggregates
+// Report whether or not the subtree aggregates of each span node in an S-Buffer
+// instance are up-to-date.
+//
+static byte_t SB_VerifyAggregates (const sbuffer_t* sbuffer)
+{
+    if (!sbuffer->root) return 1;
+
+    float cover, w_far;
+
+    return _SB_VerifyAggregates(sbuffer, sbuffer->root, &cover, &w_far);
+}
+
 #define SB_INVARIANT_VIOLATION_REASON_HEIGHT "height"
 #define SB_INVARIANT_VIOLATION_REASON_BALANCE_FACTOR "balance factor"
 #define SB_INVARIANT_VIOLATION_REASON_WIDTH "width"
@@ -340,6 +1231,33 @@ static const byte_t* SB_VerifySpan (const span_t* span)
 
     return 0;
 }
+
+//
+// SB_VerifyBuckets
+// Report whether or not the spans in each bucket of an S-Buffer instance are
+// non-empty, sorted, and contained within the bucket.
+//
+static byte_t SB_VerifyBuckets (const sbuffer_t* sbuffer)
+{
+    for (int i = 0; i < sbuffer->buckets_count; ++i)
+    {
+        const sbbucket_t* bucket = sbuffer->buckets + i;
+        const float right = (i + 1) << sbuffer->bucket_shift;
+        float x = i << sbuffer->bucket_shift;
+
+        for (int j = 0; j < bucket->count; ++j)
+        {
+            const sbentry_t* span = bucket->spans + j;
+
+            if (span->x0 < x || span->x0 >= span->x1 || span->x1 > right)
+                return 0;
+
+            x = span->x1;
+        }
+    }
+
+    return 1;
+}
 #endif // SB_DEBUG
 
 //
@@ -355,13 +1273,7 @@ static byte_t SB_Falmeq_Impl (float x, float y, float eps)
     return res < eps;
 }
 
-static
-span_t*
-SB_Span
-( float x0, float x1,
-  float w0, float w1,
-  byte_t id,
-  int color )
+static span_t* SB_Span (float x0, float x1, int prim)
 {
     span_t* span = (span_t*) malloc(sizeof(span_t));
 
@@ -369,15 +1281,101 @@ SB_Span
     span->next = 0;
     span->x0 = x0;
     span->x1 = x1;
-    span->w0 = w0;
-    span->w1 = w1;
+    span->prim = prim;
     span->height = 0;
-    span->id = id;
-    span->color = color;
+    span->dirty = 0xff;
 
     return span;
 }
 
+//
+// SB_Prim
+// Add a primitive with endpoints `(x0, w0)` and `(x1, w1)` in
+// perspective-correct screen space to the buffer, and return its index.
+//
+static
+int
+SB_Prim
+( sbuffer_t* sbuffer,
+  float x0, float x1,
+  float w0, float w1,
+  byte_t id,
+  int color,
+  int payload )
+{
+    if (sbuffer->prims_count == sbuffer->prims_capacity)
+    {
+        sbuffer->prims_capacity <<= 1;
+        sbuffer->prims = (sbprim_t*) realloc(sbuffer->prims,
+                                             sbuffer->prims_capacity *
+                                             sizeof(sbprim_t));
+    }
+
+    sbprim_t* prim = sbuffer->prims + sbuffer->prims_count;
+    prim->x0 = x0;
+    prim->w0 = w0;
+    prim->dw = (w1 - w0) / (x1 - x0);
+    prim->id = id;
+
+    /* `w1 = w0 * cos(t) + dw * sin(t)` at the far end -- see `SB_CylindricalW`.
+     * Segments in front of the eye span less than half a turn, so `sin(t)`
+     * only ever vanishes for the narrowest of them, which are as good as
+     * linear
+     */
+    if (sbuffer->turn)
+    {
+        const float t = (x1 - x0) * sbuffer->turn, sin_t = sinf(t);
+
+        if (sin_t > SB_EPS) prim->dw = (w1 - w0 * cosf(t)) / sin_t;
+        else prim->dw = (w1 - w0) / t;
+    }
+
+    prim->color = color;
+    prim->payload = payload;
+
+    return sbuffer->prims_count++;
+}
+
+//
+// SB_Refresh
+// Re-compute the subtree aggregates (`cover` and `w_far`) of every span marked
+// dirty in the buffer. A span is marked dirty whenever it, or any span in its
+// subtree, is visited or modified by a push, so only the paths touched by the
+// latest push are ever walked.
+//
+static void _SB_Refresh (const sbuffer_t* sbuffer, span_t* span)
+{
+    if (!span->dirty) return;
+
+    const sbprim_t* prim = SB_PRIM(sbuffer, span);
+    float cover = span->x1 - span->x0;
+    float w_far = SB_MIN(SB_BUFFER_W(sbuffer, prim, span->x0),
+                         SB_BUFFER_W(sbuffer, prim, span->x1));
+
+    if (span->prev)
+    {
+        _SB_Refresh(sbuffer, span->prev);
+        cover += span->prev->cover;
+        w_far = SB_MIN(w_far, span->prev->w_far);
+    }
+
+    if (span->next)
+    {
+        _SB_Refresh(sbuffer, span->next);
+        cover += span->next->cover;
+        w_far = SB_MIN(w_far, span->next->w_far);
+    }
+
+    span->cover = cover;
+    span->w_far = w_far;
+    span->dirty = 0;
+}
+
+static void SB_Refresh (sbuffer_t* sbuffer)
+{
+    if (sbuffer->root) _SB_Refresh(sbuffer, sbuffer->root);
+}
+
 //
 // SB_Init
 // Initialize a buffer with the given parameters:
@@ -394,42 +1392,285 @@ sbuffer_t* SB_Init (int size, float z_near, size_t max_depth)
     sbuffer->size = size;
     sbuffer->z_near = z_near;
     sbuffer->max_depth = max_depth;
+    sbuffer->clip_depth = 0;
+    sbuffer->isa = SB_DetectIsa();
+    sbuffer->batch = 0;
+    sbuffer->batch_height = 0;
+    sbuffer->prims_count = 0;
+    sbuffer->prims_capacity = 64;
+    sbuffer->prims = (sbprim_t*) malloc(sbuffer->prims_capacity *
+                                        sizeof(sbprim_t));
+    sbuffer->buckets = 0;
+    sbuffer->buckets_count = 0;
+    sbuffer->bucket_shift = 0;
+    sbuffer->turn = 0;
+    sbuffer->offset = 0;
+    sbuffer->seen_x0 = 0;
+    sbuffer->seen_x1 = size;
 
     return sbuffer;
 }
 
 //
-// SB_Intersect2D
-// 2-D line segment intersection
+// SB_InitBuckets
+// Initialize a buffer that keeps its spans in a flat array of fixed-width
+// buckets instead of a tree, each holding a short sorted list of spans:
+// - `size`: The width of the buffer.
+// - `z_near`: The view space distance from the eye to the near-clipping plane.
+// - `bucket_shift`: Buckets are `1 << bucket_shift` pixels wide -- 5 or 6 are
+//    sensible choices.
 //
-static
-byte_t
-SB_Intersect2D
-( span2_t a, span2_t b,
-  span2_t c, span2_t d,
-  span2_t* out )
+// The bucket a span starts in is found with a single shift, and pushes only
+// ever touch the buckets they overlap. This pays off for pixel-bound scenes
+// with lots of small spans; the rest of the API works the same either way.
+//
+sbuffer_t* SB_InitBuckets (int size, float z_near, int bucket_shift)
 {
-    const float DEGENERACY_EPS = 1e-5;
+    sbuffer_t* sbuffer = SB_Init(size, z_near, 0);
+    const int width = 1 << bucket_shift;
 
-    const span2_t u = { b.x - a.x, b.z - a.z };
-    const span2_t v = { d.x - c.x, d.z - c.z };
-    const span2_t c_a = { c.x - a.x, c.z - a.z };
-    const float numer_t = SB_CROSS_SPAN2(&c_a, &v);
-    const float numer_q = SB_CROSS_SPAN2(&c_a, &u);
-    const float denom = SB_CROSS_SPAN2(&u, &v);
-
-    const byte_t nonzero_numer = !(SB_Falmeq(numer_t, 0, DEGENERACY_EPS) ||
-                                   SB_Falmeq(numer_q, 0, DEGENERACY_EPS));
-    const byte_t nonzero_denom = !SB_Falmeq(denom, 0, DEGENERACY_EPS);
-    if (!(nonzero_numer || nonzero_denom)) return SB_DEGENERATE;
-    if (nonzero_numer && !nonzero_denom) return SB_PARALLEL;
-    if (!nonzero_numer) return SB_NOT_INTERSECTING;
+    sbuffer->bucket_shift = bucket_shift;
+    sbuffer->buckets_count = (size + width - 1) >> bucket_shift;
+    sbuffer->buckets = (sbbucket_t*) calloc(sbuffer->buckets_count,
+                                            sizeof(sbbucket_t));
 
-    const float denom_ = 1 / denom;
-    const float t = numer_t * denom_, q = numer_q * denom_;
+    return sbuffer;
+}
 
-    // TODO: maybe use `Falmeq` here as well?
-    if (t <= SB_EPS || t >= 1 - SB_EPS || q <= SB_EPS || q >= 1 - SB_EPS)
+//
+// SB_PushClipWindow
+// Narrow down the region of the buffer that spans can be pushed onto to the
+// window `[x0, x1)`, intersected with the clip window currently in effect.
+// Portal renderers can push the screen extent of each portal they recurse
+// through, so the geometry of the sector behind it is clipped to the portal
+// before descending into the buffer.
+//
+// Must be paired with a call to `SB_PopClipWindow`. A non-zero return value
+// indicates that the resulting window is empty, i.e., nothing can be seen
+// through it.
+//
+int SB_PushClipWindow (sbuffer_t* sbuffer, float x0, float x1)
+{
+    SB_ASSERT(sbuffer->clip_depth < SB_MAX_CLIP_DEPTH,
+              "[SB_PushClipWindow] Maximum clip depth reached!\n");
+
+    float left = 0, right = sbuffer->size;
+
+    if (sbuffer->clip_depth)
+    {
+        const float* window = *(sbuffer->clip_stack + sbuffer->clip_depth - 1);
+        left = *window;
+        right = *(window + 1);
+    }
+
+    float* window = *(sbuffer->clip_stack + sbuffer->clip_depth++);
+    *window = SB_MAX(x0, left);
+    *(window + 1) = SB_MIN(x1, right);
+
+    return *(window + 1) <= *window;
+}
+
+//
+// SB_PopClipWindow
+// Restore the clip window that was in effect prior to the latest call to
+// `SB_PushClipWindow`.
+//
+void SB_PopClipWindow (sbuffer_t* sbuffer)
+{
+    SB_ASSERT(sbuffer->clip_depth > 0,
+              "[SB_PopClipWindow] No clip window to pop!\n");
+
+    --sbuffer->clip_depth;
+}
+
+static int SB_Flatten (span_t* span, span_t** out, int n)
+{
+    if (!span) return n;
+
+    n = SB_Flatten(span->prev, out, n);
+    if (out) *(out + n) = span;
+    ++n;
+
+    return SB_Flatten(span->next, out, n);
+}
+
+static span_t* SB_Build (span_t** spans, int lo, int hi)
+{
+    if (hi <= lo) return 0;
+
+    const int mid = (lo + hi) >> 1;
+    span_t* span = *(spans + mid);
+
+    span->prev = SB_Build(spans, lo, mid);
+    span->next = SB_Build(spans, mid + 1, hi);
+    span->height = SB_HEIGHT(span);
+    span->dirty = 0xff;
+
+    return span;
+}
+
+//
+// SB_Settle
+// Set the height of each span in the subtree rooted at `span` to the one it is
+// going to be left with by `SB_Rebalance`: one more than that of its taller
+// child if the two are within one of each other, and that of a perfectly
+// balanced tree of as many spans otherwise -- in which case it gets rebuilt.
+// Returns how many spans there are in the subtree.
+//
+static int SB_Settle (span_t* span)
+{
+    if (!span) return 0;
+
+    const int count = SB_Settle(span->prev) + SB_Settle(span->next) + 1;
+    const int balance_factor = SB_BF(span);
+
+    if (balance_factor >= -1 && balance_factor <= 1)
+    {
+        span->height = SB_HEIGHT(span);
+        return count;
+    }
+
+    /* as tall as `SB_Build` makes it */
+    span->height = 0;
+    for (int n = count >> 1; n; n >>= 1) ++span->height;
+
+    return count;
+}
+
+//
+// _SB_Rebalance
+// Rebuild the topmost subtrees that `SB_Settle` found out of balance, leaving
+// the rest as they are.
+//
+static span_t* _SB_Rebalance (span_t* span)
+{
+    if (!span) return 0;
+
+    const int balance_factor = SB_BF(span);
+
+    if (balance_factor < -1 || balance_factor > 1)
+    {
+        const int count = SB_Flatten(span, 0, 0);
+        span_t** spans = (span_t**) malloc(count * sizeof(span_t*));
+
+        SB_Flatten(span, spans, 0);
+        span = SB_Build(spans, 0, count);
+        free(spans);
+
+        return span;
+    }
+
+    span->prev = _SB_Rebalance(span->prev);
+    span->next = _SB_Rebalance(span->next);
+
+    /* the aggregates of a span are stale if any of its children got rebuilt */
+    if ((span->prev && span->prev->dirty) || (span->next && span->next->dirty))
+        span->dirty = 0xff;
+
+    return span;
+}
+
+//
+// SB_Rebalance
+// Restore balance in the subtree rooted at `span`, and return its new root.
+// The heights the spans are going to end up with are settled bottom-up first,
+// and the subtrees that are out of balance even so are then rebuilt from the
+// top down, perfectly balanced -- the rest being left as they are. No span is
+// rebuilt more than once, so it runs in linear time.
+//
+static span_t* SB_Rebalance (span_t* span)
+{
+    SB_Settle(span);
+
+    return _SB_Rebalance(span);
+}
+
+//
+// SB_BeginBatch
+// Start a batch of pushes during which the buffer is not rebalanced after each
+// insertion, as it only needs to be balanced before it is read from again --
+// see `SB_EndBatch`.
+//
+// Should the tree grow taller than `max_height` in the meantime, it is
+// rebalanced early, mid-batch -- on every insertion for as long as it stays
+// taller, so the bound is best kept well above the height of a balanced tree.
+// It is lowered to half of the maximum depth of the buffer if it exceeds it,
+// leaving room for the sub-segments of the push in progress.
+//
+void SB_BeginBatch (sbuffer_t* sbuffer, int max_height)
+{
+    const int max_depth = SB_MIN(sbuffer->max_depth, 255);
+
+    sbuffer->batch = 0xff;
+    sbuffer->batch_height = SB_MIN(max_height, max_depth >> 1);
+}
+
+//
+// SB_EndBatch
+// End the batch started by `SB_BeginBatch`, and rebalance the buffer in linear
+// time, rebuilding only the subtrees that ended up out of balance.
+//
+void SB_EndBatch (sbuffer_t* sbuffer)
+{
+    sbuffer->batch = 0;
+    sbuffer->root = SB_Rebalance(sbuffer->root);
+    SB_Refresh(sbuffer);
+
+#ifdef SB_DEBUG
+    SB_ASSERT(SB_VerifyBalance(sbuffer),
+              "[SB_EndBatch] Buffer is improperly balanced!\n");
+    SB_ASSERT(SB_VerifyHeights(sbuffer),
+              "[SB_EndBatch] Improper buffer height!\n");
+#endif // SB_DEBUG
+}
+
+//
+// SB_Intersect2D
+// 2-D line segment intersection
+//
+static
+byte_t
+SB_Intersect2D
+( span2_t a, span2_t b,
+  span2_t c, span2_t d,
+  span2_t* out )
+{
+    const float DEGENERACY_EPS = 1e-5;
+    // the sine of the smallest angle two lines can have in between and still
+    // be considered to be at an angle
+    const float ANGULAR_EPS = 1e-5;
+    const float ANGULAR_EPS_SQ = ANGULAR_EPS * ANGULAR_EPS;
+
+    const span2_t u = { b.x - a.x, b.z - a.z };
+    const span2_t v = { d.x - c.x, d.z - c.z };
+    const span2_t c_a = { c.x - a.x, c.z - a.z };
+    const float numer_t = SB_CROSS_SPAN2(&c_a, &v);
+    const float numer_q = SB_CROSS_SPAN2(&c_a, &u);
+    const float denom = SB_CROSS_SPAN2(&u, &v);
+    const float u_sq = SB_DOT_SPAN2(&u, &u), v_sq = SB_DOT_SPAN2(&v, &v);
+    const float c_a_sq = SB_DOT_SPAN2(&c_a, &c_a);
+
+    /* cross products grow with the lengths of the vectors involved, so an
+     * absolute epsilon alone cannot tell nearly collinear long spans apart
+     * from ones that are genuinely at an angle -- compare the sines as well
+     */
+    const byte_t nonzero_numer =
+        !(SB_Falmeq(numer_t, 0, DEGENERACY_EPS) ||
+          SB_Falmeq(numer_q, 0, DEGENERACY_EPS) ||
+          numer_t * numer_t <= ANGULAR_EPS_SQ * c_a_sq * v_sq ||
+          numer_q * numer_q <= ANGULAR_EPS_SQ * c_a_sq * u_sq);
+    const byte_t nonzero_denom =
+        !(SB_Falmeq(denom, 0, DEGENERACY_EPS) ||
+          denom * denom <= ANGULAR_EPS_SQ * u_sq * v_sq);
+    if (!(nonzero_numer || nonzero_denom)) return SB_DEGENERATE;
+    if (nonzero_numer && !nonzero_denom) return SB_PARALLEL;
+    if (!nonzero_numer) return SB_NOT_INTERSECTING;
+
+    const float denom_ = 1 / denom;
+    const float t = numer_t * denom_, q = numer_q * denom_;
+
+    // TODO: maybe use `Falmeq` here as well?
+    if (t <= SB_EPS || t >= 1 - SB_EPS || q <= SB_EPS || q >= 1 - SB_EPS)
         return SB_NOT_INTERSECTING;
 
     out->x = t * u.x + a.x;
@@ -439,74 +1680,306 @@ SB_Intersect2D
 }
 
 //
-// SB_SpanIntersect
-// Calculate the "2-D" intersection of two spans along the x-z plane and store
-// the result in the `out` variable as screen space x if they intersect. A
-// non-zero return value indicates that the spans are not intersecting.
-//   - 0x1: The spans are parallel to one another
-//   - 0x2: The two spans are identical, either in the same direction or
-//          opposing directions
-//   - 0x3: The spans are not intersecting
-//
-// The function also stores whether the former span originates from or lies on
-// the left (i.e., in front) of the point of intersection in the `leftness`
-// argument passed. A negative value for `leftness` can be interpreted as
-// truthy.
-//
-// The input vertices are all in perspective-correct screen space.
+// SB_LineIntersect
+// `SB_SpanIntersect` for planar buffers.
 //
 static
-byte_t
-SB_SpanIntersect
-( float u_x0, float u_w0,
-  float u_x1, float u_w1,
-  float v_x0, float v_w0,
-  float v_x1, float v_w1,
+void
+SB_LineIntersect
+( span2_t a,    span2_t b,
+  float   v_x0, float   v_w0,
+  float   v_x1, float   v_w1,
   float buffer_width,
   float z_near,
-  float* out,
-  float* leftness )
+  sbhit_t* hit )
 {
     const float buffer_width_half = buffer_width * 0.5f;
     const float _z_near = 1.0f / z_near;
-    const float u_z0 = 1.0f / u_w0, u_z1 = 1.0f / u_w1;
     const float v_z0 = 1.0f / v_w0, v_z1 = 1.0f / v_w1;
-    const float u_wx0 = (u_x0 - buffer_width_half) * u_z0 * _z_near;
-    const float u_wx1 = (u_x1 - buffer_width_half) * u_z1 * _z_near;
     const float v_wx0 = (v_x0 - buffer_width_half) * v_z0 * _z_near;
     const float v_wx1 = (v_x1 - buffer_width_half) * v_z1 * _z_near;
-    const span2_t a = { u_wx0, u_z0 }, b = { u_wx1, u_z1 };
+    const float u_wx0 = a.x, u_wx1 = b.x;
+    const float u_z0 = a.z, u_z1 = b.z;
     const span2_t c = { v_wx0, v_z0 }, d = { v_wx1, v_z1 };
     span2_t intersect;
-    int res = SB_Intersect2D(a, b, c, d, &intersect);
 
-    if (res)
+    hit->x0 = v_x0; hit->x1 = v_x1;
+    hit->res = SB_Intersect2D(a, b, c, d, &intersect);
+    hit->out = hit->leftness = 0;
+
+    /* a hack that is a bit on the dirty side:
+     * in cases where either one of the start endpoints is on the other
+     * span, we need to determine whether the first one obscures the other
+     */
+    const span2_t far = { u_wx1 - v_wx0, u_z1 - v_z0 };
+    const span2_t v = { v_wx1 - v_wx0, v_z1 - v_z0 };
+    hit->touching = SB_CROSS_SPAN2(&far, &v);
+
+    if (hit->res) return;
+
+    hit->out = intersect.x * z_near / intersect.z + buffer_width_half;
+
+    const span2_t u_ = { u_wx0 - intersect.x, u_z0 - intersect.z };
+    const span2_t v_ = { v_wx0 - intersect.x, v_z0 - intersect.z };
+    hit->leftness = SB_CROSS_SPAN2(&u_, &v_);
+}
+
+//
+// SB_ResolveHit
+// Resolve the `hit` against the part `[u_x0, u_x1)` of the former span still
+// to be inserted -- see `SB_SpanIntersect` for what's stored in `out` and
+// `leftness`, and what's returned.
+//
+static inline
+byte_t
+SB_ResolveHit
+( const sbhit_t* hit,
+  float u_x0, float u_x1,
+  float* out,
+  float* leftness )
+{
+    byte_t res = hit->res;
+
+    if (!res)
     {
-        *leftness = 0;
+        *out = hit->out;
 
-        /* a hack that is a bit on the dirty side:
-         * in cases where either one of the start endpoints is on the other
-         * span, we need to determine whether the first one obscures the other
+        /* the round trip back to screen space may land the point of
+         * intersection right on (or past) an endpoint -- splitting there would
+         * leave a zero-width span behind, so treat the spans as merely touching.
+         * The same goes for intersections on the part of the former span that
+         * has already been inserted
          */
-        if (res == SB_NOT_INTERSECTING)
-        {
-            const span2_t u = { u_wx1 - v_wx0, u_z1 - v_z0 };
-            const span2_t v = { v_wx1 - v_wx0, v_z1 - v_z0 };
-            *leftness = SB_CROSS_SPAN2(&u, &v);
-        }
+        if (*out <= u_x0 || *out >= u_x1 || *out <= hit->x0 || *out >= hit->x1)
+            res = SB_NOT_INTERSECTING;
+    }
+
+    if (res)
+    {
+        *leftness = res == SB_NOT_INTERSECTING ? hit->touching : 0;
 
         return res;
     }
 
-    *out = intersect.x * z_near / intersect.z + buffer_width_half;
-
-    const span2_t u = { u_wx0 - intersect.x, u_z0 - intersect.z };
-    const span2_t v = { v_wx0 - intersect.x, v_z0 - intersect.z };
-    *leftness = SB_CROSS_SPAN2(&u, &v);
+    *leftness = hit->leftness;
 
     return res;
 }
 
+//
+// SB_LineIntersectHomogeneous
+// `SB_LineIntersect` for lines given by their endpoints `a` and `b` in clip
+// space -- see `SB_PushHomogeneous`. Spans in the buffer are the homogeneous
+// points `(x, 1, w)` in clip space as they are, so the lines, their point of
+// intersection, and which side of one another they lie on all fall out of
+// cross products. The only division left is the one taking the point of
+// intersection to screen space.
+//
+static
+void
+SB_LineIntersectHomogeneous
+( span2_t a,    span2_t b,
+  float   v_x0, float   v_w0,
+  float   v_x1, float   v_w1,
+  float buffer_width,
+  float z_near,
+  sbhit_t* hit )
+{
+    // the sine of the smallest angle two lines can have in between and still
+    // be considered to be at an angle -- see `SB_Intersect2D`
+    const float ANGULAR_EPS = 1e-5;
+    const float ANGULAR_EPS_SQ = ANGULAR_EPS * ANGULAR_EPS;
+    const float buffer_width_half = buffer_width * 0.5f;
+
+    // the squared length of a vector in clip space once taken back to view
+    // space, times `z_near` squared
+#define SB_CLIP_LENGTH_SQ(x, z) (((x) - buffer_width_half * (z)) *          \
+                                 ((x) - buffer_width_half * (z)) +          \
+                                 (z_near * (z)) * (z_near * (z)))
+
+    /* clip space coordinates are in the order of `size * z`, and cross
+     * products of them cancel out catastrophically -- move the origin over
+     * to `a` first, which leaves the determinants below as they are
+     */
+    const span2_t u = { b.x - a.x, b.z - a.z };
+    const float c_x = v_x0 - a.x * v_w0, c_z = 1 - a.z * v_w0;
+    const float d_x = v_x1 - a.x * v_w1, d_z = 1 - a.z * v_w1;
+
+    // the line through `c` and `d`, the former one is `(-u.z, u.x, 0)`
+    const float m_a = v_w1 - v_w0;
+    const float m_b = v_w0 * v_x1 - v_x0 * v_w1;
+    const float m_c = c_x * d_z - c_z * d_x;
+    // ...and where they meet
+    const float i_x = u.x * m_c, i_z = u.z * m_c;
+    const float i_h = -u.z * m_b - u.x * m_a;
+
+    hit->x0 = v_x0; hit->x1 = v_x1;
+    hit->out = hit->leftness = 0;
+    // `det(c, b, d)`
+    hit->touching = c_x * (u.z * v_w1 - d_z) - c_z * (u.x * v_w1 - d_x) +
+                    v_w0 * (u.x * d_z - u.z * d_x);
+
+    /* the same classification as `SB_Intersect2D` -- whether either line
+     * passes through the start of the other one, and whether they are at an
+     * angle, relative to the lengths involved. Clip space stretches angles
+     * out of shape, so the lengths are measured in view space, scaled by
+     * `z_near` -- as are the cross products in clip space
+     */
+    const float zn_sq = z_near * z_near;
+    const float u_sq = SB_CLIP_LENGTH_SQ(u.x, u.z);
+    const float m_sq = SB_CLIP_LENGTH_SQ(m_b, -m_a);
+    const float c_sq = SB_CLIP_LENGTH_SQ(c_x, c_z);
+    const float c_on_l = u.x * c_z - u.z * c_x, a_on_m = m_c * v_w0;
+
+    const byte_t nonzero_numer =
+        !(c_on_l * c_on_l * zn_sq <= ANGULAR_EPS_SQ * u_sq * c_sq ||
+          a_on_m * a_on_m * zn_sq <= ANGULAR_EPS_SQ * m_sq * c_sq);
+    const byte_t nonzero_denom =
+        !(i_h * i_h * zn_sq <= ANGULAR_EPS_SQ * u_sq * m_sq);
+    // the depth of the point of intersection, scaled by `i_h`
+    const float i_w = a.z * i_h + i_z;
+
+    if (!(nonzero_numer || nonzero_denom)) hit->res = SB_DEGENERATE;
+    else if (!nonzero_denom) hit->res = SB_PARALLEL;
+    /* the lines meet right at the start of either one, or behind the eye */
+    else if (!nonzero_numer || i_w * i_h <= 0) hit->res = SB_NOT_INTERSECTING;
+    else hit->res = SB_INTERSECTING;
+
+    if (hit->res) return;
+
+    /* ...or too close to either end of either span -- `t = t_n / t_d` along
+     * the former and `q = q_n / q_d` along the latter, compared the same way
+     * `SB_Intersect2D` does, without the divisions
+     */
+    const float t_n = m_c * i_h, t_d = i_h * i_h;
+    const float c_u = -c_on_l * v_w1;
+    const float q_den = c_u - (d_x * u.z - d_z * u.x) * v_w0;
+    const float q_n = c_u * q_den, q_d = q_den * q_den;
+
+    if (t_n <= SB_EPS * t_d || t_n >= (1 - SB_EPS) * t_d ||
+        q_n <= SB_EPS * q_d || q_n >= (1 - SB_EPS) * q_d)
+    {
+        hit->res = SB_NOT_INTERSECTING;
+
+        return;
+    }
+
+    hit->out = (a.x * i_h + i_x) / i_w;
+
+    /* the sign of `det(i, a, c)` is that of the leftness, once corrected by
+     * the signs of the homogeneous components -- only `i_h` can be negative
+     */
+    const float det = i_z * c_x - i_x * c_z;
+    hit->leftness = i_h < 0 ? -det : det;
+}
+
+#undef SB_CLIP_LENGTH_SQ
+
+//
+// SB_LineIntersectCylindrical
+// `SB_LineIntersect` for cylindrical buffers, where screen space `x` is the
+// angle `(x - buffer_width / 2) * turn` off of the heading the buffer started
+// out with, and `w` the reciprocal of the distance to the eye -- see
+// `SB_InitCylindrical`. The former line is given by its endpoints `a` and `b`
+// in the view space of that very heading.
+//
+// The point of intersection is taken back to screen space by the angle it is
+// at off of the start of the latter span, so that spans past half a turn off
+// of the heading come out just as well.
+//
+static
+void
+SB_LineIntersectCylindrical
+( span2_t a,    span2_t b,
+  float   v_x0, float   v_w0,
+  float   v_x1, float   v_w1,
+  float buffer_width,
+  float turn,
+  sbhit_t* hit )
+{
+    const float buffer_width_half = buffer_width * 0.5f;
+    const float angle0 = (v_x0 - buffer_width_half) * turn;
+    const float angle1 = (v_x1 - buffer_width_half) * turn;
+    const span2_t c = { sinf(angle0) / v_w0, cosf(angle0) / v_w0 };
+    const span2_t d = { sinf(angle1) / v_w1, cosf(angle1) / v_w1 };
+    span2_t intersect;
+
+    hit->x0 = v_x0; hit->x1 = v_x1;
+    hit->res = SB_Intersect2D(a, b, c, d, &intersect);
+    hit->out = hit->leftness = 0;
+
+    /* see `SB_LineIntersect` */
+    const span2_t far = { b.x - c.x, b.z - c.z };
+    const span2_t v = { d.x - c.x, d.z - c.z };
+    hit->touching = SB_CROSS_SPAN2(&far, &v);
+
+    if (hit->res) return;
+
+    hit->out = v_x0 + atan2f(SB_CROSS_SPAN2(&intersect, &c),
+                             SB_DOT_SPAN2(&intersect, &c)) / turn;
+
+    const span2_t u_ = { a.x - intersect.x, a.z - intersect.z };
+    const span2_t v_ = { c.x - intersect.x, c.z - intersect.z };
+    hit->leftness = SB_CROSS_SPAN2(&u_, &v_);
+}
+
+//
+// SB_SpanIntersect
+// Calculate the "2-D" intersection of two spans along the x-z plane, as far as
+// it only depends on the line the former span lies on and the latter span, and
+// store it in `hit` -- for `SB_ResolveHit` to resolve against the part of the
+// former span still to be inserted, which may be called for several parts of
+// it in a row.
+//
+// The former span is given by its endpoints `a` and `b` in view space (or clip
+// space, with `homogeneous` set) -- the line they lie on is all that matters.
+// The vertices of the latter span are in perspective-correct screen space, as
+// the buffer has it: planar, or cylindrical.
+//
+// Once resolved, a point of intersection is stored as screen space x in `out`,
+// and the return value is zero unless the spans are not intersecting:
+//   - 0x1: The spans are parallel to one another
+//   - 0x2: The two spans are identical, either in the same direction or
+//          opposing directions
+//   - 0x3: The spans are not intersecting
+//
+// Whether the former span originates from or lies on the left (i.e., in front)
+// of the point of intersection is stored in `leftness`. A negative value for
+// `leftness` can be interpreted as truthy.
+//
+static inline
+void
+SB_SpanIntersect
+( const sbuffer_t* sbuffer,
+  span2_t a,    span2_t b,
+  float   v_x0, float   v_w0,
+  float   v_x1, float   v_w1,
+  byte_t homogeneous,
+  sbhit_t* hit )
+{
+    if (homogeneous)
+        SB_LineIntersectHomogeneous(a, b,
+                                    v_x0, v_w0,
+                                    v_x1, v_w1,
+                                    sbuffer->size,
+                                    sbuffer->z_near,
+                                    hit);
+    else if (sbuffer->turn)
+        SB_LineIntersectCylindrical(a, b,
+                                    v_x0, v_w0,
+                                    v_x1, v_w1,
+                                    sbuffer->size,
+                                    sbuffer->turn,
+                                    hit);
+    else
+        SB_LineIntersect(a, b,
+                         v_x0, v_w0,
+                         v_x1, v_w1,
+                         sbuffer->size,
+                         sbuffer->z_near,
+                         hit);
+}
+
 /* TODO: find a way to reuse this subroutine in the balancing portion of
  * `SB_Push` as well
  */
@@ -540,7 +2013,8 @@ SB_BalanceAdHoc
         span_t* span = (stack + stack_depth)->span;
         imbalance_factor = SB_BF(span);
 
-        if (imbalance_factor < -1 || imbalance_factor > 1)
+        /* mid-batch, only the heights are kept up-to-date */
+        if (!sbuffer->batch && (imbalance_factor < -1 || imbalance_factor > 1))
             imbalance_idx = stack_depth;
         else
             span->height = SB_HEIGHT(span);
@@ -589,6 +2063,7 @@ SB_BalanceAdHoc
     old_parent->height = SB_HEIGHT(old_parent);
     child->height = SB_HEIGHT(child);
     new_parent->height = SB_HEIGHT(new_parent);
+    old_parent->dirty = child->dirty = new_parent->dirty = 0xff;
 
     if (imbalance_idx)
     {
@@ -606,7 +2081,7 @@ SB_BalanceAdHoc
 
     if (bookmark_idx < imbalance_idx) return;
 
-    float new_left = 0, new_right = sbuffer->size;
+    float new_left = sbuffer->seen_x0, new_right = sbuffer->seen_x1;
     stack_depth = imbalance_idx;
 
     if (stack_depth)
@@ -665,6 +2140,7 @@ static void SB_PushAdHoc
     while (curr)
     {
         parent = curr;
+        parent->dirty = 0xff;
         pscope_t scope = { parent, left, right };
         *(stack + new_depth++) = scope;
 
@@ -701,48 +2177,27 @@ SB_BisectParent
 ( sbuffer_t* sbuffer,
   pscope_t*  stack,
   span_t*    parent,
-  float      x0,    float x1,
-  float      w0,    float w1,
   float      visx0, float visx1,
-  byte_t     id,
-  int        color,
+  int        prim,
   int*       depth )
 {
     const int rsp = *depth; int bookmark = rsp - 1;
-    const float size = x1 - x0;
-    const float old_parent_size = parent->x1 - parent->x0;
     const float old_parent_x0 = parent->x0, old_parent_x1 = parent->x1;
-    const float old_parent_w0 = parent->w0, old_parent_w1 = parent->w1;
-    const byte_t old_parent_id = parent->id;
-    const int old_parent_color = parent->color;
+    const int old_parent_prim = parent->prim;
     span_t* parent_split;
 
     /* override the `parent` with the visible portion of the new `span` */
     parent->x0 = visx0; parent->x1 = visx1;
-    parent->w0 = SB_LERP(w0, w1, visx0 - x0, size);
-    parent->w1 = SB_LERP(w0, w1, visx1 - x0, size);
-    parent->id = id;
-    parent->color = color;
+    parent->prim = prim;
 
     /* insert the left bisection of the parent immediately to the left */
-    parent_split = SB_Span(old_parent_x0, visx0,
-                           old_parent_w0, SB_LERP(old_parent_w0, old_parent_w1,
-                                                  visx0 - old_parent_x0,
-                                                  old_parent_size),
-                           old_parent_id,
-                           old_parent_color);
+    parent_split = SB_Span(old_parent_x0, visx0, old_parent_prim);
 
     SB_PushAdHoc(parent, parent_split, stack, depth);
     SB_BalanceAdHoc(sbuffer, stack, &bookmark, depth);
 
     /* insert the right bisection of the parent immediately to the right */
-    parent_split = SB_Span(visx1, old_parent_x1,
-                           SB_LERP(old_parent_w0, old_parent_w1,
-                                   visx1 - old_parent_x0,
-                                   old_parent_size),
-                           old_parent_w1,
-                           old_parent_id,
-                           old_parent_color);
+    parent_split = SB_Span(visx1, old_parent_x1, old_parent_prim);
 
     SB_PushAdHoc(parent, parent_split, stack, depth);
     // FIXME: there might not even be a need for this call as the re-balancing
@@ -751,62 +2206,359 @@ SB_BisectParent
     SB_BalanceAdHoc(sbuffer, stack, &bookmark, depth);
 }
 
+// X-BUCKET BACKEND ////////////////////////////////////////////////////////////
 //
-// SB_Push
-// Push a span onto the buffer with endpoints `(x0, w0)` and `(x1, w1)` where
-// both endpoints are in perspective-correct screen space -- meaning `w0` and
-// `w1` are the multiplicative inverses of their corresponding distances from
-// the eye in view space. Another way to put it is that they are the reciprocals
-// of the w-components in clip space coordinates:
+static void SB_Emit (sbentry_t* out, int* n, float x0, float x1, int prim)
+{
+    if (!(x1 > x0)) return;
+
+    sbentry_t* last = out + *n - 1;
+
+    /* pieces of the same primitive that meet are one and the same span */
+    if (*n && last->prim == prim && last->x1 == x0)
+    {
+        last->x1 = x1;
+
+        return;
+    }
+
+    last = out + (*n)++;
+    last->x0 = x0;
+    last->x1 = x1;
+    last->prim = prim;
+}
+
 //
-// `1 / w0_clip = 1 / z0_view = w0`
-// `1 / w1_clip = 1 / z1_view = w1`
+// SB_PushBucket
+// Merge the part `[x0, x1)` of the primitive `prim` that falls into `bucket`
+// with the spans already in there, keeping the bucket sorted.
 //
-// A unique `id` can be provided for debugging and identification purposes.
+// Reciprocal depths are affine in screen space, so whichever of two spans is in
+// front changes at most once where they overlap: at the root of the difference
+// in between their reciprocal depths. That is all it takes to resolve each
+// overlap -- no trip back to view space.
 //
-int
-SB_Push
-( sbuffer_t* sbuffer,
-  float  x0, float x1,
-  float  w0, float w1,
-  byte_t id,
-  int color )
+// Returns a non-zero value if any of it ended up visible.
+//
+static
+byte_t
+SB_PushBucket
+( sbuffer_t*  sbuffer,
+  sbbucket_t* bucket,
+  float       x0, float x1,
+  int         prim )
 {
-    const float size = x1 - x0;
-    span_t* curr = sbuffer->root;
+    const sbprim_t* incoming = sbuffer->prims + prim;
+    const int count = bucket->count;
+    /* each span yields at most two parts of itself, one of the incoming span
+     * over it, and one more in the gap before it
+     */
+    sbentry_t out[(count << 2) + 1];
+    int n = 0;
+    float x = x0; // how far the incoming span has been resolved
 
-    /* the buffer is empty — initialize the root and return immediately */
-    if (!curr)
+    for (int i = 0; i < count; ++i)
     {
-        // clip the segment from left
-        const float new_x0 = SB_MAX(x0, 0);
-        // ...and right
-        const float new_x1 = SB_MIN(x1, sbuffer->size);
-        const float clipped_size = new_x1 - new_x0;
+        const sbentry_t span = *(bucket->spans + i);
 
-        /* only insert if there's something left to insert */
-        if (clipped_size > 0)
+        /* the gap before the span is the incoming one's for the taking */
+        if (x < x1 && x < span.x0)
         {
-            const float new_w0 = SB_LERP(w0, w1, new_x0 - x0, size);
-            const float new_w1 = SB_LERP(w0, w1, new_x1 - x0, size);
-            sbuffer->root = SB_Span(new_x0, new_x1, new_w0, new_w1, id, color);
+            const float gap_x1 = SB_MIN(span.x0, x1);
+            SB_Emit(out, &n, x, gap_x1, prim);
+            x = gap_x1;
+        }
 
-            return 0;
+        const float lo = SB_MAX(span.x0, x), hi = SB_MIN(span.x1, x1);
+
+        if (!(hi > lo))
+        {
+            SB_Emit(out, &n, span.x0, span.x1, span.prim);
+
+            continue;
         }
 
-        return 1;
+        /* the incoming span is visible on `[cut0, cut1)` of the overlap */
+        const sbprim_t* prim_span = sbuffer->prims + span.prim;
+        const float w_lo = SB_PRIM_W(incoming, lo);
+        const float w_hi = SB_PRIM_W(incoming, hi);
+        const float d_lo = w_lo - SB_PRIM_W(prim_span, lo);
+        const float d_hi = w_hi - SB_PRIM_W(prim_span, hi);
+        /* `1 / w - 1 / w' > eps`, the way `SB_Push` tells the nearer one */
+        const byte_t front_lo = d_lo > SB_EPS * w_lo * (w_lo - d_lo);
+        const byte_t front_hi = d_hi > SB_EPS * w_hi * (w_hi - d_hi);
+        float cut0 = hi, cut1 = hi;
+
+        if (front_lo | front_hi)
+        {
+            const float t = d_lo == d_hi ? 0.5f : d_lo / (d_lo - d_hi);
+            const float cut = SB_MIN(SB_MAX(lo + t * (hi - lo), lo), hi);
+            cut0 = front_lo ? lo : cut;
+            cut1 = front_hi ? hi : cut;
+        }
+
+        SB_Emit(out, &n, span.x0, cut0, span.prim);
+        SB_Emit(out, &n, cut0, cut1, prim);
+        SB_Emit(out, &n, cut1, span.x1, span.prim);
+        x = hi;
     }
 
-    // left and right boundaries of insertion
-    float left = 0, right = sbuffer->size;
-    // where the current insertion starts, and how wide the remaining segment is
-    float x = x0, remaining = size;
-    byte_t pushed = 0; // whether we were able push to anything
-    /* initialize the push-stack to store the local scope for each "recursive"
+    SB_Emit(out, &n, x, x1, prim);
+
+    byte_t pushed = 0;
+    for (int i = 0; i < n; ++i) pushed |= (out + i)->prim == prim;
+
+    if (n > bucket->capacity)
+    {
+        bucket->capacity = SB_MAX(n, bucket->capacity << 1);
+        bucket->spans = (sbentry_t*) realloc(bucket->spans,
+                                             bucket->capacity *
+                                             sizeof(sbentry_t));
+    }
+
+    memcpy(bucket->spans, out, n * sizeof(sbentry_t));
+    bucket->count = n;
+
+    return pushed;
+}
+
+//
+// SB_PushBuckets
+// Push the part `[x0, x1)` of the primitive `prim` onto each bucket it
+// overlaps -- see `SB_InitBuckets`.
+//
+// Returns a non-zero value if any of it ended up visible.
+//
+static byte_t SB_PushBuckets (sbuffer_t* sbuffer, float x0, float x1, int prim)
+{
+    const int shift = sbuffer->bucket_shift;
+    byte_t pushed = 0;
+
+    /* the bucket the span starts in is one shift away */
+    for (int i = (int) x0 >> shift; i < sbuffer->buckets_count; ++i)
+    {
+        const float left = i << shift, right = (i + 1) << shift;
+
+        if (left >= x1) break;
+
+        pushed |= SB_PushBucket(sbuffer, sbuffer->buckets + i,
+                                SB_MAX(x0, left), SB_MIN(x1, right),
+                                prim);
+    }
+
+#ifdef SB_DEBUG
+    SB_ASSERT(SB_VerifyBuckets(sbuffer), "[SB_Push] Tainted buckets!\n");
+#endif // SB_DEBUG
+
+    return pushed;
+}
+
+//
+// SB_CoverageBuckets
+// `SB_Coverage` for the x-bucket backend, over the clipped range `[lo, hi)`.
+//
+static
+void
+SB_CoverageBuckets
+( const sbuffer_t* sbuffer,
+  float  lo, float hi,
+  float* covered,
+  float* max_z )
+{
+    const int shift = sbuffer->bucket_shift;
+    float cover = 0, w_far = FLT_MAX;
+
+    for (int i = (int) lo >> shift; i < sbuffer->buckets_count; ++i)
+    {
+        if ((i << shift) >= hi) break;
+
+        const sbbucket_t* bucket = sbuffer->buckets + i;
+
+        for (int j = 0; j < bucket->count; ++j)
+        {
+            const sbentry_t* span = bucket->spans + j;
+            const float span_lo = SB_MAX(span->x0, lo);
+            const float span_hi = SB_MIN(span->x1, hi);
+
+            if (!(span_hi > span_lo)) continue;
+
+            const sbprim_t* prim = SB_PRIM(sbuffer, span);
+            const float w_lo = SB_PRIM_W(prim, span_lo);
+            const float w_hi = SB_PRIM_W(prim, span_hi);
+            cover += span_hi - span_lo;
+            w_far = SB_MIN(w_far, SB_MIN(w_lo, w_hi));
+        }
+    }
+
+    *covered = SB_MIN(cover / (hi - lo), 1);
+    if (cover > 0) *max_z = 1 / w_far;
+}
+
+//
+// SB_DumpBuckets
+// `SB_Dump` for the x-bucket backend -- each non-empty bucket followed by the
+// spans within it.
+//
+static void SB_DumpBuckets (const sbuffer_t* sbuffer)
+{
+    for (int i = 0; i < sbuffer->buckets_count; ++i)
+    {
+        const sbbucket_t* bucket = sbuffer->buckets + i;
+
+        if (!bucket->count) continue;
+
+        printf("[#%d] [N=%d] [%d, %d)\n", i, bucket->count,
+               i << sbuffer->bucket_shift, (i + 1) << sbuffer->bucket_shift);
+
+        for (int j = 0; j < bucket->count; ++j)
+        {
+            const sbentry_t* span = bucket->spans + j;
+
+            printf(" %s%s[%c] [%.3f, %.3f)\n",
+                   j + 1 < bucket->count ? SB_REPR_LEFT : SB_REPR_RIGHT,
+                   SB_REPR_ARM1, SB_PRIM(sbuffer, span)->id,
+                   span->x0, span->x1);
+        }
+    }
+}
+
+//
+// SB_InFront
+// Whether the incoming primitive is in front of the one of the span visited at
+// `x`, where the two start overlapping -- only consulted when they are not
+// intersecting. `leftness` breaks the ties.
+//
+static inline
+byte_t
+SB_InFront
+( const sbuffer_t* sbuffer,
+  const sbprim_t*  incoming,
+  const sbprim_t*  parent_prim,
+  float  x,
+  float  leftness,
+  byte_t homogeneous )
+{
+    const float w = SB_BUFFER_W(sbuffer, incoming, x);
+    const float parent_w = SB_BUFFER_W(sbuffer, parent_prim, x);
+    byte_t nearer, almost_equal;
+
+    if (homogeneous)
+    {
+        /* `|1 / w - 1 / w'| < eps` without the reciprocals */
+        nearer = w > parent_w;
+        almost_equal = SB_Falmeq(w - parent_w, 0, SB_EPS * w * parent_w);
+    }
+    else
+    {
+        const float z = 1 / w, parent_z = 1 / parent_w;
+        nearer = z < parent_z;
+        // floating-point shenanigans
+        almost_equal = SB_Falmeq(z, parent_z);
+    }
+
+    return (nearer && !almost_equal) || (almost_equal && leftness > 0);
+}
+
+//
+// _SB_Push
+// Push a span onto the buffer with endpoints `(x0, w0)` and `(x1, w1)` in
+// perspective-correct screen space, and the very same endpoints `a` and `b` in
+// view space -- the latter are what the intersection tests run on, saving them
+// a round trip from screen space back to view space at every span visited.
+//
+// With `homogeneous` set, `a` and `b` are in clip space instead, and the
+// intersection and depth tests are carried out without taking reciprocals --
+// see `SB_PushHomogeneous`.
+//
+// `payload` is stored on the primitive as is, for the batched pushes to tag
+// each one with the index of the segment it was projected from.
+//
+static
+int
+_SB_Push
+( sbuffer_t* sbuffer,
+  float   x0, float   x1,
+  float   w0, float   w1,
+  span2_t a,  span2_t b,
+  byte_t homogeneous,
+  byte_t id,
+  int color,
+  int payload )
+{
+    float clip_left = 0, clip_right = sbuffer->size;
+
+    if (sbuffer->clip_depth)
+    {
+        const float* window = *(sbuffer->clip_stack + sbuffer->clip_depth - 1);
+        clip_left = *window;
+        clip_right = *(window + 1);
+    }
+
+    /* clip windows are in screen space, spans in the buffer's own coordinates
+     * -- the two only part ways in cylindrical buffers
+     */
+    clip_left += sbuffer->offset;
+    clip_right += sbuffer->offset;
+
+    /* only insert if there's something left to insert */
+    if (!(x1 > x0)) return 1;
+
+    /* the primitive is the segment as a whole -- depths along the parts of it
+     * that make it into the buffer are read off of it
+     */
+    const int prim = SB_Prim(sbuffer, x0, x1, w0, w1, id, color, payload);
+    const sbprim_t* incoming = sbuffer->prims + prim;
+
+    /* clip the span against the current clip window before descending into
+     * the buffer, so that off-window geometry costs nothing
+     */
+    x0 = SB_MAX(x0, clip_left);
+    x1 = SB_MIN(x1, clip_right);
+
+    if (x1 <= x0)
+    {
+        --sbuffer->prims_count;
+
+        return 1;
+    }
+
+    if (sbuffer->buckets)
+    {
+        if (SB_PushBuckets(sbuffer, x0, x1, prim)) return 0;
+
+        --sbuffer->prims_count;
+
+        return 1;
+    }
+
+    const float size = x1 - x0;
+    span_t* curr = sbuffer->root;
+
+    /* the buffer is empty — initialize the root and return immediately */
+    if (!curr)
+    {
+        sbuffer->root = SB_Span(x0, x1, prim);
+        SB_Refresh(sbuffer);
+
+        return 0;
+    }
+
+    // left and right boundaries of insertion
+    float left = sbuffer->seen_x0, right = sbuffer->seen_x1;
+    // where the current insertion starts, and how wide the remaining segment is
+    float x = x0, remaining = size;
+    byte_t pushed = 0; // whether we were able push to anything
+    /* initialize the push-stack to store the local scope for each "recursive"
      * stride
      */
     pscope_t stack[sbuffer->max_depth];
     int depth = 0; // stack pointer: how deep into the tree we currently are
+    /* the line we're pushing along stays the same across the sub-segments,
+     * and so do the intersection tests against the spans left untouched --
+     * remember them for the re-descents from `insertion_bookmark`
+     */
+    sbhit_t memo[SB_MEMO_SIZE];
+    span_t* memo_keys[SB_MEMO_SIZE] = { 0 };
 
     /* continue pushing in sub-segments unless there's nothing left to insert */
     while (remaining > 0)
@@ -820,34 +2572,56 @@ SB_Push
                       "[SB_Push] Maximum buffer depth reached!\n");
 
             parent = curr;
+            parent->dirty = 0xff;
             pscope_t scope = { parent, left, right };
             *(stack + depth++) = scope;
 
-            const float parent_size = parent->x1 - parent->x0;
-            const float w = SB_LERP(w0, w1, x - x0, size);
+            const sbprim_t* parent_prim = sbuffer->prims + parent->prim;
+            const int overlapping = (x1 > parent->x0) & (x < parent->x1);
 
-            float intersection, leftness;
+            float intersection = 0, leftness = 0;
             byte_t not_intersecting = SB_DEGENERATE;
-            if (id == parent->id) // 👈 subdivisions of the original input span,
-                leftness = 0;     // all collinear and overlapping. FP rounding
-            else                  // errors disagree -- obviously.
-                not_intersecting = SB_SpanIntersect(
-                    x, w,
-                    x1, w1,
-                    parent->x0, parent->w0,
-                    parent->x1, parent->w1,
-                    sbuffer->size,
-                    sbuffer->z_near,
-                    &intersection,
-                    &leftness
-                );
+            /* subdivisions of the original input span are all collinear and
+             * overlapping; FP rounding errors disagree -- obviously. spans
+             * that don't overlap need no intersecting at all.
+             */
+            if (overlapping && prim != parent->prim)
+            {
+                const size_t slot =
+                    ((size_t) parent / sizeof(span_t)) & (SB_MEMO_SIZE - 1);
+                sbhit_t* hit = memo + slot;
+
+                /* the span might have been trimmed or replaced since */
+                if (*(memo_keys + slot) != parent ||
+                    hit->prim != parent->prim ||
+                    hit->x0 != parent->x0 || hit->x1 != parent->x1)
+                {
+                    const float parent_w0 =
+                        SB_BUFFER_W(sbuffer, parent_prim, parent->x0);
+                    const float parent_w1 =
+                        SB_BUFFER_W(sbuffer, parent_prim, parent->x1);
+
+                    SB_SpanIntersect(sbuffer,
+                                     a, b,
+                                     parent->x0, parent_w0,
+                                     parent->x1, parent_w1,
+                                     homogeneous,
+                                     hit);
+                    hit->prim = parent->prim;
+                    *(memo_keys + slot) = parent;
+                }
+
+                not_intersecting = SB_ResolveHit(hit, x, x1,
+                                                 &intersection,
+                                                 &leftness);
+            }
 
             if (x < parent->x0)
             {
                 /* does the span we're about to insert overlap with the one
                  * we're currently on along the x-axis?
                  */
-                if (x1 > parent->x0)
+                if (overlapping)
                 {
                     if (!not_intersecting)
                     {
@@ -857,9 +2631,8 @@ SB_Push
                             if (x1 < parent->x1)
                             {
                                 SB_BisectParent(sbuffer, stack, parent,
-                                                x0, x1, w0, w1,
                                                 intersection, x1,
-                                                id, color,
+                                                prim,
                                                 &depth);
                                 /* restore the `left` and `right` boundaries
                                  * from the 'bookmark' as an intermediate
@@ -872,58 +2645,23 @@ SB_Push
                                 pushed = 0xff;
                             }
                             /* -----[ CASE-L2: obscures from the right ]----- */
-                            else
-                            {
-                                parent->w1 = SB_LERP(parent->w0, parent->w1,
-                                                     intersection - parent->x0,
-                                                     parent_size);
-                                parent->x1 = intersection;
-                            }
+                            else parent->x1 = intersection;
                         }
                         /* --------[ CASE-L3: obscures from the left ]------- */
-                        else
-                        {
-                            parent->w0 = SB_LERP(parent->w0, parent->w1,
-                                                 intersection - parent->x0,
-                                                 parent_size);
-                            parent->x0 = intersection;
-                        }
+                        else parent->x0 = intersection;
                     }
-                    else
+                    else if (SB_InFront(sbuffer, incoming, parent_prim,
+                                        parent->x0,
+                                        leftness,
+                                        homogeneous))
                     {
-                        const float w_at_parent_x0 = SB_LERP(w0, w1,
-                                                             parent->x0 - x0,
-                                                             size);
-
-                        const float z_at_parent_x0 = 1 / w_at_parent_x0;
-                        const float parent_z0 = 1 / parent->w0;
-
-                        // floating-point shenanigans
-                        const byte_t almost_equal =
-                            SB_Falmeq(z_at_parent_x0, parent_z0);
-
-                        if (z_at_parent_x0 < parent_z0 && !almost_equal ||
-                            almost_equal && leftness > 0)
+                        /* ------[ CASE-L4: obscures from the left ]----- */
+                        if (x1 < parent->x1) parent->x0 = x1;
+                        /* -------[ CASE-L5: completely obscures ]------- */
+                        else
                         {
-                            /* ------[ CASE-L4: obscures from the left ]----- */
-                            if (x1 < parent->x1)
-                            {
-                                parent->w0 = SB_LERP(parent->w0, parent->w1,
-                                                     x1 - parent->x0,
-                                                     parent_size);
-                                parent->x0 = x1;
-                            }
-                            /* -------[ CASE-L5: completely obscures ]------- */
-                            else
-                            {
-                                parent->w0 = w_at_parent_x0;
-                                parent->w1 = SB_LERP(w0, w1,
-                                                     parent->x1 - x0,
-                                                     size);
-                                parent->id = id;
-                                parent->color = color;
-                                pushed = 0xff;
-                            }
+                            parent->prim = prim;
+                            pushed = 0xff;
                         }
                     }
                 }
@@ -936,7 +2674,7 @@ SB_Push
                 /* does the span we're about to insert overlap with the one
                  * we're currently on along the x-axis?
                  */
-                if (x < parent->x1)
+                if (overlapping)
                 {
                     if (!not_intersecting)
                     {
@@ -946,9 +2684,8 @@ SB_Push
                             if (x1 < parent->x1)
                             {
                                 SB_BisectParent(sbuffer, stack, parent,
-                                                x0, x1, w0, w1,
                                                 intersection, x1,
-                                                id, color,
+                                                prim,
                                                 &depth);
                                 /* restore the `left` and `right` boundaries
                                  * from the 'bookmark' as an intermediate
@@ -961,13 +2698,7 @@ SB_Push
                                 pushed = 0xff;
                             }
                             /* -----[ CASE-R2: obscures from the right ]----- */
-                            else
-                            {
-                                parent->w1 = SB_LERP(parent->w0, parent->w1,
-                                                     intersection - parent->x0,
-                                                     parent_size);
-                                parent->x1 = intersection;
-                            }
+                            else parent->x1 = intersection;
                         }
                         else
                         {
@@ -975,9 +2706,8 @@ SB_Push
                             if (x > parent->x0)
                             {
                                 SB_BisectParent(sbuffer, stack, parent,
-                                                x0, x1, w0, w1,
                                                 x, intersection,
-                                                id, color,
+                                                prim,
                                                 &depth);
                                 /* restore the `left` and `right` boundaries
                                  * from the 'bookmark' as an intermediate
@@ -992,9 +2722,6 @@ SB_Push
                             /* ------[ CASE-R4: obscures from the left ]----- */
                             else
                             {
-                                parent->w0 = SB_LERP(parent->w0, parent->w1,
-                                                     intersection - parent->x0,
-                                                     parent_size);
                                 parent->x0 = intersection;
                                 /* need to proceed leftward instead, since we're
                                  * obscuring from left
@@ -1006,77 +2733,52 @@ SB_Push
                             }
                         }
                     }
-                    else
+                    else if (SB_InFront(sbuffer, incoming, parent_prim,
+                                        x,
+                                        leftness,
+                                        homogeneous))
                     {
-                        const float parent_z_at_x = 1 / SB_LERP(parent->w0,
-                                                                parent->w1,
-                                                                x - parent->x0,
-                                                                parent_size);
-                        const float z = 1 / w;
-
-                        // ugh -- right in the precision! 😬
-                        const byte_t almost_equal = SB_Falmeq(parent_z_at_x, z);
+                        if (x > parent->x0)
+                        {
+                            /* ----------[ CASE-R5: bisecting ]---------- */
+                            if (x1 < parent->x1)
+                            {
+                                SB_BisectParent(sbuffer, stack, parent,
+                                                x, x1,
+                                                prim,
+                                                &depth);
+                                /* restore the `left` and `right` boundaries
+                                 * from the 'bookmark' as an intermediate
+                                 * rebalance might have changed them
+                                 */
+                                pscope_t* parent_scope = stack + depth - 1;
+                                left = parent_scope->left;
+                                right = parent_scope->right;
 
-                        if (z < parent_z_at_x && !almost_equal ||
-                            almost_equal && leftness > 0)
+                                pushed = 0xff;
+                            }
+                            /* ---[ CASE-R6: obscures from the right ]--- */
+                            else parent->x1 = x;
+                        }
+                        else
                         {
-                            if (x > parent->x0)
+                            /* ----[ CASE-R7: obscures from the left ]--- */
+                            if (x1 < parent->x1)
                             {
-                                /* ----------[ CASE-R5: bisecting ]---------- */
-                                if (x1 < parent->x1)
-                                {
-                                    SB_BisectParent(sbuffer, stack, parent,
-                                                    x0, x1, w0, w1,
-                                                    x, x1,
-                                                    id, color,
-                                                    &depth);
-                                    /* restore the `left` and `right` boundaries
-                                     * from the 'bookmark' as an intermediate
-                                     * rebalance might have changed them
-                                     */
-                                    pscope_t* parent_scope = stack + depth - 1;
-                                    left = parent_scope->left;
-                                    right = parent_scope->right;
-
-                                    pushed = 0xff;
-                                }
-                                /* ---[ CASE-R6: obscures from the right ]--- */
-                                else
-                                {
-                                    parent->w1 = SB_LERP(parent->w0, parent->w1,
-                                                         x - parent->x0,
-                                                         parent_size);
-                                    parent->x1 = x;
-                                }
+                                parent->x0 = x1;
+                                /* need to proceed leftward instead, since
+                                 * we're obscuring from left
+                                 */
+                                right = parent->x0;
+                                curr = parent->prev;
+
+                                continue;
                             }
+                            /* -----[ CASE-R8: completely obscures ]----- */
                             else
                             {
-                                /* ----[ CASE-R7: obscures from the left ]--- */
-                                if (x1 < parent->x1)
-                                {
-                                    parent->w0 = SB_LERP(parent->w0, parent->w1,
-                                                         x1 - parent->x0,
-                                                         parent_size);
-                                    parent->x0 = x1;
-                                    /* need to proceed leftward instead, since
-                                     * we're obscuring from left
-                                     */
-                                     right = parent->x0;
-                                     curr = parent->prev;
-
-                                     continue;
-                                }
-                                /* -----[ CASE-R8: completely obscures ]----- */
-                                else
-                                {
-                                    parent->w0 = w;
-                                    parent->w1 = SB_LERP(w0, w1,
-                                                         parent->x1 - x0,
-                                                         size);
-                                    parent->id = id;
-                                    parent->color = color;
-                                    pushed = 0xff;
-                                }
+                                parent->prim = prim;
+                                pushed = 0xff;
                             }
                         }
                     }
@@ -1101,9 +2803,7 @@ SB_Push
          */
         if (clipped_size > 1e-3) // to hell with the floating-point errors --
         {                        // i'm this close to losing it 👌
-            const float new_w0 = SB_LERP(w0, w1, new_x0 - x0, size);
-            const float new_w1 = SB_LERP(w0, w1, new_x1 - x0, size);
-            curr = SB_Span(new_x0, new_x1, new_w0, new_w1, id, color);
+            curr = SB_Span(new_x0, new_x1, prim);
             if (x < parent->x0) parent->prev = curr;
             else parent->next = curr;
             pushed = 0xff;
@@ -1147,7 +2847,8 @@ SB_Push
                 /* remember where the imbalance occurred, if there happened to
                  * be one...
                  */
-                if (balance_factor < -1 || balance_factor > 1)
+                if (!sbuffer->batch &&
+                    (balance_factor < -1 || balance_factor > 1))
                     imbalance_bookmark = stack_depth;
                 /* ...otherwise, update the height of this span */
                 else
@@ -1180,7 +2881,14 @@ SB_Push
         /* lo and behold: *the* balancing, at long last!
          * let's balance the crap out of this buffer, shall we?
          * here goes nothing...
+         *
+         * mid-batch, that is, only once the tree has grown too tall -- it then
+         * gets rebalanced from the root down
          */
+        const byte_t rebuild =
+            sbuffer->batch && sbuffer->root->height > sbuffer->batch_height;
+        if (rebuild) imbalance_bookmark = 0;
+
         if (imbalance_bookmark >= 0)
         {
             /* remember the parent of where the imbalance started, you're gonna
@@ -1193,8 +2901,12 @@ SB_Push
             span_t* old_parent = (stack + imbalance_bookmark)->span;
             span_t *new_parent, *child;
 
+            if (rebuild)
+            {
+                new_parent = child = SB_Rebalance(old_parent);
+            }
             /* restore balance in the `prev` sub-tree */
-            if (SB_BF(old_parent) < 0)
+            else if (SB_BF(old_parent) < 0)
             {
                 new_parent = old_parent->prev;
                 child = new_parent->prev;
@@ -1232,6 +2944,7 @@ SB_Push
             old_parent->height = SB_HEIGHT(old_parent);
             child->height = SB_HEIGHT(child);
             new_parent->height = SB_HEIGHT(new_parent);
+            old_parent->dirty = child->dirty = new_parent->dirty = 0xff;
 
             /* update the parent of the newly balanced span */
             if (imbalance_parent)
@@ -1256,7 +2969,8 @@ SB_Push
             if (imbalance_bookmark <= insertion_bookmark)
             {
                 int i = imbalance_bookmark;
-                float new_left = 0, new_right = sbuffer->size;
+                float new_left = sbuffer->seen_x0;
+                float new_right = sbuffer->seen_x1;
 
                 /* re-adjust the initial `left` and `right` boundaries unless
                  * the imbalance occurred at the root
@@ -1302,7 +3016,7 @@ SB_Push
         }
 
 #ifdef SB_DEBUG
-        const int verify_balance = SB_VerifyBalance(sbuffer);
+        const int verify_balance = sbuffer->batch || SB_VerifyBalance(sbuffer);
         const int verify_heights = SB_VerifyHeights(sbuffer);
         const int health_violation = SB_VerifyHealth(sbuffer);
         if (!(verify_balance && verify_heights && !health_violation))
@@ -1318,12 +3032,22 @@ SB_Push
 #endif // SB_DEBUG
     }
 
+    SB_Refresh(sbuffer);
+
+#ifdef SB_DEBUG
+    SB_ASSERT(SB_VerifyAggregates(sbuffer),
+              "[SB_Push] Stale subtree aggregates!\n");
+#endif // SB_DEBUG
+
     if (!pushed)
     {
 #ifdef SB_VERBOSE
         printf("[SB_Push] Cannot add more segments, spot fully occluded!\n");
 #endif // SB_VERBOSE
 
+        /* no span refers to the primitive -- it's the latest one, too */
+        --sbuffer->prims_count;
+
         return 1;
     }
 
@@ -1331,60 +3055,4545 @@ SB_Push
 }
 
 //
-// SB_Dump
-// Dump the spans in the buffer to `stdout` in a tree-like structure to help in
-// debugging.
+// SB_Push
+// Push a span onto the buffer with endpoints `(x0, w0)` and `(x1, w1)` where
+// both endpoints are in perspective-correct screen space -- meaning `w0` and
+// `w1` are the multiplicative inverses of their corresponding distances from
+// the eye in view space. Another way to put it is that they are the reciprocals
+// of the w-components in clip space coordinates:
 //
-// Each line in the dump follows the format:
-//     [<id>] [BF=<balance factor>] [H=<height>] [<x0>, <x1>).
+// `1 / w0_clip = 1 / z0_view = w0`
+// `1 / w1_clip = 1 / z1_view = w1`
 //
-void SB_Dump (const sbuffer_t* sbuffer)
+// A unique `id` can be provided for debugging and identification purposes.
+//
+int
+SB_Push
+( sbuffer_t* sbuffer,
+  float  x0, float x1,
+  float  w0, float w1,
+  byte_t id,
+  int color )
 {
-    if (!sbuffer->root)
-    {
-#ifdef SB_VERBOSE
-        printf("[SB_Dump] Empty S-Buffer!\n");
-#endif // SB_VERBOSE
+    const float buffer_width_half = sbuffer->size * 0.5f;
+    const float _z_near = 1.0f / sbuffer->z_near;
+    const float z0 = 1.0f / w0, z1 = 1.0f / w1;
+    const span2_t a = { (x0 - buffer_width_half) * z0 * _z_near, z0 };
+    const span2_t b = { (x1 - buffer_width_half) * z1 * _z_near, z1 };
 
-        return;
-    }
+    return _SB_Push(sbuffer, x0, x1, w0, w1, a, b, 0, id, color, -1);
+}
 
-    const size_t max_depth = sbuffer->max_depth + 1;
-    const span_t* curr = sbuffer->root;
-    const span_t* stack[max_depth];
-    byte_t bookmarks[max_depth];
-    byte_t visited[max_depth];
-    byte_t has_right_sibling[max_depth];
-    int sp = 0; // stack pointer
-    int cp = 0; // child pointer
+//
+// SB_PushView
+// Push a segment onto the buffer with endpoints `(x0, z0)` and `(x1, z1)` in
+// view space, where the eye is at the origin looking toward +z, and the screen
+// lies on the near-clipping plane `z = z_near`.
+//
+// The segment is clipped against the near-clipping plane, projected onto the
+// screen, and sorted in ascending screen space x before being pushed. Returns
+// non-zero if nothing was pushed -- which is always the case for segments
+// lying entirely behind the near-clipping plane.
+//
+int
+SB_PushView
+( sbuffer_t* sbuffer,
+  float  x0, float z0,
+  float  x1, float z1,
+  byte_t id,
+  int    color )
+{
+    const float z_near = sbuffer->z_near;
 
-    *visited = 0;
-    *has_right_sibling = 0;
+    if (z0 < z_near && z1 < z_near) return 1;
 
-    while (curr)
+    /* clip against the near-clipping plane -- this also keeps the projection
+     * from dividing by zero for segments passing through the eye
+     */
+    if (z0 < z_near)
     {
-        SB_ASSERT(sp < max_depth, "[SB_Dump] Maximum buffer depth reached!\n");
+        x0 += (x1 - x0) * (z_near - z0) / (z1 - z0);
+        z0 = z_near;
+    }
+    else if (z1 < z_near)
+    {
+        x1 += (x0 - x1) * (z_near - z1) / (z0 - z1);
+        z1 = z_near;
+    }
 
-        const byte_t previously_visited = *(visited + sp);
-        *(stack + sp) = curr;
-        *(bookmarks + sp) = cp;
-        *(visited + sp++) = 0xff;
+    const float buffer_width_half = sbuffer->size * 0.5f;
+    const float w0 = 1.0f / z0, w1 = 1.0f / z1;
+    const float screen_src = buffer_width_half + x0 * z_near * w0;
+    const float screen_dst = buffer_width_half + x1 * z_near * w1;
+    const byte_t src_min = screen_src <= screen_dst;
+    const span2_t src = { x0, z0 }, dst = { x1, z1 };
 
-        if (!previously_visited)
-        {
-            const size_t self = sp - 1;
+    /* sort the endpoints in ascending screen space x before pushing the
+     * segment onto the buffer
+     */
+    return _SB_Push(sbuffer,
+                    src_min ? screen_src : screen_dst,
+                    src_min ? screen_dst : screen_src,
+                    src_min ? w0 : w1,
+                    src_min ? w1 : w0,
+                    src_min ? src : dst,
+                    src_min ? dst : src,
+                    0,
+                    id,
+                    color,
+                    -1);
+}
 
-            if (self) printf(" ");
+//
+// SB_PushHomogeneous
+// Push a segment onto the buffer with endpoints `(x0, w0)` and `(x1, w1)` in
+// clip space, where a point `(x, z)` in view space (see `SB_PushView`) is
+//
+// `x_clip = z_near * x + size / 2 * z`
+// `w_clip = z`
+//
+// and `x_clip / w_clip` is where it ends up on the screen. Lines stay lines in
+// clip space, so the segment is tested against the spans in the buffer in
+// homogeneous coordinates, without having to take the reciprocals of depths
+// at every span visited -- divisions are left for the points where the spans
+// actually need splitting. Returns non-zero if nothing was pushed.
+//
+int
+SB_PushHomogeneous
+( sbuffer_t* sbuffer,
+  float  x0, float w0,
+  float  x1, float w1,
+  byte_t id,
+  int    color )
+{
+    const float z_near = sbuffer->z_near;
 
-            for (size_t i = 1; i < self; ++i)
-            {
-                 if (*(has_right_sibling + i)) printf("%s  ", SB_REPR_ARM0);
-                 else printf("   ");
-            }
+    if (w0 < z_near && w1 < z_near) return 1;
 
-            if (self)
-            {
-                if (*(bookmarks + self - 1) || !(*(stack + self - 1))->next)
+    /* clip against the near-clipping plane `w_clip = z_near` */
+    if (w0 < z_near)
+    {
+        x0 += (x1 - x0) * (z_near - w0) / (w1 - w0);
+        w0 = z_near;
+    }
+    else if (w1 < z_near)
+    {
+        x1 += (x0 - x1) * (z_near - w1) / (w0 - w1);
+        w1 = z_near;
+    }
+
+    const float screen_w0 = 1.0f / w0, screen_w1 = 1.0f / w1;
+    const float screen_src = x0 * screen_w0, screen_dst = x1 * screen_w1;
+    const byte_t src_min = screen_src <= screen_dst;
+    const span2_t src = { x0, w0 }, dst = { x1, w1 };
+
+    return _SB_Push(sbuffer,
+                    src_min ? screen_src : screen_dst,
+                    src_min ? screen_dst : screen_src,
+                    src_min ? screen_w0 : screen_w1,
+                    src_min ? screen_w1 : screen_w0,
+                    src_min ? src : dst,
+                    src_min ? dst : src,
+                    0xff,
+                    id,
+                    color,
+                    -1);
+}
+
+//
+// SB_InitProjection
+// Allocate room for `capacity` projected segments in one go.
+//
+sbprojection_t* SB_InitProjection (size_t capacity)
+{
+    sbprojection_t* projection =
+        (sbprojection_t*) malloc(sizeof(sbprojection_t));
+    float* floats = (float*) malloc((capacity ? capacity : 1) *
+                                    SB_PROJECTION_FLOATS * sizeof(float));
+
+    projection->x0 = floats;
+    projection->x1 = projection->x0 + capacity;
+    projection->w0 = projection->x1 + capacity;
+    projection->w1 = projection->w0 + capacity;
+    projection->vx0 = projection->w1 + capacity;
+    projection->vz0 = projection->vx0 + capacity;
+    projection->vx1 = projection->vz0 + capacity;
+    projection->vz1 = projection->vx1 + capacity;
+    projection->index = (size_t*) malloc((capacity ? capacity : 1) *
+                                         sizeof(size_t));
+    projection->count = 0;
+    projection->capacity = capacity;
+
+    return projection;
+}
+
+//
+// SB_DestroyProjection
+//
+void SB_DestroyProjection (sbprojection_t* projection)
+{
+    free(projection->x0);
+    free(projection->index);
+    free(projection);
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_ProjectVectors
+// Transform a segment in each lane by the camera in the same lane, clip it
+// against the near-clipping plane, and project it onto the buffer -- all lanes
+// at once, without branching. The lanes that survived the near-plane and
+// frustum rejection are stored in `visible`.
+//
+SB_KERNEL
+void
+SB_ProjectVectors
+( const sb_vf* src_x, const sb_vf* src_y,
+  const sb_vf* dst_x, const sb_vf* dst_y,
+  const sb_vf* eye_x, const sb_vf* eye_y,
+  const sb_vf* cos_angle, const sb_vf* sin_angle,
+  float  buffer_width,
+  float  z_near,
+  sb_vi* visible,
+  sb_vf* x0, sb_vf* x1,
+  sb_vf* w0, sb_vf* w1,
+  sb_vf* vx0, sb_vf* vz0,
+  sb_vf* vx1, sb_vf* vz1 )
+{
+    /* world space to view space: x along `right`, z along `forward` */
+    const sb_vf sx = *src_x - *eye_x, sy = *src_y - *eye_y;
+    const sb_vf dx = *dst_x - *eye_x, dy = *dst_y - *eye_y;
+    sb_vf src_vx = sx * *cos_angle + sy * *sin_angle;
+    sb_vf src_vz = sx * *sin_angle - sy * *cos_angle;
+    sb_vf dst_vx = dx * *cos_angle + dy * *sin_angle;
+    sb_vf dst_vz = dx * *sin_angle - dy * *cos_angle;
+
+    /* clip against the near-clipping plane -- lanes with both endpoints
+     * behind it divide by zero here at worst, and get rejected below anyway
+     */
+    const sb_vi src_behind = src_vz < z_near, dst_behind = dst_vz < z_near;
+    const sb_vf src_t = (z_near - src_vz) / (dst_vz - src_vz);
+    const sb_vf dst_t = (z_near - dst_vz) / (src_vz - dst_vz);
+    const sb_vf near = (sb_vf) { 0 } + z_near;
+    const sb_vf src_clipped_vx = src_vx + (dst_vx - src_vx) * src_t;
+    const sb_vf dst_clipped_vx = dst_vx + (src_vx - dst_vx) * dst_t;
+    src_vx = SB_SELECT(src_behind, src_clipped_vx, src_vx);
+    src_vz = SB_SELECT(src_behind, near, src_vz);
+    dst_vx = SB_SELECT(dst_behind, dst_clipped_vx, dst_vx);
+    dst_vz = SB_SELECT(dst_behind, near, dst_vz);
+
+    /* project onto the buffer */
+    const sb_vf src_w = 1.0f / src_vz, dst_w = 1.0f / dst_vz;
+    const sb_vf screen_src = buffer_width * 0.5f + src_vx * z_near * src_w;
+    const sb_vf screen_dst = buffer_width * 0.5f + dst_vx * z_near * dst_w;
+
+    /* sort the endpoints in ascending screen space x */
+    const sb_vi src_min = screen_src <= screen_dst;
+    *x0 = SB_SELECT(src_min, screen_src, screen_dst);
+    *x1 = SB_SELECT(src_min, screen_dst, screen_src);
+    *w0 = SB_SELECT(src_min, src_w, dst_w);
+    *w1 = SB_SELECT(src_min, dst_w, src_w);
+    *vx0 = SB_SELECT(src_min, src_vx, dst_vx);
+    *vz0 = SB_SELECT(src_min, src_vz, dst_vz);
+    *vx1 = SB_SELECT(src_min, dst_vx, src_vx);
+    *vz1 = SB_SELECT(src_min, dst_vz, src_vz);
+
+    /* reject the segments that are entirely behind the near-clipping plane,
+     * outside the view frustum, or edge-on
+     */
+    *visible = ~(src_behind & dst_behind) &
+               (*x1 > 0) & (*x0 < buffer_width) & (*x0 < *x1);
+}
+
+//
+// SB_ProjectLanes
+// Transform `SB_LANES` segments by the camera, clip them against the
+// near-clipping plane, and project them onto the buffer -- all lanes at once,
+// without branching. Returns a mask of the lanes that survived the near-plane
+// and frustum rejection.
+//
+SB_KERNEL
+int
+SB_ProjectLanes
+( const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  float eye_x, float eye_y,
+  float cos_angle, float sin_angle,
+  float buffer_width,
+  float z_near,
+  sb_vf* x0, sb_vf* x1,
+  sb_vf* w0, sb_vf* w1,
+  sb_vf* vx0, sb_vf* vz0,
+  sb_vf* vx1, sb_vf* vz1 )
+{
+    const sb_vf zero = { 0 };
+    const sb_vf ex = zero + eye_x, ey = zero + eye_y;
+    const sb_vf cos_v = zero + cos_angle, sin_v = zero + sin_angle;
+    sb_vf sx, sy, dx, dy;
+    sb_vi visible;
+    __builtin_memcpy(&sx, src_x, sizeof(sb_vf));
+    __builtin_memcpy(&sy, src_y, sizeof(sb_vf));
+    __builtin_memcpy(&dx, dst_x, sizeof(sb_vf));
+    __builtin_memcpy(&dy, dst_y, sizeof(sb_vf));
+
+    SB_ProjectVectors(&sx, &sy, &dx, &dy,
+                      &ex, &ey,
+                      &cos_v, &sin_v,
+                      buffer_width,
+                      z_near,
+                      &visible,
+                      x0, x1, w0, w1,
+                      vx0, vz0, vx1, vz1);
+    int mask = 0;
+
+    for (int i = 0; i < SB_LANES; ++i) mask |= !!visible[i] << i;
+
+    return mask;
+}
+
+//
+// SB_ProjectMany
+// Transform `n` world space segments from `(src_x, src_y)` to `(dst_x, dst_y)`
+// by the camera, clip them against the near-clipping plane, and project them
+// onto the buffer, `SB_LANES` segments at a time. Segments that end up outside
+// the view frustum are rejected; the rest are stored in `out` along with the
+// indices they had in the input, ready to be handed to `SB_PushMany`.
+//
+// `out` needs to have room for at least `n` segments.
+//
+SB_KERNEL
+void
+_SB_ProjectMany
+( const sbuffer_t*  sbuffer,
+  const sbcamera_t* camera,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  sbprojection_t* out )
+{
+    const float cos_angle = cosf(camera->angle);
+    const float sin_angle = sinf(camera->angle);
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; i += SB_LANES)
+    {
+        const size_t lanes = SB_MIN(n - i, SB_LANES);
+        float tail[4][SB_LANES];
+        const float* in[4] = { src_x + i, src_y + i, dst_x + i, dst_y + i };
+
+        /* pad the last few segments out to a full set of lanes */
+        if (lanes < SB_LANES)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                for (size_t k = 0; k < SB_LANES; ++k)
+                    *(*(tail + j) + k) = k < lanes ? *(*(in + j) + k) : 0;
+
+                *(in + j) = *(tail + j);
+            }
+        }
+
+        sb_vf x0, x1, w0, w1, vx0, vz0, vx1, vz1;
+        int mask = SB_ProjectLanes(*in, *(in + 1), *(in + 2), *(in + 3),
+                                   camera->x, camera->y,
+                                   cos_angle, sin_angle,
+                                   sbuffer->size,
+                                   sbuffer->z_near,
+                                   &x0, &x1, &w0, &w1,
+                                   &vx0, &vz0, &vx1, &vz1);
+        mask &= (1 << lanes) - 1;
+
+        /* compact the survivors */
+        for (int k = 0; mask; ++k, mask >>= 1)
+        {
+            if (!(mask & 1)) continue;
+
+            *(out->x0 + count) = x0[k];
+            *(out->x1 + count) = x1[k];
+            *(out->w0 + count) = w0[k];
+            *(out->w1 + count) = w1[k];
+            *(out->vx0 + count) = vx0[k];
+            *(out->vz0 + count) = vz0[k];
+            *(out->vx1 + count) = vx1[k];
+            *(out->vz1 + count) = vz1[k];
+            *(out->index + count) = i + k;
+            ++count;
+        }
+    }
+
+    out->count = count;
+}
+
+SB_VARIANTS(
+void, SB_ProjectMany,
+( const sbuffer_t*  sbuffer,
+  const sbcamera_t* camera,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  sbprojection_t* out ),
+(sbuffer, camera, src_x, src_y, dst_x, dst_y, n, out))
+
+#ifndef S_BUFFER_WIDE
+
+void
+SB_ProjectMany
+( const sbuffer_t*  sbuffer,
+  const sbcamera_t* camera,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  sbprojection_t* out )
+{
+    SB_ASSERT(n <= out->capacity,
+              "[SB_ProjectMany] Not enough room for the projected segments!\n");
+
+    SB_DISPATCH(sbuffer->isa, SB_ProjectMany,
+                sbuffer, camera, src_x, src_y, dst_x, dst_y, n, out);
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_IntersectLanes
+// `SB_SpanIntersect` on a planar buffer, resolved by `SB_ResolveHit`, for
+// `SB_LANES` pairs of spans at once: every branch of the scalar routines is
+// evaluated in all lanes, and the results are picked in the same order of
+// precedence the scalar routines return them in. Each operation is carried out
+// exactly the way the scalar routines do it.
+//
+SB_KERNEL
+void
+SB_IntersectLanes
+( const float* const* in,
+  float buffer_width,
+  float z_near,
+  float t_min, float t_max,
+  sb_vi* codes,
+  sb_vf* out,
+  sb_vf* leftness )
+{
+    const float DEGENERACY_EPS = 1e-5;
+    const float ANGULAR_EPS = 1e-5;
+    const float ANGULAR_EPS_SQ = ANGULAR_EPS * ANGULAR_EPS;
+    const sb_vi ABS_MASK = (sb_vi) { 0 } + 0x7fffffff;
+
+    sb_vf v[SB_PAIRS_FLOATS];
+    for (int i = 0; i < SB_PAIRS_FLOATS; ++i)
+        __builtin_memcpy(v + i, *(in + i), sizeof(sb_vf));
+
+    const sb_vf a_x = *v, a_z = *(v + 1), b_x = *(v + 2), b_z = *(v + 3);
+    const sb_vf u_x0 = *(v + 4), u_x1 = *(v + 5);
+    const sb_vf v_x0 = *(v + 6), v_w0 = *(v + 7);
+    const sb_vf v_x1 = *(v + 8), v_w1 = *(v + 9);
+
+    /* the latter span into view space */
+    const float buffer_width_half = buffer_width * 0.5f;
+    const float _z_near = 1.0f / z_near;
+    const sb_vf v_z0 = 1.0f / v_w0, v_z1 = 1.0f / v_w1;
+    const sb_vf v_wx0 = (v_x0 - buffer_width_half) * v_z0 * _z_near;
+    const sb_vf v_wx1 = (v_x1 - buffer_width_half) * v_z1 * _z_near;
+
+    /* `SB_Intersect2D` */
+    const sb_vf u_x = b_x - a_x, u_z = b_z - a_z;
+    const sb_vf d_x = v_wx1 - v_wx0, d_z = v_z1 - v_z0;
+    const sb_vf c_a_x = v_wx0 - a_x, c_a_z = v_z0 - a_z;
+    const sb_vf numer_t = c_a_x * d_z - c_a_z * d_x;
+    const sb_vf numer_q = c_a_x * u_z - c_a_z * u_x;
+    const sb_vf denom = u_x * d_z - u_z * d_x;
+    const sb_vf u_sq = u_x * u_x + u_z * u_z, v_sq = d_x * d_x + d_z * d_z;
+    const sb_vf c_a_sq = c_a_x * c_a_x + c_a_z * c_a_z;
+
+    const sb_vi zero_numer_t = (sb_vf) ((sb_vi) numer_t & ABS_MASK) <
+                               DEGENERACY_EPS;
+    const sb_vi zero_numer_q = (sb_vf) ((sb_vi) numer_q & ABS_MASK) <
+                               DEGENERACY_EPS;
+    const sb_vi zero_denom = (sb_vf) ((sb_vi) denom & ABS_MASK) <
+                             DEGENERACY_EPS;
+    const sb_vi nonzero_numer =
+        ~(zero_numer_t | zero_numer_q |
+          (numer_t * numer_t <= ANGULAR_EPS_SQ * c_a_sq * v_sq) |
+          (numer_q * numer_q <= ANGULAR_EPS_SQ * c_a_sq * u_sq));
+    const sb_vi nonzero_denom =
+        ~(zero_denom | (denom * denom <= ANGULAR_EPS_SQ * u_sq * v_sq));
+
+    const sb_vf denom_ = 1 / denom;
+    const sb_vf t = numer_t * denom_, q = numer_q * denom_;
+    const sb_vi outside = (t <= t_min) | (t >= t_max) |
+                          (q <= t_min) | (q >= t_max);
+    const sb_vf i_x = t * u_x + a_x, i_z = t * u_z + a_z;
+
+    /* back to screen space, demoting the intersections that land on an
+     * endpoint, or on the part of the former span already inserted
+     */
+    const sb_vf x = i_x * z_near / i_z + buffer_width_half;
+    const sb_vi on_endpoint = (x <= u_x0) | (x >= u_x1) |
+                              (x <= v_x0) | (x >= v_x1);
+
+    const sb_vi degenerate = ~(nonzero_numer | nonzero_denom);
+    const sb_vi parallel = nonzero_numer & ~nonzero_denom;
+    const sb_vi intersecting = ~degenerate & ~parallel & nonzero_numer &
+                               ~outside & ~on_endpoint;
+    const sb_vi not_intersecting = ~degenerate & ~parallel & ~intersecting;
+
+    *codes = (degenerate & SB_DEGENERATE) | (parallel & SB_PARALLEL) |
+             (not_intersecting & SB_NOT_INTERSECTING);
+    *out = SB_SELECT(intersecting, x, (sb_vf) { 0 });
+
+    /* the leftness of the former span's start relative to the point of
+     * intersection -- or of its end relative to the latter span when they
+     * are not intersecting
+     */
+    const sb_vf l_u_x = SB_SELECT(intersecting, a_x - i_x, b_x - v_wx0);
+    const sb_vf l_u_z = SB_SELECT(intersecting, a_z - i_z, b_z - v_z0);
+    const sb_vf l_v_x = SB_SELECT(intersecting, v_wx0 - i_x, d_x);
+    const sb_vf l_v_z = SB_SELECT(intersecting, v_z0 - i_z, d_z);
+    const sb_vf cross = l_u_x * l_v_z - l_u_z * l_v_x;
+    *leftness = SB_SELECT(intersecting | not_intersecting, cross, (sb_vf) { 0 });
+}
+
+//
+// _SB_IntersectMany
+// Run `SB_IntersectLanes` over all `n` pairs, padding the last few out to a
+// full set of lanes.
+//
+SB_KERNEL
+void
+_SB_IntersectMany
+( const sbuffer_t* sbuffer,
+  const sbpairs_t* pairs,
+  size_t           n,
+  byte_t*          codes,
+  float*           out,
+  float*           leftness )
+{
+    /* `SB_Intersect2D` compares single precision parameters against the double
+     * precision `SB_EPS` -- find the single precision bounds that are
+     * equivalent to those comparisons
+     */
+    float t_min = SB_EPS, t_max = 1 - SB_EPS;
+    if (t_min > SB_EPS) t_min = nextafterf(t_min, 0);
+    if (t_max < 1 - SB_EPS) t_max = nextafterf(t_max, 1);
+
+    const float* arrays[SB_PAIRS_FLOATS] = {
+        pairs->ax, pairs->az, pairs->bx, pairs->bz,
+        pairs->u_x0, pairs->u_x1,
+        pairs->v_x0, pairs->v_w0, pairs->v_x1, pairs->v_w1
+    };
+
+    for (size_t i = 0; i < n; i += SB_LANES)
+    {
+        const size_t lanes = SB_MIN(n - i, SB_LANES);
+        float tail[SB_PAIRS_FLOATS][SB_LANES];
+        const float* in[SB_PAIRS_FLOATS];
+
+        for (size_t j = 0; j < SB_PAIRS_FLOATS; ++j)
+        {
+            *(in + j) = *(arrays + j) + i;
+
+            /* pad the last few pairs out to a full set of lanes */
+            if (lanes < SB_LANES)
+            {
+                for (size_t k = 0; k < SB_LANES; ++k)
+                    *(*(tail + j) + k) = k < lanes ? *(*(in + j) + k) : 1;
+
+                *(in + j) = *(tail + j);
+            }
+        }
+
+        sb_vi lane_codes;
+        sb_vf lane_out, lane_leftness;
+        SB_IntersectLanes(in, sbuffer->size, sbuffer->z_near, t_min, t_max,
+                          &lane_codes, &lane_out, &lane_leftness);
+
+        for (size_t k = 0; k < lanes; ++k)
+        {
+            *(codes + i + k) = lane_codes[k];
+            *(out + i + k) = lane_out[k];
+            *(leftness + i + k) = lane_leftness[k];
+        }
+    }
+}
+
+SB_VARIANTS(
+void, SB_IntersectMany,
+( const sbuffer_t* sbuffer,
+  const sbpairs_t* pairs,
+  size_t           n,
+  byte_t*          codes,
+  float*           out,
+  float*           leftness ),
+(sbuffer, pairs, n, codes, out, leftness))
+
+#ifndef S_BUFFER_WIDE
+
+#ifdef SB_DEBUG
+//
+// SB_VerifyIntersectMany
+// Whether the batched intersection tests agree with the ones `SB_Push` runs on
+// every pair, bit-for-bit.
+//
+static
+byte_t
+SB_VerifyIntersectMany
+( const sbuffer_t* sbuffer,
+  const sbpairs_t* pairs,
+  size_t           n,
+  const byte_t*    codes,
+  const float*     out,
+  const float*     leftness )
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const span2_t a = { *(pairs->ax + i), *(pairs->az + i) };
+        const span2_t b = { *(pairs->bx + i), *(pairs->bz + i) };
+        float expected_out = 0, expected_leftness;
+        sbhit_t hit;
+
+        SB_SpanIntersect(sbuffer,
+                         a, b,
+                         *(pairs->v_x0 + i), *(pairs->v_w0 + i),
+                         *(pairs->v_x1 + i), *(pairs->v_w1 + i),
+                         0,
+                         &hit);
+
+        const byte_t expected_code = SB_ResolveHit(&hit,
+                                                   *(pairs->u_x0 + i),
+                                                   *(pairs->u_x1 + i),
+                                                   &expected_out,
+                                                   &expected_leftness);
+
+        if (expected_code != *(codes + i)) return 0;
+        if (memcmp(&expected_leftness, leftness + i, sizeof(float))) return 0;
+        if (!expected_code && memcmp(&expected_out, out + i, sizeof(float)))
+            return 0;
+    }
+
+    return 1;
+}
+#endif // SB_DEBUG
+
+//
+// SB_IntersectMany
+// Calculate the intersections of `n` pairs of spans the same way `SB_Push`
+// does, `SB_LANES` pairs at a time. The classification codes are stored in
+// `codes`, the screen space x of each point of intersection in `out` (`0`
+// unless the spans are intersecting), and the leftness of each former span in
+// `leftness` -- see `SB_SpanIntersect` for what they mean. Planar buffers only.
+//
+void
+SB_IntersectMany
+( const sbuffer_t* sbuffer,
+  const sbpairs_t* pairs,
+  size_t           n,
+  byte_t*          codes,
+  float*           out,
+  float*           leftness )
+{
+    SB_ASSERT(!sbuffer->turn,
+              "[SB_IntersectMany] Cylindrical buffers are not supported!\n");
+
+    SB_DISPATCH(sbuffer->isa, SB_IntersectMany,
+                sbuffer, pairs, n, codes, out, leftness);
+
+#ifdef SB_DEBUG
+    SB_ASSERT(SB_VerifyIntersectMany(sbuffer, pairs, n, codes, out, leftness),
+              "[SB_IntersectMany] Disagrees with the scalar path!\n");
+#endif // SB_DEBUG
+}
+
+//
+// SB_PushMany
+// Push every segment projected by `SB_ProjectMany` onto the buffer, in the
+// order they were given in. `ids` and `colors` are indexed the same way the
+// input segments were.
+//
+// Returns how many of them were pushed.
+//
+size_t
+SB_PushMany
+( sbuffer_t*            sbuffer,
+  const sbprojection_t* projection,
+  const byte_t*         ids,
+  const int*            colors )
+{
+    size_t pushed = 0;
+
+    for (size_t i = 0; i < projection->count; ++i)
+    {
+        const size_t index = *(projection->index + i);
+        const span2_t a = { *(projection->vx0 + i), *(projection->vz0 + i) };
+        const span2_t b = { *(projection->vx1 + i), *(projection->vz1 + i) };
+
+        pushed += !_SB_Push(sbuffer,
+                            *(projection->x0 + i), *(projection->x1 + i),
+                            *(projection->w0 + i), *(projection->w1 + i),
+                            a, b,
+                            0,
+                            *(ids + index),
+                            *(colors + index),
+                            (int) index);
+    }
+
+    return pushed;
+}
+
+//
+// SB_PushClipped
+// Push a span onto the buffer the same way `SB_Push` does, after having clipped
+// it to the window `[clip_x0, clip_x1)` -- in addition to the clip window
+// currently in effect.
+//
+int
+SB_PushClipped
+( sbuffer_t* sbuffer,
+  float  clip_x0, float clip_x1,
+  float  x0,      float x1,
+  float  w0,      float w1,
+  byte_t id,
+  int    color )
+{
+    int res = 1;
+
+    if (!SB_PushClipWindow(sbuffer, clip_x0, clip_x1))
+        res = SB_Push(sbuffer, x0, x1, w0, w1, id, color);
+
+    SB_PopClipWindow(sbuffer);
+
+    return res;
+}
+
+// MULTI-ROW BUFFERS ///////////////////////////////////////////////////////////
+//
+// a convex polygon set up for stepping down the rows: the intersection of the
+// half-planes to the right of its left edges and to the left of its right ones,
+// with its reciprocal depths `w = a + b * x + c * y` across it
+typedef struct {
+    float* left;  // the left edges as `x = x0 + dxdy * y`, two floats each
+    float* right; // ...and the right ones
+    int    lefts, rights;
+    float  a, b, c;
+    int    first_row, last_row; // the rows `[first_row, last_row)` it covers
+} sbedges_t;
+
+// where a polygon stands as `SB_PushCoherent` sweeps down the rows
+typedef struct {
+    float x0, x1; // the span it covers on the current row
+    float w0, w1; // ...and the reciprocal depths at its endpoints
+    int   active; // the last row it was stepped down to
+    int   row;    // the last row it ended up visible on
+    int   prim;   // ...and the primitive it got there
+} sbsweep_t;
+
+//
+// SB_InitEdges
+// Set a convex polygon with `n` vertices `(x, y, w)` up for stepping down the
+// rows of `rows`, with room for `n` edges at each of `left` and `right`.
+// Returns a non-zero value if the polygon is degenerate, or covers no rows.
+//
+static
+int
+SB_InitEdges
+( const sbrows_t* rows,
+  const float* x, const float* y,
+  const float* w,
+  int          n,
+  float* left, float* right,
+  sbedges_t*   out )
+{
+    float y_min = FLT_MAX, y_max = -FLT_MAX, cx = 0, cy = 0;
+    float area = 0, a = 0, b = 0, c = 0;
+
+    for (int i = 0; i < n; ++i)
+    {
+        y_min = SB_MIN(y_min, *(y + i));
+        y_max = SB_MAX(y_max, *(y + i));
+        cx += *(x + i) / n;
+        cy += *(y + i) / n;
+    }
+
+    /* the reciprocal depths across the polygon lie on a plane -- solve it over
+     * the largest triangle fanning out of the first vertex
+     */
+    for (int i = 1; i + 1 < n; ++i)
+    {
+        const float dx1 = *(x + i) - *x, dy1 = *(y + i) - *y;
+        const float dx2 = *(x + i + 1) - *x, dy2 = *(y + i + 1) - *y;
+        const float det = SB_CROSS_2D(dx1, dy1, dx2, dy2);
+
+        if (fabsf(det) <= fabsf(area)) continue;
+
+        const float dw1 = *(w + i) - *w, dw2 = *(w + i + 1) - *w;
+        area = det;
+        b = SB_CROSS_2D(dw1, dy1, dw2, dy2) / det;
+        c = SB_CROSS_2D(dx1, dw1, dx2, dw2) / det;
+        a = *w - b * *x - c * *y;
+    }
+
+    const sbedges_t edges = {
+        left, right, 0, 0, a, b, c,
+        SB_MAX(ceil(y_min - 0.5f), 0),
+        SB_MIN(ceil(y_max - 0.5f), rows->height)
+    };
+    *out = edges;
+
+    /* degenerate, or not on any row */
+    if (fabsf(area) < SB_EPS || out->first_row >= out->last_row) return 1;
+
+    for (int i = 0; i < n; ++i)
+    {
+        const int j = (i + 1) % n;
+        const float dy = *(y + j) - *(y + i);
+
+        /* horizontal edges are taken care of by the rows stepped */
+        if (dy == 0) continue;
+
+        const float dxdy = (*(x + j) - *(x + i)) / dy;
+        const float x0 = *(x + i) - *(y + i) * dxdy;
+        float* edge;
+
+        /* which side of the edge the polygon lies */
+        if (cx > x0 + dxdy * cy) edge = left + (out->lefts++ << 1);
+        else edge = right + (out->rights++ << 1);
+
+        *edge = x0;
+        *(edge + 1) = dxdy;
+    }
+
+    return 0;
+}
+
+//
+// SB_InitRows
+// Initialize a stack of `height` buffers, one for each row of the screen, each
+// `width` wide -- `z_near` and `max_depth` are the same as with `SB_Init`.
+//
+sbrows_t*
+SB_InitRows
+( int width, int height,
+  float  z_near,
+  size_t max_depth )
+{
+    sbrows_t* rows = (sbrows_t*) malloc(sizeof(sbrows_t));
+
+    rows->width = width;
+    rows->height = height;
+    rows->rows = (sbuffer_t**) malloc(height * sizeof(sbuffer_t*));
+
+    for (int i = 0; i < height; ++i)
+        *(rows->rows + i) = SB_Init(width, z_near, max_depth);
+
+    return rows;
+}
+
+static span_t* SB_CloneSpans (const span_t* span)
+{
+    if (!span) return 0;
+
+    span_t* clone = (span_t*) malloc(sizeof(span_t));
+
+    *clone = *span;
+    clone->prev = SB_CloneSpans(span->prev);
+    clone->next = SB_CloneSpans(span->next);
+
+    return clone;
+}
+
+//
+// SB_Clone
+// Make a deep copy of a buffer, spans, primitives, clip windows and all.
+//
+static sbuffer_t* SB_Clone (const sbuffer_t* sbuffer)
+{
+    sbuffer_t* clone = (sbuffer_t*) malloc(sizeof(sbuffer_t));
+
+    *clone = *sbuffer;
+    clone->root = SB_CloneSpans(sbuffer->root);
+    clone->prims = (sbprim_t*) malloc(sbuffer->prims_capacity *
+                                      sizeof(sbprim_t));
+    memcpy(clone->prims, sbuffer->prims,
+           sbuffer->prims_count * sizeof(sbprim_t));
+
+    if (sbuffer->buckets)
+    {
+        clone->buckets = (sbbucket_t*) malloc(sbuffer->buckets_count *
+                                              sizeof(sbbucket_t));
+
+        for (int i = 0; i < sbuffer->buckets_count; ++i)
+        {
+            const sbbucket_t* bucket = sbuffer->buckets + i;
+            sbbucket_t* bucket_clone = clone->buckets + i;
+
+            *bucket_clone = *bucket;
+            bucket_clone->spans = (sbentry_t*) malloc(bucket->capacity *
+                                                      sizeof(sbentry_t));
+            memcpy(bucket_clone->spans, bucket->spans,
+                   bucket->count * sizeof(sbentry_t));
+        }
+    }
+
+    return clone;
+}
+
+//
+// SB_Shared
+// Whether the buffer of `row` is shared with either of its neighbours -- rows
+// only ever share their buffers with the rows next to them, see `SB_ShareRows`.
+//
+static byte_t SB_Shared (const sbrows_t* rows, int row)
+{
+    sbuffer_t* const* slot = rows->rows + row;
+
+    return (row > 0 && *(slot - 1) == *slot) ||
+           (row + 1 < rows->height && *(slot + 1) == *slot);
+}
+
+//
+// SB_Row
+// The buffer of `row`, ready to be pushed onto: should it be shared with any
+// other rows, it is copied first, and the copy takes its place. Should the row
+// be in the middle of a run of rows sharing a buffer, the rows below it are
+// handed a copy of their own to share as well, so that the rows still sharing
+// any one buffer are always next to one another.
+//
+sbuffer_t* SB_Row (sbrows_t* rows, int row)
+{
+    sbuffer_t** slot = rows->rows + row;
+    sbuffer_t* shared = *slot;
+
+    if (!SB_Shared(rows, row)) return shared;
+
+    *slot = SB_Clone(shared);
+
+    if (row > 0 && *(slot - 1) == shared &&
+        row + 1 < rows->height && *(slot + 1) == shared)
+    {
+        sbuffer_t* below = SB_Clone(shared);
+
+        for (sbuffer_t** next = slot + 1;
+             next < rows->rows + rows->height && *next == shared;
+             ++next)
+            *next = below;
+    }
+
+    return *slot;
+}
+
+//
+// SB_ReleaseRow
+// Free up the buffer of `row`, unless any other rows still share it.
+//
+static void SB_ReleaseRow (sbrows_t* rows, int row)
+{
+    if (!SB_Shared(rows, row)) SB_Destroy(*(rows->rows + row));
+}
+
+//
+// SB_SameClip
+// Whether two buffers have the very same clip windows in effect.
+//
+static byte_t SB_SameClip (const sbuffer_t* a, const sbuffer_t* b)
+{
+    if (a->clip_depth != b->clip_depth) return 0;
+
+    return !memcmp(a->clip_stack, b->clip_stack,
+                   a->clip_depth * sizeof(*a->clip_stack));
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_RowLanes
+// Step the edges of a polygon down `SB_LANES` consecutive rows starting at
+// `row`, all lanes at once, and clip the span it covers on each row against
+// that row's clip window `[clip_x0, clip_x1)`. Each span comes out with its
+// reciprocal depths as well as its endpoints in view space, the way `SB_Push`
+// hands them to `_SB_Push`.
+//
+// Rows that are fully covered (`cover`) by surfaces all nearer (`w_far`) than
+// the polygon are culled on the way. Returns a mask of the lanes left to push.
+//
+SB_KERNEL
+int
+SB_RowLanes
+( const sbedges_t* edges,
+  int row, int last_row,
+  const float* clip_x0, const float* clip_x1,
+  const float* cover, const float* w_far,
+  float buffer_width,
+  float z_near,
+  sb_vf* x0, sb_vf* x1,
+  sb_vf* w0, sb_vf* w1,
+  sb_vf* ax, sb_vf* az,
+  sb_vf* bx, sb_vf* bz )
+{
+    sb_vf lane, left, right, row_cover, row_w_far;
+    for (int i = 0; i < SB_LANES; ++i) lane[i] = i;
+    __builtin_memcpy(&left, clip_x0, sizeof(sb_vf));
+    __builtin_memcpy(&right, clip_x1, sizeof(sb_vf));
+    __builtin_memcpy(&row_cover, cover, sizeof(sb_vf));
+    __builtin_memcpy(&row_w_far, w_far, sizeof(sb_vf));
+
+    /* sample each row at its center */
+    const sb_vf y = lane + (row + 0.5f);
+
+    /* the polygon covers whatever lies right of all of its left edges, and
+     * left of all of its right ones
+     */
+    for (int i = 0; i < edges->lefts; ++i)
+    {
+        const float* edge = edges->left + (i << 1);
+        const sb_vf x = *edge + *(edge + 1) * y;
+        left = SB_SELECT(x > left, x, left);
+    }
+
+    for (int i = 0; i < edges->rights; ++i)
+    {
+        const float* edge = edges->right + (i << 1);
+        const sb_vf x = *edge + *(edge + 1) * y;
+        right = SB_SELECT(x < right, x, right);
+    }
+
+    *x0 = left;
+    *x1 = right;
+    *w0 = edges->a + edges->b * left + edges->c * y;
+    *w1 = edges->a + edges->b * right + edges->c * y;
+
+    /* back to view space */
+    const float _z_near = 1.0f / z_near;
+    *az = 1.0f / *w0;
+    *bz = 1.0f / *w1;
+    *ax = (left - buffer_width * 0.5f) * *az * _z_near;
+    *bx = (right - buffer_width * 0.5f) * *bz * _z_near;
+
+    /* nothing on a fully covered row is farther than the polygon anywhere */
+    const sb_vf w_near = SB_SELECT(*w0 > *w1, *w0, *w1);
+    const sb_vi hidden = (row_cover >= buffer_width - (float) SB_EPS) &
+                         (row_w_far > w_near);
+    const sb_vi visible =
+        (lane + (float) row < (float) last_row) & (left < right) & ~hidden;
+    int mask = 0;
+
+    for (int i = 0; i < SB_LANES; ++i) mask |= !!visible[i] << i;
+
+    return mask;
+}
+
+SB_KERNEL
+void
+_SB_PushPolygon
+( sbrows_t*        rows,
+  const sbedges_t* edges,
+  int first_row, int last_row,
+  byte_t  id,
+  int     color,
+  size_t* pushed )
+{
+    const sbuffer_t* top = *rows->rows;
+
+    for (int row = first_row; row < last_row; row += SB_LANES)
+    {
+        float clip_x0[SB_LANES], clip_x1[SB_LANES];
+        float cover[SB_LANES], w_far[SB_LANES];
+        int empty = 0;
+
+        /* gather what each row is clipped against, how covered it is, and
+         * whether there's anything on it at all
+         */
+        for (int i = 0; i < SB_LANES; ++i)
+        {
+            const sbuffer_t* sbuffer =
+                *(rows->rows + SB_MIN(row + i, last_row - 1));
+            const span_t* root = sbuffer->root;
+
+            empty |= (!root && !sbuffer->buckets) << i;
+            *(clip_x0 + i) = 0;
+            *(clip_x1 + i) = sbuffer->size;
+            *(cover + i) = root ? root->cover : 0;
+            *(w_far + i) = root ? root->w_far : 0;
+
+            if (sbuffer->clip_depth)
+            {
+                const float* window =
+                    *(sbuffer->clip_stack + sbuffer->clip_depth - 1);
+                *(clip_x0 + i) = *window;
+                *(clip_x1 + i) = *(window + 1);
+            }
+        }
+
+        sb_vf x0, x1, w0, w1, ax, az, bx, bz;
+        int mask = SB_RowLanes(edges,
+                               row, last_row,
+                               clip_x0, clip_x1,
+                               cover, w_far,
+                               top->size,
+                               top->z_near,
+                               &x0, &x1, &w0, &w1,
+                               &ax, &az, &bx, &bz);
+
+        /* the span makes up the whole tree of the rows still empty... */
+        for (int k = 0, lanes = mask & empty; lanes; ++k, lanes >>= 1)
+        {
+            if (!(lanes & 1)) continue;
+
+            sbuffer_t* sbuffer = SB_Row(rows, row + k);
+            const int prim = SB_Prim(sbuffer,
+                                     x0[k], x1[k],
+                                     w0[k], w1[k],
+                                     id,
+                                     color,
+                                     -1);
+
+            sbuffer->root = SB_Span(x0[k], x1[k], prim);
+            SB_Refresh(sbuffer);
+            ++*pushed;
+        }
+
+        /* ...and only the rest of the surviving rows need to descend into
+         * their buffers
+         */
+        for (int k = 0, lanes = mask & ~empty; lanes; ++k, lanes >>= 1)
+        {
+            if (!(lanes & 1)) continue;
+
+            const span2_t a = { ax[k], az[k] }, b = { bx[k], bz[k] };
+
+            *pushed += !_SB_Push(SB_Row(rows, row + k),
+                                 x0[k], x1[k],
+                                 w0[k], w1[k],
+                                 a, b,
+                                 0,
+                                 id,
+                                 color,
+                                 -1);
+        }
+    }
+}
+
+SB_VARIANTS(
+void, SB_PushPolygon,
+( sbrows_t*        rows,
+  const sbedges_t* edges,
+  int first_row, int last_row,
+  byte_t  id,
+  int     color,
+  size_t* pushed ),
+(rows, edges, first_row, last_row, id, color, pushed))
+
+#ifndef S_BUFFER_WIDE
+
+//
+// SB_PushPolygon
+// Push a convex polygon with `n` vertices `(x, y, w)` in perspective-correct
+// screen space onto each row it covers -- `x` and `y` being screen space
+// coordinates, and `w` the reciprocal depths, the same as with `SB_Push`.
+// Vertices may wind either way.
+//
+// Rows are sampled at their centers, and advanced `SB_LANES` at a time: the
+// edges are stepped, and the spans clipped against each row's clip window in
+// lockstep. Rows that are already covered by nearer surfaces from end to end
+// are culled all at once, and rows that are still empty get their span as the
+// root of their tree -- neither descending into their buffers.
+//
+// Returns how many of the rows the polygon ended up visible on, and zero if it
+// has fewer than three vertices.
+//
+size_t
+SB_PushPolygon
+( sbrows_t*    rows,
+  const float* x, const float* y,
+  const float* w,
+  int          n,
+  byte_t       id,
+  int          color )
+{
+    if (n < 3) return 0;
+
+    float left[n << 1], right[n << 1];
+    sbedges_t edges;
+
+    if (SB_InitEdges(rows, x, y, w, n, left, right, &edges)) return 0;
+
+    size_t pushed = 0;
+
+    SB_DISPATCH((*rows->rows)->isa, SB_PushPolygon,
+                rows, &edges, edges.first_row, edges.last_row, id, color,
+                &pushed);
+
+    return pushed;
+}
+
+//
+// SB_EdgesSpan
+// The span `[*x0, *x1)` a polygon set up by `SB_InitEdges` covers on `row`,
+// sampled at its center, and clipped against `[clip_x0, clip_x1)`.
+//
+static
+void
+SB_EdgesSpan
+( const sbedges_t* edges,
+  int    row,
+  float  clip_x0, float clip_x1,
+  float* x0, float* x1 )
+{
+    const float y = row + 0.5f;
+
+    *x0 = clip_x0;
+    *x1 = clip_x1;
+
+    for (int i = 0; i < edges->lefts; ++i)
+    {
+        const float* edge = edges->left + (i << 1);
+        *x0 = SB_MAX(*x0, *edge + *(edge + 1) * y);
+    }
+
+    for (int i = 0; i < edges->rights; ++i)
+    {
+        const float* edge = edges->right + (i << 1);
+        *x1 = SB_MIN(*x1, *edge + *(edge + 1) * y);
+    }
+}
+
+//
+// SB_Interpenetrate
+// Report whether or not two polygons might swap places in front of one another
+// somewhere their bounding boxes `(x_min, x_max, y_min, y_max)` overlap. The
+// difference in between their reciprocal depths is affine, so it takes the
+// four corners of the overlap to tell.
+//
+static
+byte_t
+SB_Interpenetrate
+( const sbedges_t* p, const float* p_box,
+  const sbedges_t* q, const float* q_box )
+{
+    const float x0 = SB_MAX(*p_box, *q_box);
+    const float x1 = SB_MIN(*(p_box + 1), *(q_box + 1));
+    const float y0 = SB_MAX(*(p_box + 2), *(q_box + 2));
+    const float y1 = SB_MIN(*(p_box + 3), *(q_box + 3));
+
+    if (x0 > x1 || y0 > y1) return 0;
+
+    int fronts = 0, backs = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const float x = i & 1 ? x1 : x0, y = i & 2 ? y1 : y0;
+        const float w_p = p->a + p->b * x + p->c * y;
+        const float w_q = q->a + q->b * x + q->c * y;
+
+        /* `1 / w - 1 / w' > eps`, the way `SB_Push` tells the nearer one */
+        fronts += w_p - w_q > SB_EPS * w_p * w_q;
+        backs += w_q - w_p > SB_EPS * w_p * w_q;
+    }
+
+    return fronts != 4 && backs != 4;
+}
+
+static void SB_Dirty (float* dirty, int* n, float x0, float x1)
+{
+    if (!(x1 > x0)) return;
+
+    *(dirty + (*n << 1)) = x0;
+    *(dirty + ((*n)++ << 1) + 1) = x1;
+}
+
+static int SB_CompareIntervals (const void* a, const void* b)
+{
+    const float x0 = *((const float*) a), x1 = *((const float*) b);
+
+    return (x0 > x1) - (x0 < x1);
+}
+
+//
+// SB_InitPolygons
+// Set each of `n` polygons up for stepping down the rows with `SB_InitEdges`,
+// with room for twice as many floats as there are vertices in total at each of
+// `left` and `right`. Polygons that are degenerate, or cover no rows, are left
+// starting and ending on the row past the last. Returns how many are not.
+//
+static
+int
+SB_InitPolygons
+( const sbrows_t*    rows,
+  const sbpolygon_t* polygons,
+  int                n,
+  float* left, float* right,
+  sbedges_t*         out )
+{
+    int valid = 0;
+
+    for (int i = 0, offset = 0; i < n; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+        sbedges_t* edges = out + i;
+
+        if (SB_InitEdges(rows,
+                         polygon->x, polygon->y,
+                         polygon->w,
+                         polygon->n,
+                         left + offset, right + offset,
+                         edges))
+            edges->first_row = edges->last_row = rows->height;
+        else ++valid;
+
+        offset += polygon->n << 1;
+    }
+
+    return valid;
+}
+
+//
+// SB_SameSweep
+// Whether the spans `list` that `SB_PushCoherent` resolved `row` to are the
+// very same as those of the row above it, `previous`, down to the primitives
+// they are parts of -- in which case the tree of the row above will do.
+//
+static
+byte_t
+SB_SameSweep
+( const sbrows_t*  rows,
+  int              row,
+  const sbsweep_t* sweep,
+  const sbentry_t* list,     int count,
+  const sbentry_t* previous, int previous_count )
+{
+    const sbuffer_t* above = *(rows->rows + row - 1);
+
+    if (count != previous_count ||
+        !SB_SameClip(*(rows->rows + row), above) ||
+        memcmp(list, previous, count * sizeof(sbentry_t)))
+        return 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sbsweep_t* polygon = sweep + (list + i)->prim;
+        const sbprim_t* prim = above->prims + polygon->prim;
+
+        /* the way `SB_Prim` would make it */
+        if (polygon->row != row - 1 ||
+            prim->x0 != polygon->x0 ||
+            prim->w0 != polygon->w0 ||
+            prim->dw != (polygon->w1 - polygon->w0) /
+                        (polygon->x1 - polygon->x0))
+            return 0;
+    }
+
+    return 1;
+}
+
+//
+// SB_PushCoherent
+// Push `n` convex polygons onto the rows all at once, deriving each row from
+// the one above it the way span renderers with an active edge table do -- see
+// `SB_PushPolygon` for how each polygon is given. The rows are expected to be
+// empty, and are built from scratch.
+//
+// The spans visible on the previous row are carried over to the next one, and
+// clipped against where their polygons reach on it. Unless two polygons cut
+// into one another, whichever is in front stays in front wherever both of them
+// reach, so only the following are ever resolved again on a row:
+// - whatever a span carried over no longer covers,
+// - whatever a polygon reaches on the row but did not on the one above it --
+//   the whole of it on the row it starts on,
+// - and wherever polygons that might cut into one another overlap.
+//
+// The cost of each row is then down to the polygons that start, end, widen, or
+// swap places on it, rather than the spans on it -- each row's tree is built in
+// one go, perfectly balanced. Polygons are told apart on each row the same way
+// `SB_InitBuckets` buffers resolve overlaps, in screen space.
+//
+// Rows that end up with the very same spans as the rows above them share their
+// trees -- see `SB_ShareRows`.
+//
+// Returns how many rows each polygon ended up visible on, summed up.
+//
+size_t
+SB_PushCoherent
+( sbrows_t*          rows,
+  const sbpolygon_t* polygons,
+  int                n )
+{
+    const sbuffer_t* top = *rows->rows;
+    int vertices = 0;
+
+    for (int i = 0; i < rows->height; ++i)
+    {
+        SB_ASSERT(!(*(rows->rows + i))->root &&
+                  !(*(rows->rows + i))->buckets,
+                  "[SB_PushCoherent] Rows are expected to be empty!\n");
+    }
+
+    for (int i = 0; i < n; ++i) vertices += (polygons + i)->n;
+
+    sbedges_t* edges = (sbedges_t*) malloc((n + 1) * sizeof(sbedges_t));
+    sbsweep_t* sweep = (sbsweep_t*) malloc((n + 1) * sizeof(sbsweep_t));
+    float* left = (float*) malloc(((vertices << 1) + 1) * sizeof(float));
+    float* right = (float*) malloc(((vertices << 1) + 1) * sizeof(float));
+    float* boxes = (float*) malloc(((n << 2) + 1) * sizeof(float));
+    int* order = (int*) malloc((n + 1) * sizeof(int));
+    int* active = (int*) malloc((n + 1) * sizeof(int));
+    int* starts = (int*) calloc(rows->height + 1, sizeof(int));
+    int* partners_start = (int*) calloc(n + 1, sizeof(int));
+    int* partners_end = (int*) calloc(n + 1, sizeof(int));
+    const int valid = SB_InitPolygons(rows, polygons, n, left, right, edges);
+
+    for (int i = 0; i < n; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+        float* box = boxes + (i << 2);
+
+        *box = *(box + 2) = FLT_MAX;
+        *(box + 1) = *(box + 3) = -FLT_MAX;
+
+        for (int j = 0; j < polygon->n; ++j)
+        {
+            *box = SB_MIN(*box, *(polygon->x + j));
+            *(box + 1) = SB_MAX(*(box + 1), *(polygon->x + j));
+            *(box + 2) = SB_MIN(*(box + 2), *(polygon->y + j));
+            *(box + 3) = SB_MAX(*(box + 3), *(polygon->y + j));
+        }
+
+        ++*(starts + (edges + i)->first_row);
+        (sweep + i)->active = (sweep + i)->row = -1;
+    }
+
+    /* sort the polygons by the rows they start on, by counting */
+    for (int i = 0, sum = 0; i <= rows->height; ++i)
+    {
+        const int count = *(starts + i);
+        *(starts + i) = sum;
+        sum += count;
+    }
+
+    for (int i = 0; i < n; ++i)
+        *(order + (*(starts + (edges + i)->first_row))++) = i;
+
+    /* pairs of polygons that might cut into one another are looked out for on
+     * every row they share -- found by sweeping down the rows ahead of time,
+     * each polygon being tested only against those still around on the row it
+     * starts on, and listed under the latter of the two
+     */
+    int partners_count = 0, partners_capacity = n + 1;
+    int* partners = (int*) malloc(partners_capacity * sizeof(int));
+    int live_count = 0;
+
+    for (int o = 0; o < valid; ++o)
+    {
+        const int j = *(order + o);
+        int count = 0;
+
+        /* `active` is free to keep the ones still around in until the rows
+         * are swept down for real
+         */
+        for (int i = 0; i < live_count; ++i)
+        {
+            const int polygon = *(active + i);
+
+            if ((edges + polygon)->last_row > (edges + j)->first_row)
+                *(active + count++) = polygon;
+        }
+        live_count = count;
+
+        *(partners_start + j) = partners_count;
+
+        for (int i = 0; i < live_count; ++i)
+        {
+            const int polygon = *(active + i);
+
+            if (!SB_Interpenetrate(edges + polygon, boxes + (polygon << 2),
+                                   edges + j, boxes + (j << 2)))
+                continue;
+
+            if (partners_count == partners_capacity)
+            {
+                partners_capacity <<= 1;
+                partners = (int*) realloc(partners,
+                                          partners_capacity * sizeof(int));
+            }
+
+            *(partners + partners_count++) = polygon;
+        }
+
+        *(partners_end + j) = partners_count;
+        *(active + live_count++) = j;
+    }
+
+    /* the primitives the polygons are resolved against one another with, one
+     * for each polygon, re-written on every row
+     */
+    sbuffer_t* scratch = SB_Init(rows->width, top->z_near, 0);
+    scratch->prims = (sbprim_t*) realloc(scratch->prims,
+                                         (n + 1) * sizeof(sbprim_t));
+    scratch->prims_count = scratch->prims_capacity = n;
+
+    /* the spans visible on the previous row, and what is carried over of them
+     * to the current one -- each holding the index of its polygon as `prim`
+     */
+    sbentry_t *list = 0, *kept = 0, *carved = 0, *next_list = 0;
+    int list_count = 0, list_capacity = 0;
+    float* dirty = 0;
+    int dirty_capacity = 0;
+    sbbucket_t* buckets = 0;
+    int buckets_capacity = 0;
+    int active_count = 0, next = 0, built = -1;
+    size_t pushed = 0;
+
+    for (int row = 0; row < rows->height && (next < valid || active_count);
+         ++row)
+    {
+        sbuffer_t* sbuffer = *(rows->rows + row);
+        float clip_x0 = 0, clip_x1 = sbuffer->size;
+
+        if (sbuffer->clip_depth)
+        {
+            const float* window =
+                *(sbuffer->clip_stack + sbuffer->clip_depth - 1);
+            clip_x0 = *window;
+            clip_x1 = *(window + 1);
+        }
+
+        /* retire the polygons that ended on the previous row... */
+        int count = 0;
+        for (int i = 0; i < active_count; ++i)
+        {
+            const int polygon = *(active + i);
+
+            if ((edges + polygon)->last_row > row)
+                *(active + count++) = polygon;
+        }
+        active_count = count;
+
+        /* ...and bring in those that start on this one, keeping the polygons
+         * in the order they were given, as that is the order they are pushed
+         * in wherever they tie
+         */
+        int starting = 0;
+        while (next + starting < valid &&
+               (edges + *(order + next + starting))->first_row == row)
+        {
+            sbsweep_t* polygon = sweep + *(order + next + starting++);
+            polygon->x0 = polygon->x1 = 0;
+        }
+
+        for (int i = active_count - 1, j = starting - 1, k = i + starting;
+             j >= 0;
+             --k)
+        {
+            const int polygon = *(order + next + j);
+
+            if (i >= 0 && *(active + i) > polygon)
+            {
+                *(active + k) = *(active + i--);
+
+                continue;
+            }
+
+            *(active + k) = polygon;
+            --j;
+        }
+
+        active_count += starting;
+        next += starting;
+
+        const int bound = (active_count << 1) + (list_count << 1) +
+                          partners_count + 1;
+        if (bound > dirty_capacity)
+        {
+            dirty_capacity = SB_MAX(bound, dirty_capacity << 1);
+            dirty = (float*) realloc(dirty,
+                                     (dirty_capacity << 1) * sizeof(float));
+        }
+
+        int dirty_count = 0;
+
+        /* step the edges of each polygon down to this row: whatever it reaches
+         * on it but did not on the previous one is up for grabs
+         */
+        for (int i = 0; i < active_count; ++i)
+        {
+            const int index = *(active + i);
+            const sbedges_t* polygon_edges = edges + index;
+            sbsweep_t* polygon = sweep + index;
+            sbprim_t* prim = scratch->prims + index;
+            const float y = row + 0.5f;
+            const float prev_x0 = polygon->x0, prev_x1 = polygon->x1;
+
+            SB_EdgesSpan(polygon_edges,
+                         row,
+                         clip_x0, clip_x1,
+                         &polygon->x0, &polygon->x1);
+            polygon->w0 = polygon_edges->a +
+                          polygon_edges->b * polygon->x0 +
+                          polygon_edges->c * y;
+            polygon->w1 = polygon_edges->a +
+                          polygon_edges->b * polygon->x1 +
+                          polygon_edges->c * y;
+            polygon->active = row;
+
+            if (!(polygon->x1 > polygon->x0)) continue;
+
+            prim->x0 = polygon->x0;
+            prim->w0 = polygon->w0;
+            prim->dw = (polygon->w1 - polygon->w0) /
+                       (polygon->x1 - polygon->x0);
+
+            if (!(prev_x1 > prev_x0))
+            {
+                SB_Dirty(dirty, &dirty_count, polygon->x0, polygon->x1);
+
+                continue;
+            }
+
+            SB_Dirty(dirty, &dirty_count,
+                     polygon->x0, SB_MIN(prev_x0, polygon->x1));
+            SB_Dirty(dirty, &dirty_count,
+                     SB_MAX(prev_x1, polygon->x0), polygon->x1);
+        }
+
+        /* polygons that might cut into one another are sorted out afresh
+         * wherever they overlap
+         */
+        for (int i = 0; i < active_count; ++i)
+        {
+            const int index = *(active + i);
+            const sbsweep_t* polygon = sweep + index;
+
+            for (int j = *(partners_start + index);
+                 j < *(partners_end + index);
+                 ++j)
+            {
+                const sbsweep_t* partner = sweep + *(partners + j);
+
+                if (partner->active != row) continue;
+
+                SB_Dirty(dirty, &dirty_count,
+                         SB_MAX(polygon->x0, partner->x0),
+                         SB_MIN(polygon->x1, partner->x1));
+            }
+        }
+
+        /* carry the spans of the previous row over, clipped against where their
+         * polygons reach on this one
+         */
+        int kept_count = 0;
+        for (int i = 0; i < list_count; ++i)
+        {
+            const sbentry_t* span = list + i;
+            const sbsweep_t* polygon = sweep + span->prim;
+
+            if (polygon->active != row)
+            {
+                SB_Dirty(dirty, &dirty_count, span->x0, span->x1);
+
+                continue;
+            }
+
+            const float lo = SB_MAX(span->x0, polygon->x0);
+            const float hi = SB_MIN(span->x1, polygon->x1);
+
+            if (!(hi > lo))
+            {
+                SB_Dirty(dirty, &dirty_count, span->x0, span->x1);
+
+                continue;
+            }
+
+            SB_Dirty(dirty, &dirty_count, span->x0, lo);
+            SB_Dirty(dirty, &dirty_count, hi, span->x1);
+            (kept + kept_count)->x0 = lo;
+            (kept + kept_count)->x1 = hi;
+            (kept + kept_count++)->prim = span->prim;
+        }
+
+        /* merge what is up for grabs into disjoint intervals */
+        qsort(dirty, dirty_count, sizeof(float) << 1, SB_CompareIntervals);
+
+        int intervals = 0;
+        for (int i = 0; i < dirty_count; ++i)
+        {
+            const float lo = *(dirty + (i << 1)), hi = *(dirty + (i << 1) + 1);
+            float* last = dirty + ((intervals ? intervals - 1 : 0) << 1);
+
+            if (intervals && lo <= *(last + 1))
+            {
+                *(last + 1) = SB_MAX(*(last + 1), hi);
+
+                continue;
+            }
+
+            *(dirty + (intervals << 1)) = lo;
+            *(dirty + (intervals++ << 1) + 1) = hi;
+        }
+
+        if (intervals > buckets_capacity)
+        {
+            const int capacity = SB_MAX(intervals, buckets_capacity << 1);
+            buckets = (sbbucket_t*) realloc(buckets,
+                                            capacity * sizeof(sbbucket_t));
+            for (int i = buckets_capacity; i < capacity; ++i)
+            {
+                (buckets + i)->spans = 0;
+                (buckets + i)->capacity = 0;
+            }
+            buckets_capacity = capacity;
+        }
+
+        /* resolve each interval with the polygons that reach into it */
+        int resolved = 0;
+        for (int i = 0; i < intervals; ++i) (buckets + i)->count = 0;
+
+        for (int i = 0; i < active_count; ++i)
+        {
+            const int index = *(active + i);
+            const sbsweep_t* polygon = sweep + index;
+
+            if (!(polygon->x1 > polygon->x0)) continue;
+
+            /* the first interval that ends past where the polygon starts */
+            int lo = 0, hi = intervals;
+            while (lo < hi)
+            {
+                const int mid = (lo + hi) >> 1;
+
+                if (*(dirty + (mid << 1) + 1) > polygon->x0) hi = mid;
+                else lo = mid + 1;
+            }
+
+            for (int j = lo;
+                 j < intervals && *(dirty + (j << 1)) < polygon->x1;
+                 ++j)
+            {
+                SB_PushBucket(scratch, buckets + j,
+                              SB_MAX(*(dirty + (j << 1)), polygon->x0),
+                              SB_MIN(*(dirty + (j << 1) + 1), polygon->x1),
+                              index);
+            }
+        }
+
+        for (int i = 0; i < intervals; ++i) resolved += (buckets + i)->count;
+
+        if (kept_count + intervals + resolved > list_capacity)
+        {
+            list_capacity = SB_MAX(kept_count + intervals + resolved,
+                                   list_capacity << 1);
+            list = (sbentry_t*) realloc(list,
+                                        list_capacity * sizeof(sbentry_t));
+            next_list = (sbentry_t*) realloc(next_list,
+                                             list_capacity *
+                                             sizeof(sbentry_t));
+            kept = (sbentry_t*) realloc(kept,
+                                        list_capacity * sizeof(sbentry_t));
+            carved = (sbentry_t*) realloc(carved,
+                                          list_capacity * sizeof(sbentry_t));
+        }
+
+        /* cut the intervals out of what is carried over... */
+        int carved_count = 0;
+        for (int i = 0, j = 0; i < kept_count; ++i)
+        {
+            const sbentry_t* span = kept + i;
+            float x = span->x0;
+
+            while (j < intervals && *(dirty + (j << 1) + 1) <= x) ++j;
+
+            for (int k = j; x < span->x1; ++k)
+            {
+                const float lo = k < intervals ? *(dirty + (k << 1)) : FLT_MAX;
+
+                SB_Emit(carved, &carved_count,
+                        x, SB_MIN(lo, span->x1),
+                        span->prim);
+
+                if (k == intervals) break;
+
+                x = *(dirty + (k << 1) + 1);
+            }
+        }
+
+        /* ...and fill them back in, in order */
+        int next_count = 0;
+        for (int i = 0, j = 0; i < carved_count || j < intervals; )
+        {
+            const float interval_x0 =
+                j < intervals ? *(dirty + (j << 1)) : FLT_MAX;
+
+            if (i < carved_count && (carved + i)->x0 < interval_x0)
+            {
+                const sbentry_t* span = carved + i++;
+                SB_Emit(next_list, &next_count, span->x0, span->x1, span->prim);
+
+                continue;
+            }
+
+            const sbbucket_t* bucket = buckets + j;
+            for (int k = 0; k < bucket->count; ++k)
+            {
+                const sbentry_t* span = bucket->spans + k;
+                SB_Emit(next_list, &next_count, span->x0, span->x1, span->prim);
+            }
+
+            ++j;
+        }
+
+        sbentry_t* swap = list;
+        const int previous_count = list_count;
+        list = next_list;
+        next_list = swap;
+        list_count = next_count;
+
+        if (!list_count) continue;
+
+        /* the very same spans of the very same primitives as on the previous
+         * row make for the very same tree -- share it rather than build it
+         */
+        if (row && built == row - 1 && SB_SameSweep(rows, row, sweep,
+                                                    list, list_count,
+                                                    next_list, previous_count))
+        {
+            SB_ReleaseRow(rows, row);
+            *(rows->rows + row) = *(rows->rows + row - 1);
+            built = row;
+
+            for (int i = 0; i < list_count; ++i)
+            {
+                sbsweep_t* polygon = sweep + (list + i)->prim;
+
+                pushed += polygon->row != row;
+                polygon->row = row;
+            }
+
+            continue;
+        }
+
+        /* build the tree of the row in one go */
+        sbuffer = SB_Row(rows, row);
+        built = row;
+        span_t** spans = (span_t**) malloc(list_count * sizeof(span_t*));
+
+        for (int i = 0; i < list_count; ++i)
+        {
+            const sbentry_t* span = list + i;
+            sbsweep_t* polygon = sweep + span->prim;
+
+            /* each polygon gets a primitive of its own on the rows it is
+             * visible on
+             */
+            if (polygon->row != row)
+            {
+                const sbpolygon_t* source = polygons + span->prim;
+
+                polygon->row = row;
+                polygon->prim = SB_Prim(sbuffer,
+                                        polygon->x0, polygon->x1,
+                                        polygon->w0, polygon->w1,
+                                        source->id,
+                                        source->color,
+                                        span->prim);
+                ++pushed;
+            }
+
+            *(spans + i) = SB_Span(span->x0, span->x1, polygon->prim);
+        }
+
+        sbuffer->root = SB_Build(spans, 0, list_count);
+        SB_Refresh(sbuffer);
+        free(spans);
+    }
+
+    for (int i = 0; i < buckets_capacity; ++i) free((buckets + i)->spans);
+
+    SB_Destroy(scratch);
+    free(buckets);
+    free(dirty);
+    free(carved);
+    free(kept);
+    free(next_list);
+    free(list);
+    free(partners);
+    free(partners_start);
+    free(partners_end);
+    free(starts);
+    free(active);
+    free(order);
+    free(boxes);
+    free(right);
+    free(left);
+    free(sweep);
+    free(edges);
+
+    return pushed;
+}
+
+// what `SB_PushInterpolated` keeps track of as it fills the rows in
+typedef struct {
+    sbrows_t*          rows;
+    const sbpolygon_t* polygons;
+    const sbedges_t*   edges;
+    int                n;
+    int**              owners; // the polygon behind each primitive of a row
+    int*               prims;  // the primitive of each polygon on a row...
+    int*               stamps; // ...and which row that is
+    size_t             pushed; // how many rows were pushed onto for real
+} sbinterp_t;
+
+//
+// SB_PushRow
+// Push each polygon onto `row` for real, and keep track of which polygon each
+// primitive on the row stands for.
+//
+static void SB_PushRow (sbinterp_t* interp, int row)
+{
+    sbuffer_t* sbuffer = SB_Row(interp->rows, row);
+    int* owners = (int*) malloc(interp->n * sizeof(int));
+    const float y = row + 0.5f;
+
+    for (int i = 0; i < interp->n; ++i)
+    {
+        const sbedges_t* edges = interp->edges + i;
+        const sbpolygon_t* polygon = interp->polygons + i;
+        const int prims_count = sbuffer->prims_count;
+        float x0, x1;
+
+        if (row < edges->first_row || row >= edges->last_row) continue;
+
+        SB_EdgesSpan(edges, row, 0, sbuffer->size, &x0, &x1);
+
+        if (!(x1 > x0)) continue;
+
+        SB_Push(sbuffer,
+                x0, x1,
+                edges->a + edges->b * x0 + edges->c * y,
+                edges->a + edges->b * x1 + edges->c * y,
+                polygon->id,
+                polygon->color);
+
+        /* a primitive is only kept if any of it ended up visible */
+        if (sbuffer->prims_count > prims_count)
+        {
+            (sbuffer->prims + prims_count)->payload = i;
+            *(owners + prims_count) = i;
+        }
+    }
+
+    *(interp->owners + row) = owners;
+    ++interp->pushed;
+}
+
+//
+// SB_RowSequence
+// The spans of a row pushed onto by `SB_PushRow`, in order, each holding the
+// index of its polygon as `prim` -- pieces of the same polygon that meet are
+// one and the same span. Returns how many there are.
+//
+static int SB_RowSequence (const sbinterp_t* interp, int row, sbentry_t** out)
+{
+    const sbuffer_t* sbuffer = *(interp->rows->rows + row);
+    const int* owners = *(interp->owners + row);
+    const int count = SB_Flatten(sbuffer->root, 0, 0);
+    span_t** spans = (span_t**) malloc((count + 1) * sizeof(span_t*));
+    int n = 0;
+
+    *out = (sbentry_t*) malloc((count + 1) * sizeof(sbentry_t));
+    SB_Flatten(sbuffer->root, spans, 0);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const span_t* span = *(spans + i);
+        SB_Emit(*out, &n, span->x0, span->x1, *(owners + span->prim));
+    }
+
+    free(spans);
+
+    return n;
+}
+
+//
+// SB_LerpRow
+// Fill `row` in with the spans `a` and `b` of the rows bracketing it, `t` of
+// the way from the former to the latter -- both being made up of the very same
+// polygons, in the very same order.
+//
+static
+void
+SB_LerpRow
+( sbinterp_t*      interp,
+  int              row,
+  float            t,
+  const sbentry_t* a,
+  const sbentry_t* b,
+  int              count )
+{
+    sbuffer_t* sbuffer = SB_Row(interp->rows, row);
+    span_t** spans = (span_t**) malloc(count * sizeof(span_t*));
+    const float y = row + 0.5f;
+    float clip_x0 = 0, clip_x1 = sbuffer->size;
+    int n = 0;
+
+    if (sbuffer->clip_depth)
+    {
+        const float* window = *(sbuffer->clip_stack + sbuffer->clip_depth - 1);
+        clip_x0 = *window;
+        clip_x1 = *(window + 1);
+    }
+
+    /* both rows are sorted, and so is anything in between */
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = (a + i)->prim;
+        const float x0 = SB_MAX((a + i)->x0 + ((b + i)->x0 - (a + i)->x0) * t,
+                                clip_x0);
+        const float x1 = SB_MIN((a + i)->x1 + ((b + i)->x1 - (a + i)->x1) * t,
+                                clip_x1);
+
+        if (!(x1 > x0)) continue;
+
+        /* each polygon gets a primitive of its own on the row */
+        if (*(interp->stamps + index) != row)
+        {
+            const sbedges_t* edges = interp->edges + index;
+            const sbpolygon_t* polygon = interp->polygons + index;
+
+            *(interp->stamps + index) = row;
+            *(interp->prims + index) =
+                SB_Prim(sbuffer,
+                        0, sbuffer->size,
+                        edges->a + edges->c * y,
+                        edges->a + edges->b * sbuffer->size + edges->c * y,
+                        polygon->id,
+                        polygon->color,
+                        (int) index);
+        }
+
+        *(spans + n++) = SB_Span(x0, x1, *(interp->prims + index));
+    }
+
+    sbuffer->root = SB_Build(spans, 0, n);
+    SB_Refresh(sbuffer);
+    free(spans);
+}
+
+//
+// SB_Reconstruct
+// Fill in the rows strictly in between `first` and `last`, both pushed onto
+// already. Should the two hold the very same polygons in the very same order,
+// the rows in between are interpolated from them. Otherwise, the row halfway
+// in between is pushed onto for real, and each half is taken care of in turn.
+//
+static void SB_Reconstruct (sbinterp_t* interp, int first, int last)
+{
+    if (last - first < 2) return;
+
+    sbentry_t *a, *b;
+    const int count = SB_RowSequence(interp, first, &a);
+    byte_t same = count == SB_RowSequence(interp, last, &b);
+
+    for (int i = 0; i < count && same; ++i)
+        same = (a + i)->prim == (b + i)->prim;
+
+    if (same)
+    {
+        for (int row = first + 1; row < last; ++row)
+        {
+            const float t = (float) (row - first) / (last - first);
+            SB_LerpRow(interp, row, t, a, b, count);
+        }
+    }
+
+    free(a);
+    free(b);
+
+    if (same) return;
+
+    const int mid = (first + last) >> 1;
+
+    SB_PushRow(interp, mid);
+    SB_Reconstruct(interp, first, mid);
+    SB_Reconstruct(interp, mid, last);
+}
+
+//
+// SB_PushInterpolated
+// Push `n` convex polygons onto the rows all at once -- see `SB_PushPolygon`
+// for how each polygon is given -- pushing them onto every `stride`-th row
+// (and the last one) only, and filling in the rows in between. The rows are
+// expected to be empty.
+//
+// Wherever two such rows hold the very same polygons in the very same order,
+// the endpoints of the spans in between are interpolated from theirs, and the
+// spans made into a tree in one go. Wherever they do not, the row halfway in
+// between is pushed onto for real, and so on until each stretch of rows is
+// bracketed by rows that agree, or there are no rows left in between. The
+// error is then confined to where the edges bend, or the polygons cross, in
+// between rows that agree on their order.
+//
+// Meant for previews and thumbnails, where the cost of pushing goes down by
+// about `stride` for the lack of accuracy.
+//
+// Returns how many rows were pushed onto for real.
+//
+size_t
+SB_PushInterpolated
+( sbrows_t*          rows,
+  const sbpolygon_t* polygons,
+  int                n,
+  int                stride )
+{
+    int vertices = 0;
+
+    for (int i = 0; i < rows->height; ++i)
+    {
+        SB_ASSERT(!(*(rows->rows + i))->root &&
+                  !(*(rows->rows + i))->buckets,
+                  "[SB_PushInterpolated] Rows are expected to be empty!\n");
+    }
+
+    SB_ASSERT(stride > 0, "[SB_PushInterpolated] Stride must be positive!\n");
+
+    for (int i = 0; i < n; ++i) vertices += (polygons + i)->n;
+
+    sbedges_t* edges = (sbedges_t*) malloc((n + 1) * sizeof(sbedges_t));
+    float* left = (float*) malloc(((vertices << 1) + 1) * sizeof(float));
+    float* right = (float*) malloc(((vertices << 1) + 1) * sizeof(float));
+    sbinterp_t interp = {
+        rows, polygons, edges, n,
+        (int**) calloc(rows->height, sizeof(int*)),
+        (int*) malloc((n + 1) * sizeof(int)),
+        (int*) malloc((n + 1) * sizeof(int)),
+        0
+    };
+
+    SB_InitPolygons(rows, polygons, n, left, right, edges);
+
+    for (int i = 0; i < n; ++i) *(interp.stamps + i) = -1;
+
+    for (int row = 0; row < rows->height; row += stride)
+    {
+        const int last = SB_MIN(row + stride, rows->height - 1);
+
+        if (!row) SB_PushRow(&interp, row);
+        if (last > row) SB_PushRow(&interp, last);
+
+        SB_Reconstruct(&interp, row, last);
+    }
+
+    for (int i = 0; i < rows->height; ++i) free(*(interp.owners + i));
+
+    free(interp.stamps);
+    free(interp.prims);
+    free(interp.owners);
+    free(right);
+    free(left);
+    free(edges);
+
+    return interp.pushed;
+}
+
+static unsigned int SB_Hash (unsigned int hash, const void* data, size_t n)
+{
+    /* FNV-1a */
+    for (size_t i = 0; i < n; ++i)
+        hash = (hash ^ *((const byte_t*) data + i)) * 16777619u;
+
+    return hash;
+}
+
+static unsigned int _SB_HashRow (const sbuffer_t* sbuffer,
+                                 const span_t*    span,
+                                 unsigned int     hash)
+{
+    if (!span) return hash;
+
+    const sbprim_t* prim = SB_PRIM(sbuffer, span);
+
+    hash = _SB_HashRow(sbuffer, span->prev, hash);
+    hash = SB_Hash(hash, &span->x0, sizeof(float));
+    hash = SB_Hash(hash, &span->x1, sizeof(float));
+    hash = SB_Hash(hash, &prim->x0, sizeof(float));
+    hash = SB_Hash(hash, &prim->w0, sizeof(float));
+    hash = SB_Hash(hash, &prim->dw, sizeof(float));
+    hash = SB_Hash(hash, &prim->id, sizeof(byte_t));
+    hash = SB_Hash(hash, &prim->color, sizeof(int));
+    hash = SB_Hash(hash, &prim->payload, sizeof(int));
+
+    return _SB_HashRow(sbuffer, span->next, hash);
+}
+
+//
+// SB_HashRow
+// Hash the sequence of spans in a buffer, along with the primitives they are
+// parts of and the clip windows in effect -- trees that hold the very same
+// spans hash the same, no matter their shape.
+//
+static unsigned int SB_HashRow (const sbuffer_t* sbuffer)
+{
+    unsigned int hash = 2166136261u;
+
+    hash = SB_Hash(hash, &sbuffer->clip_depth, sizeof(int));
+    hash = SB_Hash(hash, sbuffer->clip_stack,
+                   sbuffer->clip_depth * sizeof(*sbuffer->clip_stack));
+
+    return _SB_HashRow(sbuffer, sbuffer->root, hash);
+}
+
+//
+// SB_SameRows
+// Whether two buffers hold the very same spans of the very same primitives,
+// with the very same clip windows in effect.
+//
+static byte_t SB_SameRows (const sbuffer_t* a, const sbuffer_t* b)
+{
+    if (a->size != b->size || a->z_near != b->z_near || !SB_SameClip(a, b))
+        return 0;
+
+    const int count = SB_Flatten(a->root, 0, 0);
+    if (count != SB_Flatten(b->root, 0, 0)) return 0;
+    if (!count) return 1;
+
+    span_t** spans = (span_t**) malloc((count << 1) * sizeof(span_t*));
+    byte_t same = 1;
+
+    SB_Flatten(a->root, spans, 0);
+    SB_Flatten(b->root, spans + count, 0);
+
+    for (int i = 0; i < count && same; ++i)
+    {
+        const span_t *span_a = *(spans + i), *span_b = *(spans + count + i);
+        const sbprim_t* prim_a = SB_PRIM(a, span_a);
+        const sbprim_t* prim_b = SB_PRIM(b, span_b);
+
+        same = span_a->x0 == span_b->x0 && span_a->x1 == span_b->x1 &&
+               prim_a->x0 == prim_b->x0 && prim_a->w0 == prim_b->w0 &&
+               prim_a->dw == prim_b->dw && prim_a->id == prim_b->id &&
+               prim_a->color == prim_b->color &&
+               prim_a->payload == prim_b->payload;
+    }
+
+    free(spans);
+
+    return same;
+}
+
+//
+// SB_ShareRows
+// Find runs of consecutive rows that hold the very same spans -- the sky, a
+// wall seen head on, letterbox bands -- and have each run share a single
+// buffer, freeing up the rest. Rows are told apart by a hash of their spans
+// first, and only compared span by span when the hashes agree.
+//
+// Shared buffers are copied on write: `SB_Row` hands out a copy of its own to
+// the row about to be pushed onto, as does any push onto the rows themselves.
+// Rows are meant to be read through `rows->rows` as usual, and a row that is
+// the same buffer as the one above it is known to look just the same.
+//
+// Returns how many rows gave up their buffers.
+//
+size_t SB_ShareRows (sbrows_t* rows)
+{
+    sbuffer_t** slots = rows->rows;
+    unsigned int hash = SB_HashRow(*slots);
+    size_t shared = 0;
+
+    for (int i = 1; i < rows->height; ++i)
+    {
+        sbuffer_t* row = *(slots + i);
+
+        if (row == *(slots + i - 1)) continue;
+
+        const unsigned int previous_hash = hash;
+        hash = SB_HashRow(row);
+
+        if (row->buckets || (*(slots + i - 1))->buckets ||
+            hash != previous_hash || !SB_SameRows(row, *(slots + i - 1)))
+            continue;
+
+        /* the row may already be sharing its buffer with the rows below */
+        for (int j = i; j < rows->height && *(slots + j) == row; ++j)
+        {
+            *(slots + j) = *(slots + i - 1);
+            ++shared;
+        }
+
+        SB_Destroy(row);
+    }
+
+    return shared;
+}
+
+//
+// SB_DestroyRows
+// Free up all memory allocated by the rows, along with each of their buffers.
+//
+void SB_DestroyRows (sbrows_t* rows)
+{
+    /* rows sharing a buffer are next to one another */
+    for (int i = 0; i < rows->height; ++i)
+    {
+        if (!i || *(rows->rows + i) != *(rows->rows + i - 1))
+            SB_Destroy(*(rows->rows + i));
+    }
+
+    free(rows->rows);
+    free(rows);
+}
+
+// MULTI-COLUMN BUFFERS ////////////////////////////////////////////////////////
+//
+//
+// SB_InitColumns
+// Initialize a row of `width` buffers, one for each column of the screen, each
+// spanning it from top to bottom over `[0, height)` -- `z_near` and `max_depth`
+// are the same as with `SB_Init`.
+//
+sbcolumns_t*
+SB_InitColumns
+( int width, int height,
+  float  z_near,
+  size_t max_depth )
+{
+    sbcolumns_t* columns = (sbcolumns_t*) malloc(sizeof(sbcolumns_t));
+
+    columns->width = width;
+    columns->height = height;
+    columns->columns = (sbuffer_t**) malloc(width * sizeof(sbuffer_t*));
+
+    for (int i = 0; i < width; ++i)
+        *(columns->columns + i) = SB_Init(height, z_near, max_depth);
+
+    return columns;
+}
+
+//
+// SB_PushSlice
+// Push the slice `[y0, y1)` of a surface at reciprocal depth `w` onto the
+// buffer of `column` -- `y` running from the top of the screen down. Columns
+// that are already covered from top to bottom by nearer surfaces are culled
+// without descending into their buffers.
+//
+// Returns non-zero if nothing was pushed, the same as `SB_Push`.
+//
+int
+SB_PushSlice
+( sbcolumns_t* columns,
+  int    column,
+  float  y0, float y1,
+  float  w,
+  byte_t id,
+  int    color )
+{
+    sbuffer_t* sbuffer = *(columns->columns + column);
+    const span_t* root = sbuffer->root;
+
+    /* nothing in a fully covered column is farther than the slice anywhere */
+    if (root && root->cover >= columns->height - SB_EPS && root->w_far > w)
+        return 1;
+
+    return SB_Push(sbuffer, y0, y1, w, w, id, color);
+}
+
+//
+// SB_PushWall
+// Push a wall standing upright in between the screen space x's `x0` and `x1`
+// onto each column it covers -- its top edge running from `top0` to `top1`,
+// its bottom edge from `bottom0` to `bottom1`, and its reciprocal depths from
+// `w0` to `w1` across the screen, the way walls of Doom and Build style
+// engines project. All of them are affine in screen space, and sampled at the
+// center of each column.
+//
+// Returns how many of the columns the wall ended up visible on.
+//
+size_t
+SB_PushWall
+( sbcolumns_t* columns,
+  float  x0,      float x1,
+  float  top0,    float top1,
+  float  bottom0, float bottom1,
+  float  w0,      float w1,
+  byte_t id,
+  int    color )
+{
+    const int first = SB_MAX(ceil(x0 - 0.5f), 0);
+    const int last = SB_MIN(ceil(x1 - 0.5f), columns->width);
+    size_t pushed = 0;
+
+    if (!(x1 > x0)) return 0;
+
+    const float _dx = 1.0f / (x1 - x0);
+
+    for (int column = first; column < last; ++column)
+    {
+        const float t = (column + 0.5f - x0) * _dx;
+
+        pushed += !SB_PushSlice(columns,
+                                column,
+                                top0 + (top1 - top0) * t,
+                                bottom0 + (bottom1 - bottom0) * t,
+                                w0 + (w1 - w0) * t,
+                                id,
+                                color);
+    }
+
+    return pushed;
+}
+
+//
+// SB_DestroyColumns
+// Free up all memory allocated by the columns, along with each of their
+// buffers.
+//
+void SB_DestroyColumns (sbcolumns_t* columns)
+{
+    for (int i = 0; i < columns->width; ++i)
+        SB_Destroy(*(columns->columns + i));
+
+    free(columns->columns);
+    free(columns);
+}
+
+// POLAR BUFFERS ///////////////////////////////////////////////////////////////
+//
+//
+// SB_InitPolar
+// Initialize four buffers all around the viewer at `(x, y)`, each one of them
+// `resolution` pixels wide and looking a quarter turn further counterclockwise
+// than the one before -- the first one covering the angles `[0, π/2)` off of
+// +x. Segments closer to the viewer than `z_near` along the axis of a face are
+// clipped, the same as with `SB_PushView`.
+//
+sbpolar_t*
+SB_InitPolar
+( float x, float y,
+  int    resolution,
+  float  z_near,
+  size_t max_depth )
+{
+    sbpolar_t* polar = (sbpolar_t*) malloc(sizeof(sbpolar_t));
+
+    polar->x = x;
+    polar->y = y;
+    polar->z_near = z_near;
+
+    /* a face sees a quarter turn with its screen half its width away from the
+     * viewer -- the near-clipping plane is up to `SB_PushPolar` instead
+     */
+    for (int i = 0; i < 4; ++i)
+        *(polar->faces + i) = SB_Init(resolution, resolution * 0.5f, max_depth);
+
+    return polar;
+}
+
+//
+// SB_PolarAxes
+// The forward and right axes of `face` -- `forward` points at the middle of the
+// quarter turn the face covers, `right` a quarter turn further, so that the
+// screen space x's of each face run along with the angle.
+//
+static inline void SB_PolarAxes (int face, float* forward, float* right)
+{
+    const float angle = (face * 2 + 1) * SB_PI * 0.25f;
+
+    *forward = cosf(angle);
+    *(forward + 1) = sinf(angle);
+    *right = -*(forward + 1);
+    *(right + 1) = *forward;
+}
+
+//
+// SB_PolarProject
+// Clip the segment with endpoints `(x0, y0)` and `(x1, y1)` in world space
+// against both sides of the quarter turn `face` covers, and its near-clipping
+// plane, in view space -- endpoints projected far off of the face would leave
+// the depths read off of the primitive with nothing but rounding errors to go
+// by. Then project what is left onto the face the same way `SB_PushView` does,
+// sorted in ascending screen space x.
+//
+// Returns non-zero if nothing is left of the segment on the face.
+//
+static
+int
+SB_PolarProject
+( const sbpolar_t* polar,
+  int   face,
+  float x0, float y0,
+  float x1, float y1,
+  float* out_x0, float* out_x1,
+  float* out_w0, float* out_w1,
+  span2_t* a, span2_t* b )
+{
+    const float z_near = polar->z_near;
+    const float half = (*(polar->faces + face))->size * 0.5f;
+    const float dx0 = x0 - polar->x, dy0 = y0 - polar->y;
+    const float dx1 = x1 - polar->x, dy1 = y1 - polar->y;
+    const float planes[3][3] = {
+        { -1, 1, 0 }, { 1, 1, 0 }, { 0, 1, z_near }
+    };
+    float forward[2], right[2];
+
+    SB_PolarAxes(face, forward, right);
+
+    float vx0 = *right * dx0 + *(right + 1) * dy0;
+    float vz0 = *forward * dx0 + *(forward + 1) * dy0;
+    float vx1 = *right * dx1 + *(right + 1) * dy1;
+    float vz1 = *forward * dx1 + *(forward + 1) * dy1;
+
+    for (int k = 0; k < 3; ++k)
+    {
+        const float* plane = *(planes + k);
+        const float d0 = *plane * vx0 + *(plane + 1) * vz0 - *(plane + 2);
+        const float d1 = *plane * vx1 + *(plane + 1) * vz1 - *(plane + 2);
+
+        if (d0 < 0 && d1 < 0) return 1;
+
+        if (d0 < 0)
+        {
+            const float t = d0 / (d0 - d1);
+            vx0 += (vx1 - vx0) * t;
+            vz0 += (vz1 - vz0) * t;
+        }
+        else if (d1 < 0)
+        {
+            const float t = d1 / (d1 - d0);
+            vx1 += (vx0 - vx1) * t;
+            vz1 += (vz0 - vz1) * t;
+        }
+    }
+
+    const float w0 = 1.0f / vz0, w1 = 1.0f / vz1;
+    const float screen_src = half + vx0 * half * w0;
+    const float screen_dst = half + vx1 * half * w1;
+    const byte_t src_min = screen_src <= screen_dst;
+    const span2_t src = { vx0, vz0 }, dst = { vx1, vz1 };
+
+    *out_x0 = src_min ? screen_src : screen_dst;
+    *out_x1 = src_min ? screen_dst : screen_src;
+    *out_w0 = src_min ? w0 : w1;
+    *out_w1 = src_min ? w1 : w0;
+    *a = src_min ? src : dst;
+    *b = src_min ? dst : src;
+
+    return 0;
+}
+
+//
+// SB_PushPolar
+// Push a segment with endpoints `(x0, y0)` and `(x1, y1)` in world space onto
+// the faces it can be seen on from the viewer, split at the seams in between
+// them -- including the one at `2π`. Each part of it is clipped and projected
+// by `SB_PolarProject`, so the depth tests and intersections are carried out
+// in the view space of the face, about the viewer.
+//
+// Returns non-zero if nothing was pushed onto any of the faces.
+//
+static
+int
+_SB_PushPolar
+( sbpolar_t* polar,
+  float  x0, float y0,
+  float  x1, float y1,
+  byte_t id,
+  int    color,
+  int    payload )
+{
+    int culled = 1;
+
+    for (int face = 0; face < 4; ++face)
+    {
+        float sx0, sx1, w0, w1;
+        span2_t a, b;
+
+        if (SB_PolarProject(polar, face,
+                            x0, y0, x1, y1,
+                            &sx0, &sx1, &w0, &w1,
+                            &a, &b))
+            continue;
+
+        culled &= _SB_Push(*(polar->faces + face),
+                           sx0, sx1,
+                           w0, w1,
+                           a, b,
+                           0,
+                           id,
+                           color,
+                           payload) != 0;
+    }
+
+    return culled;
+}
+
+int
+SB_PushPolar
+( sbpolar_t* polar,
+  float  x0, float y0,
+  float  x1, float y1,
+  byte_t id,
+  int    color )
+{
+    return _SB_PushPolar(polar, x0, y0, x1, y1, id, color, -1);
+}
+
+//
+// SB_PolarLocate
+// The face `angle` falls on, wrapped around into `[0, 2π)`, and where on the
+// screen of that face it lands.
+//
+static inline int SB_PolarLocate (const sbpolar_t* polar, float angle, float* x)
+{
+    const float quarter = SB_PI * 0.5f;
+    const float half = (*polar->faces)->size * 0.5f;
+
+    angle -= 4 * quarter * floorf(angle / (4 * quarter));
+
+    const int face = SB_MIN((int) (angle / quarter), 3);
+
+    *x = half + half * tanf(angle - (face + 0.5f) * quarter);
+
+    return face;
+}
+
+//
+// SB_PolarPoint
+// The point in world space that lies at the view space depth `z` along screen
+// space `x` of `face`.
+//
+static inline
+void
+SB_PolarPoint
+( const sbpolar_t* polar,
+  int    face,
+  float  x, float z,
+  float* out )
+{
+    const float half = (*polar->faces)->size * 0.5f;
+    const float vx = (x - half) * z / half;
+    float forward[2], right[2];
+
+    SB_PolarAxes(face, forward, right);
+
+    *out = polar->x + *forward * z + *right * vx;
+    *(out + 1) = polar->y + *(forward + 1) * z + *(right + 1) * vx;
+}
+
+//
+// SB_PolarDistance
+// The distance from the viewer to the nearest surface in the direction of
+// `angle` counterclockwise off of +x, wrapping around as need be. Takes time
+// O(log n) in the spans of the face it falls on.
+//
+// Returns a negative value if there is nothing in that direction.
+//
+float SB_PolarDistance (const sbpolar_t* polar, float angle)
+{
+    float x;
+    const int face = SB_PolarLocate(polar, angle, &x);
+    const sbuffer_t* sbuffer = *(polar->faces + face);
+    const span_t* span = sbuffer->root;
+
+    while (span && (x < span->x0 || x >= span->x1))
+        span = x < span->x0 ? span->prev : span->next;
+
+    if (!span) return -1;
+
+    float point[2];
+    SB_PolarPoint(polar,
+                  face,
+                  x, 1.0f / SB_PRIM_W(SB_PRIM(sbuffer, span), x),
+                  point);
+
+    const float dx = *point - polar->x, dy = *(point + 1) - polar->y;
+
+    return sqrtf(dx * dx + dy * dy);
+}
+
+// the state of a walk around the viewer extracting the visibility polygon --
+// see `SB_VisibilityPolygon`
+typedef struct {
+    const sbpolar_t* polar;
+    int     face;
+    float   range;  // the view space depth of whatever is left uncovered
+    float   cursor; // how far along the face the walk is
+    float  *x, *y;
+    size_t  n, capacity; // vertices past `capacity` are counted, not stored
+    float   first[2], last[2];
+} sbwalk_t;
+
+static void SB_WalkEmit (sbwalk_t* walk, float x, float z)
+{
+    float point[2];
+    SB_PolarPoint(walk->polar, walk->face, x, z, point);
+
+    /* spans and faces meeting end to end share their endpoints */
+    if (walk->n &&
+        SB_Falmeq(*point, *walk->last) &&
+        SB_Falmeq(*(point + 1), *(walk->last + 1)))
+        return;
+
+    if (!walk->n)
+    {
+        *walk->first = *point;
+        *(walk->first + 1) = *(point + 1);
+    }
+
+    *walk->last = *point;
+    *(walk->last + 1) = *(point + 1);
+
+    if (walk->x && walk->n < walk->capacity)
+    {
+        *(walk->x + walk->n) = *point;
+        *(walk->y + walk->n) = *(point + 1);
+    }
+
+    ++walk->n;
+}
+
+static void SB_WalkGap (sbwalk_t* walk, float x)
+{
+    if (x <= walk->cursor) return;
+
+    SB_WalkEmit(walk, walk->cursor, walk->range);
+    SB_WalkEmit(walk, x, walk->range);
+}
+
+static
+void
+SB_Walk
+( sbwalk_t*        walk,
+  const sbuffer_t* sbuffer,
+  const span_t*    span )
+{
+    if (!span) return;
+
+    SB_Walk(walk, sbuffer, span->prev);
+
+    const sbprim_t* prim = SB_PRIM(sbuffer, span);
+
+    SB_WalkGap(walk, span->x0);
+    SB_WalkEmit(walk, span->x0, 1.0f / SB_PRIM_W(prim, span->x0));
+    SB_WalkEmit(walk, span->x1, 1.0f / SB_PRIM_W(prim, span->x1));
+    walk->cursor = span->x1;
+
+    SB_Walk(walk, sbuffer, span->next);
+}
+
+//
+// _SB_VisibilityPolygon
+// `SB_VisibilityPolygon`, storing no more than the first `capacity` vertices
+// -- the rest are only counted.
+//
+static
+size_t
+_SB_VisibilityPolygon
+( const sbpolar_t* polar,
+  float  range,
+  float* x, float* y,
+  size_t capacity )
+{
+    sbwalk_t walk = { polar, 0, range, 0, x, y, 0, capacity, { 0 }, { 0 } };
+    const float size = (*polar->faces)->size;
+
+    for (int face = 0; face < 4; ++face)
+    {
+        const sbuffer_t* sbuffer = *(polar->faces + face);
+
+        walk.face = face;
+        walk.cursor = 0;
+        SB_Walk(&walk, sbuffer, sbuffer->root);
+        SB_WalkGap(&walk, size);
+    }
+
+    /* the walk comes back around to where it started at `2π` */
+    if (walk.n > 1 &&
+        SB_Falmeq(*walk.first, *walk.last) &&
+        SB_Falmeq(*(walk.first + 1), *(walk.last + 1)))
+        --walk.n;
+
+    return walk.n;
+}
+
+//
+// SB_VisibilityPolygon
+// Walk all the way around the viewer, and store the visibility polygon in `x`
+// and `y` as its vertices in counterclockwise order -- whatever is left
+// uncovered is taken to be walled off `range` away from the viewer along the
+// axis of each face, i.e. the viewer is boxed in by a square. Pass zero for
+// `x` to count the vertices only.
+//
+// Takes time O(n) in the spans of the faces, as each one of them is visited
+// once in order. Returns how many vertices the polygon has.
+//
+size_t
+SB_VisibilityPolygon
+( const sbpolar_t* polar,
+  float  range,
+  float* x, float* y )
+{
+    return _SB_VisibilityPolygon(polar, range, x, y, (size_t) -1);
+}
+
+//
+// SB_DestroyPolar
+// Free up all memory allocated by the polar buffer, along with each of its
+// faces.
+//
+void SB_DestroyPolar (sbpolar_t* polar)
+{
+    for (int i = 0; i < 4; ++i) SB_Destroy(*(polar->faces + i));
+
+    free(polar);
+}
+
+// BATCHED LIGHTS //////////////////////////////////////////////////////////////
+//
+//
+// SB_InitGrid
+// Bucket `n` segments from `(src_x, src_y)` to `(dst_x, dst_y)` in world space
+// into a uniform grid of square cells `cell` wide, spanning their bounding box
+// -- each segment goes into every cell its own bounding box overlaps. The
+// segments are copied, so the arrays may go away afterwards.
+//
+sbgrid_t*
+SB_InitGrid
+( const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n,
+  float  cell )
+{
+    sbgrid_t* grid = (sbgrid_t*) malloc(sizeof(sbgrid_t));
+    float min_x = FLT_MAX, min_y = FLT_MAX, max_x = -FLT_MAX, max_y = -FLT_MAX;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        min_x = SB_MIN(min_x, SB_MIN(*(src_x + i), *(dst_x + i)));
+        min_y = SB_MIN(min_y, SB_MIN(*(src_y + i), *(dst_y + i)));
+        max_x = SB_MAX(max_x, SB_MAX(*(src_x + i), *(dst_x + i)));
+        max_y = SB_MAX(max_y, SB_MAX(*(src_y + i), *(dst_y + i)));
+    }
+
+    if (!n) min_x = min_y = max_x = max_y = 0;
+
+    grid->x = min_x;
+    grid->y = min_y;
+    grid->cell = cell;
+    grid->cols = (int) ((max_x - min_x) / cell) + 1;
+    grid->rows = (int) ((max_y - min_y) / cell) + 1;
+    grid->count = n;
+    grid->segs = (float*) malloc((n ? n : 1) * 4 * sizeof(float));
+    grid->cell_start = (int*) calloc(grid->cols * grid->rows + 1, sizeof(int));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        float* seg = grid->segs + (i << 2);
+
+        *seg = *(src_x + i); *(seg + 1) = *(src_y + i);
+        *(seg + 2) = *(dst_x + i); *(seg + 3) = *(dst_y + i);
+    }
+
+    /* count the segments in each cell first, then fill them in right behind
+     * the ones in the cells before it
+     */
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        int* fill = pass ? (int*) malloc(grid->cols * grid->rows * sizeof(int))
+                         : 0;
+
+        if (pass)
+        {
+            for (int i = 0; i < grid->cols * grid->rows; ++i)
+                *(grid->cell_start + i + 1) += *(grid->cell_start + i);
+
+            grid->cell_segs =
+                (int*) malloc((*(grid->cell_start + grid->cols * grid->rows) +
+                               1) * sizeof(int));
+            memcpy(fill, grid->cell_start,
+                   grid->cols * grid->rows * sizeof(int));
+        }
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float* seg = grid->segs + (i << 2);
+            const int col0 = (SB_MIN(*seg, *(seg + 2)) - min_x) / cell;
+            const int col1 = (SB_MAX(*seg, *(seg + 2)) - min_x) / cell;
+            const int row0 = (SB_MIN(*(seg + 1), *(seg + 3)) - min_y) / cell;
+            const int row1 = (SB_MAX(*(seg + 1), *(seg + 3)) - min_y) / cell;
+
+            for (int row = row0; row <= row1; ++row)
+            {
+                for (int col = col0; col <= col1; ++col)
+                {
+                    const int c = row * grid->cols + col;
+
+                    if (pass) *(grid->cell_segs + (*(fill + c))++) = i;
+                    else ++*(grid->cell_start + c + 1);
+                }
+            }
+        }
+
+        free(fill);
+    }
+
+    return grid;
+}
+
+//
+// SB_DestroyGrid
+//
+void SB_DestroyGrid (sbgrid_t* grid)
+{
+    free(grid->segs);
+    free(grid->cell_start);
+    free(grid->cell_segs);
+    free(grid);
+}
+
+//
+// SB_Empty
+// Free up every span in the buffer, holding on to the primitive table for
+// whatever is pushed next.
+//
+static void SB_Empty (sbuffer_t* sbuffer)
+{
+    const int n = SB_Flatten(sbuffer->root, 0, 0);
+    span_t* spans[n + 1];
+
+    SB_Flatten(sbuffer->root, spans, 0);
+    for (int j = 0; j < n; ++j) free(*(spans + j));
+
+    sbuffer->root = 0;
+    sbuffer->prims_count = 0;
+}
+
+//
+// SB_ClearPolar
+// Empty out each face of the polar buffer and move it over to `(x, y)`, holding
+// on to the primitive tables for the next viewer.
+//
+static void SB_ClearPolar (sbpolar_t* polar, float x, float y)
+{
+    for (int i = 0; i < 4; ++i) SB_Empty(*(polar->faces + i));
+
+    polar->x = x;
+    polar->y = y;
+}
+
+//
+// SB_PolarReach
+// How far off from the viewer anything still to be pushed onto the polar
+// buffer could possibly be seen -- as long as any one of the faces is left
+// uncovered, that is anywhere at all.
+//
+static float SB_PolarReach (const sbpolar_t* polar)
+{
+    float reach = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        const sbuffer_t* sbuffer = *(polar->faces + i);
+        const span_t* root = sbuffer->root;
+
+        if (!root || root->cover < sbuffer->size - SB_EPS) return FLT_MAX;
+
+        /* the farthest surface on the face is the farthest along its axis, and
+         * the corners of the face are `sqrt(2)` as far
+         */
+        reach = SB_MAX(reach, 1.4142136f / root->w_far);
+    }
+
+    return reach;
+}
+
+//
+// SB_PushRings
+// Box the viewer of `polar` in `range` away, and push the segments in `grid`
+// around it, one ring of cells at a time going outward from the cell it is in,
+// until nothing any farther could possibly be seen -- so that each viewer costs
+// about as much as the segments near enough to be seen from it, however many
+// of them there are in total. Segments whose `stamps` already read `stamp` are
+// taken to have been pushed -- without `stamps`, segments spanning several
+// cells are pushed once for each of them.
+//
+// Returns how many segments were pushed.
+//
+static
+size_t
+SB_PushRings
+( const sbgrid_t* grid,
+  sbpolar_t*      polar,
+  unsigned int*   stamps,
+  unsigned int    stamp,
+  float           range )
+{
+    const int cx = floorf((polar->x - grid->x) / grid->cell);
+    const int cy = floorf((polar->y - grid->y) / grid->cell);
+    size_t pushed = 0;
+
+    /* walls all the way across each face, `range` off along its axis -- told
+     * apart from the segments by their payload, which is the segment's index
+     */
+    for (int face = 0; face < 4; ++face)
+    {
+        sbuffer_t* sbuffer = *(polar->faces + face);
+        const float w = 1.0f / range;
+
+        SB_Push(sbuffer, 0, sbuffer->size, w, w, 0, -1);
+    }
+
+    /* the faces are all covered from here on, so the reach is bounded */
+    for (int ring = 0; ; ++ring)
+    {
+        /* every cell past this ring is at least `ring - 1` cells away */
+        if (ring > 1 && SB_PolarReach(polar) < (ring - 1) * grid->cell)
+            break;
+
+        /* ...and so is every cell left in the grid */
+        if (cx - ring < 0 && cy - ring < 0 &&
+            cx + ring >= grid->cols && cy + ring >= grid->rows)
+            break;
+
+        for (int row = cy - ring; row <= cy + ring; ++row)
+        {
+            if (row < 0 || row >= grid->rows) continue;
+
+            /* only the first and the last rows of the ring are full */
+            const int step = (row == cy - ring || row == cy + ring) ? 1
+                                                                    : 2 * ring;
+
+            for (int col = cx - ring; col <= cx + ring; col += step)
+            {
+                if (col < 0 || col >= grid->cols) continue;
+
+                const int c = row * grid->cols + col;
+
+                for (int k = *(grid->cell_start + c);
+                     k < *(grid->cell_start + c + 1);
+                     ++k)
+                {
+                    const int s = *(grid->cell_segs + k);
+                    const float* seg = grid->segs + (s << 2);
+
+                    /* segments spanning several cells are met more than once */
+                    if (stamps)
+                    {
+                        if (*(stamps + s) == stamp) continue;
+                        *(stamps + s) = stamp;
+                    }
+
+                    _SB_PushPolar(polar,
+                                  *seg, *(seg + 1),
+                                  *(seg + 2), *(seg + 3),
+                                  0,
+                                  0,
+                                  s);
+                    ++pushed;
+                }
+            }
+        }
+    }
+
+    return pushed;
+}
+
+// the lights one thread of `SB_LightMany` takes on, and what it keeps around
+// from one light to the next
+typedef struct {
+    const sbgrid_t* grid;
+    sblights_t*     lights;
+    sbpolar_t*      polar;
+    unsigned int*   stamps; // the last light each segment was pushed for
+    float           range;
+    size_t          first, stride;
+    size_t          pushed;
+} sbworker_t;
+
+//
+// SB_LightWorker
+// Run through every `stride`-th light starting from `first`, each one of them
+// on the very same polar buffer, and store their visibility polygons.
+//
+static void* SB_LightWorker (void* arg)
+{
+    sbworker_t* worker = (sbworker_t*) arg;
+    sblights_t* lights = worker->lights;
+
+    for (size_t i = worker->first; i < lights->count; i += worker->stride)
+    {
+        SB_ClearPolar(worker->polar, *(lights->x + i), *(lights->y + i));
+        worker->pushed += SB_PushRings(worker->grid,
+                                       worker->polar,
+                                       worker->stamps,
+                                       i + 1,
+                                       worker->range);
+
+        *(lights->counts + i) =
+            _SB_VisibilityPolygon(worker->polar,
+                                  worker->range,
+                                  lights->poly_x + i * lights->capacity,
+                                  lights->poly_y + i * lights->capacity,
+                                  lights->capacity);
+    }
+
+    return 0;
+}
+
+//
+// SB_LightMany
+// Compute the visibility polygons of many lights at once against the segments
+// in `grid` -- the light masks, each one boxed in by a square `range` away from
+// its light, the same as with `SB_VisibilityPolygon`, and cut off there.
+// Each of `threads` threads (or the calling thread alone, if zero or one) takes
+// on every so many lights on a polar buffer `resolution` pixels wide per face
+// of its own, emptied out and reused from one light to the next, pushing only
+// the segments in the cells around each light as far out as it could possibly
+// see -- see `SB_InitPolar` for `z_near` and `max_depth`.
+//
+// Returns how many segments were pushed in total over all the lights.
+//
+size_t
+SB_LightMany
+( const sbgrid_t* grid,
+  sblights_t*     lights,
+  float  range,
+  int    resolution,
+  float  z_near,
+  size_t max_depth,
+  int    threads )
+{
+    const int n = SB_MAX(threads, 1);
+    sbworker_t workers[n];
+    size_t pushed = 0;
+
+    /* a worker left without stamps, short on memory, still lights up its
+     * share -- only pushing segments spanning several cells more than once
+     */
+    for (int i = 0; i < n; ++i)
+    {
+        const sbworker_t worker = {
+            grid,
+            lights,
+            SB_InitPolar(0, 0, resolution, z_near, max_depth),
+            (unsigned int*) calloc(grid->count + 1, sizeof(unsigned int)),
+            range,
+            i, n,
+            0
+        };
+
+        *(workers + i) = worker;
+    }
+
+#ifdef SB_PTHREADS
+    pthread_t ids[n];
+    byte_t spawned[n];
+
+    for (int i = 1; i < n; ++i)
+        *(spawned + i) = !pthread_create(ids + i, 0, SB_LightWorker,
+                                         workers + i);
+
+    SB_LightWorker(workers);
+
+    /* the workers that could not get a thread of their own are run on the
+     * calling one instead, once it's done with its own share
+     */
+    for (int i = 1; i < n; ++i)
+    {
+        if (*(spawned + i)) pthread_join(*(ids + i), 0);
+        else SB_LightWorker(workers + i);
+    }
+#else
+    for (int i = 0; i < n; ++i) SB_LightWorker(workers + i);
+#endif // SB_PTHREADS
+
+    for (int i = 0; i < n; ++i)
+    {
+        pushed += (workers + i)->pushed;
+        SB_DestroyPolar((workers + i)->polar);
+        free((workers + i)->stamps);
+    }
+
+    return pushed;
+}
+
+// LINE OF SIGHT ///////////////////////////////////////////////////////////////
+//
+//
+// SB_InitSight
+// Initialize a line-of-sight engine for `count` agents against the segments in
+// `grid`, each agent seeing as far as `range` -- see `SB_InitPolar` for
+// `resolution`, `z_near` and `max_depth`. Each agent gets a polar buffer of its
+// own the first time it is asked about, kept around for as long as it stays
+// where it is.
+//
+sbsight_t*
+SB_InitSight
+( const sbgrid_t* grid,
+  int    count,
+  float  range,
+  int    resolution,
+  float  z_near,
+  size_t max_depth )
+{
+    sbsight_t* sight = (sbsight_t*) malloc(sizeof(sbsight_t));
+
+    sight->grid = grid;
+    sight->count = count;
+    sight->agents = (sbpolar_t**) calloc(count + 1, sizeof(sbpolar_t*));
+    sight->x = (float*) calloc(count + 1, sizeof(float));
+    sight->y = (float*) calloc(count + 1, sizeof(float));
+    sight->range = range;
+    sight->resolution = resolution;
+    sight->z_near = z_near;
+    sight->max_depth = max_depth;
+    sight->stamps = (unsigned int*) calloc(grid->count + 1,
+                                           sizeof(unsigned int));
+    sight->stamp = 0;
+    sight->isa = SB_DetectIsa();
+
+    return sight;
+}
+
+//
+// SB_PlaceAgents
+// Move each agent over to `(x, y)` in world space -- the buffers of the agents
+// that did move are rebuilt the next time they are asked about, and the rest
+// are left as they are.
+//
+void SB_PlaceAgents (sbsight_t* sight, const float* x, const float* y)
+{
+    memcpy(sight->x, x, sight->count * sizeof(float));
+    memcpy(sight->y, y, sight->count * sizeof(float));
+}
+
+//
+// SB_SightAgent
+// Make sure `agent` has a polar buffer built right where it is, building it
+// anew if it has none yet, or has moved since. Returns non-zero if it had to.
+//
+static int SB_SightAgent (sbsight_t* sight, int agent)
+{
+    sbpolar_t** polar = sight->agents + agent;
+    const float x = *(sight->x + agent), y = *(sight->y + agent);
+
+    if (*polar && (*polar)->x == x && (*polar)->y == y) return 0;
+
+    if (!*polar)
+        *polar = SB_InitPolar(x, y,
+                              sight->resolution,
+                              sight->z_near,
+                              sight->max_depth);
+    else
+        SB_ClearPolar(*polar, x, y);
+
+    SB_PushRings(sight->grid, *polar,
+                 sight->stamps, ++sight->stamp,
+                 sight->range);
+
+    return 1;
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_SightLanes
+// Which face of the polar buffers of `SB_LANES` agents at `(px, py)` each of
+// the targets at `(tx, ty)` falls on, where on the screen of that face it
+// lands, and how far along the axis of the face it is -- all lanes at once,
+// without any trigonometry.
+//
+SB_KERNEL
+void
+SB_SightLanes
+( const float* px, const float* py,
+  const float* tx, const float* ty,
+  float  half,
+  sb_vi* face,
+  sb_vf* x, sb_vf* z )
+{
+    // the axes of the faces are diagonal
+    const sb_vf axis = (sb_vf) { 0 } + 0.70710678f;
+    sb_vf dx, dy, ex, ey;
+    __builtin_memcpy(&dx, tx, sizeof(sb_vf));
+    __builtin_memcpy(&dy, ty, sizeof(sb_vf));
+    __builtin_memcpy(&ex, px, sizeof(sb_vf));
+    __builtin_memcpy(&ey, py, sizeof(sb_vf));
+
+    dx -= ex; dy -= ey;
+
+    /* the faces cover `[0, π/2)`, `[π/2, π)` and so on, and their forward
+     * axes point off into the quadrants those make up
+     */
+    const sb_vi upper = dy >= 0;
+    const sb_vi east = (upper & (dx > 0)) | (~upper & (dx >= 0));
+    const sb_vf fx = SB_SELECT(east, axis, -axis);
+    const sb_vf fy = SB_SELECT(upper, axis, -axis);
+    const sb_vf vx = fx * dy - fy * dx;
+
+    *face = (~upper & 2) | ((upper ^ east) & 1);
+    *z = fx * dx + fy * dy;
+    *x = half + half * vx / *z;
+}
+
+SB_KERNEL
+void
+_SB_SeeMany
+( const sbsight_t* sight,
+  const int*   agents,
+  const float* tx, const float* ty,
+  size_t  n,
+  byte_t* out )
+{
+    const float half = sight->resolution * 0.5f;
+
+    for (size_t i = 0; i < n; i += SB_LANES)
+    {
+        const size_t lanes = SB_MIN(n - i, SB_LANES);
+        float px[SB_LANES], py[SB_LANES], qx[SB_LANES], qy[SB_LANES];
+
+        /* gather the agents, padding the last few queries out to a full set
+         * of lanes
+         */
+        for (size_t k = 0; k < SB_LANES; ++k)
+        {
+            const int agent = *(agents + i + (k < lanes ? k : 0));
+
+            *(px + k) = *(sight->x + agent);
+            *(py + k) = *(sight->y + agent);
+            *(qx + k) = *(tx + i + (k < lanes ? k : 0));
+            *(qy + k) = *(ty + i + (k < lanes ? k : 0));
+        }
+
+        sb_vi face;
+        sb_vf x, z;
+        SB_SightLanes(px, py, qx, qy, half, &face, &x, &z);
+
+        for (size_t k = 0; k < lanes; ++k)
+        {
+            const sbpolar_t* polar = *(sight->agents + *(agents + i + k));
+            const sbuffer_t* sbuffer = *(polar->faces + face[k]);
+
+            /* right on top of the agent, there's nothing in between */
+            if (z[k] < sight->z_near)
+            {
+                *(out + i + k) = 0xff;
+                continue;
+            }
+
+            const float probe = SB_MIN(SB_MAX(x[k], 0), sbuffer->size - SB_EPS);
+            const span_t* span = sbuffer->root;
+
+            while (span && (probe < span->x0 || probe >= span->x1))
+                span = probe < span->x0 ? span->prev : span->next;
+
+            *(out + i + k) =
+                !span ||
+                z[k] * SB_PRIM_W(SB_PRIM(sbuffer, span), probe) <= 1 + SB_EPS
+                ? 0xff : 0;
+        }
+    }
+}
+
+SB_VARIANTS(
+void, SB_SeeMany,
+( const sbsight_t* sight,
+  const int*   agents,
+  const float* tx, const float* ty,
+  size_t  n,
+  byte_t* out ),
+(sight, agents, tx, ty, n, out))
+
+#ifndef S_BUFFER_WIDE
+
+//
+// SB_SeeMany
+// Whether each agent `*(agents + i)` can see the point `(tx, ty)` in world
+// space -- stored in `out` as `0xff` if it can, and zero if a segment is in the
+// way, or it is out of range. `SB_LANES` queries are projected at a time, and
+// looked up in the buffers of their agents one after another.
+//
+// Returns how many of the agents had their buffers built anew.
+//
+size_t
+SB_SeeMany
+( sbsight_t*   sight,
+  const int*   agents,
+  const float* tx, const float* ty,
+  size_t  n,
+  byte_t* out )
+{
+    size_t built = 0;
+
+    for (size_t i = 0; i < n; ++i) built += SB_SightAgent(sight, *(agents + i));
+
+    SB_DISPATCH(sight->isa, SB_SeeMany, sight, agents, tx, ty, n, out);
+
+    return built;
+}
+
+//
+// SB_SeesSpans
+// Whether more than `SB_SLIVER` of the line through `(x0, w0)` with slope `dw`
+// in perspective-correct screen space is level with or in front of one of the
+// spans under `span` in between `lo` and `hi` -- summing up how much of it the
+// spans hide in `hidden`.
+//
+static
+byte_t
+SB_SeesSpans
+( const sbuffer_t* sbuffer,
+  const span_t*    span,
+  float  x0, float w0,
+  float  dw,
+  float  lo, float hi,
+  float* hidden )
+{
+    if (!span) return 0;
+
+    const float left = SB_MAX(span->x0, lo), right = SB_MIN(span->x1, hi);
+
+    if (right > left)
+    {
+        const sbprim_t* prim = SB_PRIM(sbuffer, span);
+
+        /* how far in front of the span the line is is affine in between, so
+         * it crosses over at most once -- the segments that were pushed are
+         * level with themselves, hence the slack
+         */
+        const float dl = (w0 + (left - x0) * dw) * (1 + SB_EPS) -
+                         SB_PRIM_W(prim, left);
+        const float dr = (w0 + (right - x0) * dw) * (1 + SB_EPS) -
+                         SB_PRIM_W(prim, right);
+        const float seen = dl >= 0 && dr >= 0 ? right - left
+                         : dl < 0 && dr < 0 ? 0
+                         : (right - left) * SB_MAX(dl, dr) /
+                           (fabsf(dl) + fabsf(dr));
+
+        if (seen > SB_SLIVER) return 0xff;
+
+        *hidden += right - left - seen;
+    }
+
+    return (lo < span->x0 &&
+            SB_SeesSpans(sbuffer, span->prev, x0, w0, dw, lo, hi, hidden)) ||
+           (hi > span->x1 &&
+            SB_SeesSpans(sbuffer, span->next, x0, w0, dw, lo, hi, hidden));
+}
+
+//
+// SB_SeeSegments
+// Whether each agent `*(agents + i)` can see any part of the segment from
+// `(src_x, src_y)` to `(dst_x, dst_y)` in world space -- stored in `out` the
+// same way `SB_SeeMany` does. Takes time O(log n + k) in the spans of each
+// face, k being the spans the segment overlaps.
+//
+// Returns how many of the agents had their buffers built anew.
+//
+size_t
+SB_SeeSegments
+( sbsight_t*   sight,
+  const int*   agents,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t  n,
+  byte_t* out )
+{
+    size_t built = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const int agent = *(agents + i);
+        byte_t seen = 0;
+
+        built += SB_SightAgent(sight, agent);
+
+        const sbpolar_t* polar = *(sight->agents + agent);
+
+        for (int face = 0; face < 4 && !seen; ++face)
+        {
+            const sbuffer_t* sbuffer = *(polar->faces + face);
+            float x0, x1, w0, w1, hidden = 0;
+            span2_t a, b;
+
+            if (SB_PolarProject(polar, face,
+                                *(src_x + i), *(src_y + i),
+                                *(dst_x + i), *(dst_y + i),
+                                &x0, &x1, &w0, &w1,
+                                &a, &b))
+                continue;
+
+            const float lo = SB_MAX(x0, 0), hi = SB_MIN(x1, sbuffer->size);
+
+            if (!(hi > lo)) continue;
+
+            seen = SB_SeesSpans(sbuffer, sbuffer->root,
+                                x0, w0, (w1 - w0) / (x1 - x0),
+                                lo, hi,
+                                &hidden) ||
+                   hidden < hi - lo - SB_SLIVER;
+        }
+
+        *(out + i) = seen ? 0xff : 0;
+    }
+
+    return built;
+}
+
+//
+// SB_MarkSpans
+// Set the bit of the segment each of the spans under `span` was cut from in
+// `bits`, leaving out slivers and the walls boxing the buffer in. Returns how
+// many bits were not already set.
+//
+static size_t SB_MarkSpans (const sbuffer_t* sbuffer, const span_t* span,
+                            byte_t* bits)
+{
+    if (!span) return 0;
+
+    const int s = SB_PRIM(sbuffer, span)->payload;
+    size_t marked = 0;
+
+    if (s >= 0 && span->x1 - span->x0 > SB_SLIVER &&
+        !(*(bits + (s >> 3)) & (1 << (s & 7))))
+    {
+        *(bits + (s >> 3)) |= 1 << (s & 7);
+        marked = 1;
+    }
+
+    return marked +
+           SB_MarkSpans(sbuffer, span->prev, bits) +
+           SB_MarkSpans(sbuffer, span->next, bits);
+}
+
+//
+// SB_SeenBy
+// Set the bit of each segment in the grid that `agent` can see any of in
+// `bits` -- one bit per segment, the lowest bit of the first byte standing for
+// the first one -- leaving the rest of them as they are, so that several agents
+// can be gathered into the same set. Takes time proportional to the spans in
+// the buffer of the agent, building it first if need be.
+//
+// Returns how many bits were not already set.
+//
+size_t SB_SeenBy (sbsight_t* sight, int agent, byte_t* bits)
+{
+    size_t marked = 0;
+
+    SB_SightAgent(sight, agent);
+
+    const sbpolar_t* polar = *(sight->agents + agent);
+
+    for (int face = 0; face < 4; ++face)
+    {
+        const sbuffer_t* sbuffer = *(polar->faces + face);
+
+        marked += SB_MarkSpans(sbuffer, sbuffer->root, bits);
+    }
+
+    return marked;
+}
+
+//
+// SB_DestroySight
+// Free up all memory allocated by the engine, along with the buffer of each
+// agent -- the grid is left be.
+//
+void SB_DestroySight (sbsight_t* sight)
+{
+    for (int i = 0; i < sight->count; ++i)
+        if (*(sight->agents + i)) SB_DestroyPolar(*(sight->agents + i));
+
+    free(sight->agents);
+    free(sight->x);
+    free(sight->y);
+    free(sight->stamps);
+    free(sight);
+}
+
+// MULTI-CAMERA BUFFERS ////////////////////////////////////////////////////////
+//
+
+// a segment along with how far it is from the cameras, for sorting them from
+// near to far -- see `SB_CompareIntervals`
+typedef struct {
+    float key;
+    int   index;
+} sbkey_t;
+
+//
+// SB_NearestSq
+// The squared distance from `(x, y)` to the nearest point on the segment from
+// `(src_x, src_y)` to `(dst_x, dst_y)`.
+//
+static
+float
+SB_NearestSq
+( float x,     float y,
+  float src_x, float src_y,
+  float dst_x, float dst_y )
+{
+    const float ex = dst_x - src_x, ey = dst_y - src_y;
+    const float dx = x - src_x, dy = y - src_y;
+    const float length = ex * ex + ey * ey;
+    const float t = length > 0
+        ? SB_MIN(SB_MAX((dx * ex + dy * ey) / length, 0), 1)
+        : 0;
+
+    return (dx - t * ex) * (dx - t * ex) + (dy - t * ey) * (dy - t * ey);
+}
+
+//
+// SB_InitCameras
+// Initialize a buffer for each of `count` cameras, all of them `size` pixels
+// wide -- see `SB_Init` for `z_near` and `max_depth` -- along with room for
+// `capacity` projected segments per camera.
+//
+sbcameras_t*
+SB_InitCameras
+( int    count,
+  int    size,
+  float  z_near,
+  size_t max_depth,
+  size_t capacity )
+{
+    sbcameras_t* cameras = (sbcameras_t*) malloc(sizeof(sbcameras_t));
+
+    cameras->count = count;
+    cameras->buffers = (sbuffer_t**) malloc((count + 1) * sizeof(sbuffer_t*));
+    cameras->projections =
+        (sbprojection_t**) malloc((count + 1) * sizeof(sbprojection_t*));
+    cameras->isa = SB_DetectIsa();
+
+    for (int i = 0; i < count; ++i)
+    {
+        *(cameras->buffers + i) = SB_Init(size, z_near, max_depth);
+        *(cameras->projections + i) = SB_InitProjection(capacity);
+    }
+
+    return cameras;
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_ProjectCameras
+// Transform each of the `n` world space segments from `(src_x, src_y)` to
+// `(dst_x, dst_y)` by every camera in `poses`, clip it against the
+// near-clipping plane, and project it onto the buffer of each camera the same
+// way `SB_ProjectMany` does -- `SB_LANES` cameras at a time, each segment
+// loaded once for all of them. The survivors are stored in the projection of
+// each camera, ready to be pushed by `SB_PushCameras`.
+//
+// The segments are sorted once for all the cameras, from the nearest to the
+// farthest off from the middle of them, and projected in that order -- so that
+// cameras close together push theirs roughly front to back.
+//
+SB_KERNEL
+void
+_SB_ProjectCameras
+( sbcameras_t*      cameras,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  const sbkey_t* order,
+  size_t n )
+{
+    const sb_vf zero = { 0 };
+
+    for (int c = 0; c < cameras->count; c += SB_LANES)
+    {
+        const int lanes = SB_MIN(cameras->count - c, SB_LANES);
+        const sbuffer_t* sbuffer = *(cameras->buffers + c);
+        sbprojection_t* out[SB_LANES];
+        sb_vf eye_x, eye_y, cos_angle, sin_angle;
+
+        /* pad the last few cameras out to a full set of lanes */
+        for (int k = 0; k < SB_LANES; ++k)
+        {
+            const sbcamera_t* pose = poses + c + (k < lanes ? k : 0);
+
+            eye_x[k] = pose->x;
+            eye_y[k] = pose->y;
+            cos_angle[k] = cosf(pose->angle);
+            sin_angle[k] = sinf(pose->angle);
+            *(out + k) = *(cameras->projections + c + (k < lanes ? k : 0));
+            (*(out + k))->count = 0;
+        }
+
+        for (size_t o = 0; o < n; ++o)
+        {
+            const int i = (order + o)->index;
+            const sb_vf sx = zero + *(src_x + i), sy = zero + *(src_y + i);
+            const sb_vf dx = zero + *(dst_x + i), dy = zero + *(dst_y + i);
+            sb_vf x0, x1, w0, w1, vx0, vz0, vx1, vz1;
+            sb_vi visible;
+
+            SB_ProjectVectors(&sx, &sy, &dx, &dy,
+                              &eye_x, &eye_y,
+                              &cos_angle, &sin_angle,
+                              sbuffer->size,
+                              sbuffer->z_near,
+                              &visible,
+                              &x0, &x1, &w0, &w1,
+                              &vx0, &vz0, &vx1, &vz1);
+
+            for (int k = 0; k < lanes; ++k)
+            {
+                if (!visible[k]) continue;
+
+                sbprojection_t* projection = *(out + k);
+                const size_t j = projection->count++;
+
+                *(projection->x0 + j) = x0[k];
+                *(projection->x1 + j) = x1[k];
+                *(projection->w0 + j) = w0[k];
+                *(projection->w1 + j) = w1[k];
+                *(projection->vx0 + j) = vx0[k];
+                *(projection->vz0 + j) = vz0[k];
+                *(projection->vx1 + j) = vx1[k];
+                *(projection->vz1 + j) = vz1[k];
+                *(projection->index + j) = i;
+            }
+        }
+    }
+}
+
+SB_VARIANTS(
+void, SB_ProjectCameras,
+( sbcameras_t*      cameras,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  const sbkey_t* order,
+  size_t n ),
+(cameras, poses, src_x, src_y, dst_x, dst_y, order, n))
+
+#ifndef S_BUFFER_WIDE
+
+void
+SB_ProjectCameras
+( sbcameras_t*      cameras,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n )
+{
+    SB_ASSERT(!cameras->count || n <= (*cameras->projections)->capacity,
+              "[SB_ProjectCameras] Not enough room for the projected "
+              "segments!\n");
+
+    sbkey_t* order = (sbkey_t*) malloc((n + 1) * sizeof(sbkey_t));
+    float x = 0, y = 0;
+
+    for (int c = 0; c < cameras->count; ++c)
+    {
+        x += (poses + c)->x / cameras->count;
+        y += (poses + c)->y / cameras->count;
+    }
+
+    /* how far the nearest point on each segment is from the middle */
+    for (size_t i = 0; i < n; ++i)
+    {
+        (order + i)->key = SB_NearestSq(x, y,
+                                        *(src_x + i), *(src_y + i),
+                                        *(dst_x + i), *(dst_y + i));
+        (order + i)->index = i;
+    }
+
+    qsort(order, n, sizeof(sbkey_t), SB_CompareIntervals);
+
+    SB_DISPATCH(cameras->isa, SB_ProjectCameras,
+                cameras, poses, src_x, src_y, dst_x, dst_y, order, n);
+
+    free(order);
+}
+
+//
+// SB_PushCameras
+// Empty out the buffer of each camera, and push what `SB_ProjectCameras` left
+// for it onto it the same way `SB_PushMany` does, in the order it was left in.
+// `ids` and `colors` are indexed the way the segments were.
+//
+// Returns how many segments were pushed in total over all the cameras.
+//
+size_t
+SB_PushCameras
+( sbcameras_t*  cameras,
+  const byte_t* ids,
+  const int*    colors )
+{
+    size_t pushed = 0;
+
+    for (int c = 0; c < cameras->count; ++c)
+    {
+        sbuffer_t* sbuffer = *(cameras->buffers + c);
+        const sbprojection_t* projection = *(cameras->projections + c);
+
+        SB_Empty(sbuffer);
+
+        for (size_t i = 0; i < projection->count; ++i)
+        {
+            const span_t* root = sbuffer->root;
+            const size_t index = *(projection->index + i);
+
+            /* nothing on a fully covered screen is farther than the segment
+             * anywhere -- the nearer segments having gone first, more and
+             * more of the farther ones are culled this way
+             */
+            if (root && root->cover >= sbuffer->size - SB_EPS &&
+                root->w_far > SB_MAX(*(projection->w0 + i),
+                                     *(projection->w1 + i)))
+                continue;
+
+            const span2_t a = {
+                *(projection->vx0 + i), *(projection->vz0 + i)
+            };
+            const span2_t b = {
+                *(projection->vx1 + i), *(projection->vz1 + i)
+            };
+
+            pushed += !_SB_Push(sbuffer,
+                                *(projection->x0 + i), *(projection->x1 + i),
+                                *(projection->w0 + i), *(projection->w1 + i),
+                                a, b,
+                                0,
+                                *(ids + index),
+                                *(colors + index),
+                                (int) index);
+        }
+    }
+
+    return pushed;
+}
+
+//
+// SB_CameraSeen
+// Set the bit of each segment that `camera` sees any of in `bits`, the same way
+// `SB_SeenBy` does. Returns how many bits were not already set.
+//
+size_t SB_CameraSeen (const sbcameras_t* cameras, int camera, byte_t* bits)
+{
+    const sbuffer_t* sbuffer = *(cameras->buffers + camera);
+
+    return SB_MarkSpans(sbuffer, sbuffer->root, bits);
+}
+
+//
+// SB_DestroyCameras
+// Free up all memory allocated by the buffers, and their projections.
+//
+void SB_DestroyCameras (sbcameras_t* cameras)
+{
+    for (int i = 0; i < cameras->count; ++i)
+    {
+        SB_Destroy(*(cameras->buffers + i));
+        SB_DestroyProjection(*(cameras->projections + i));
+    }
+
+    free(cameras->buffers);
+    free(cameras->projections);
+    free(cameras);
+}
+
+// MULTI-VIEW BUFFERS //////////////////////////////////////////////////////////
+//
+
+//
+// SB_InitViews
+// Initialize a buffer for each of `views` views, all of them `size` pixels
+// wide -- see `SB_Init` for `z_near` and `max_depth` -- along with room for
+// `capacity` segments.
+//
+sbviews_t*
+SB_InitViews
+( int    views,
+  int    size,
+  float  z_near,
+  size_t max_depth,
+  size_t capacity )
+{
+    SB_ASSERT(views > 0 && views <= SB_MAX_VIEWS,
+              "[SB_InitViews] Too many views!\n");
+
+    sbviews_t* out = (sbviews_t*) malloc(sizeof(sbviews_t));
+
+    out->views = views;
+    out->count = 0;
+    out->capacity = capacity;
+    out->masks = (byte_t*) malloc(capacity + 1);
+    out->src_x = (float*) malloc((4 * capacity + 1) * sizeof(float));
+    out->src_y = out->src_x + capacity;
+    out->dst_x = out->src_y + capacity;
+    out->dst_y = out->dst_x + capacity;
+    out->isa = SB_DetectIsa();
+
+    for (int i = 0; i < views; ++i)
+    {
+        *(out->buffers + i) = SB_Init(size, z_near, max_depth);
+        *(out->projections + i) = SB_InitProjection(capacity);
+    }
+
+    return out;
+}
+
+#endif // S_BUFFER_WIDE
+
+//
+// SB_ProjectViews
+// Project the segments `SB_ProjectViews` took into the frame of the rig onto
+// the buffer of each view, `SB_LANES` segments at a time, the same way
+// `SB_ProjectMany` does. Every view keeps each segment at the same place in its
+// projection, and the views it survived in are marked in `masks`.
+//
+SB_KERNEL
+void
+_SB_ProjectViews
+( sbviews_t*        views,
+  const sbcamera_t* poses,
+  const sbkey_t*    order )
+{
+    const sbuffer_t* sbuffer = *views->buffers;
+    const sb_vf zero = { 0 };
+    const size_t n = views->count;
+
+    for (size_t i = 0; i < n; i += SB_LANES)
+    {
+        const size_t lanes = SB_MIN(n - i, SB_LANES);
+        float tail[4][SB_LANES];
+        const float* in[4] = {
+            views->src_x + i, views->src_y + i,
+            views->dst_x + i, views->dst_y + i
+        };
+
+        /* pad the last few segments out to a full set of lanes */
+        if (lanes < SB_LANES)
+        {
+            for (size_t j = 0; j < 4; ++j)
+            {
+                for (size_t k = 0; k < SB_LANES; ++k)
+                    *(*(tail + j) + k) = k < lanes ? *(*(in + j) + k) : 0;
+
+                *(in + j) = *(tail + j);
+            }
+        }
+
+        sb_vf sx, sy, dx, dy;
+        __builtin_memcpy(&sx, *in, sizeof(sb_vf));
+        __builtin_memcpy(&sy, *(in + 1), sizeof(sb_vf));
+        __builtin_memcpy(&dx, *(in + 2), sizeof(sb_vf));
+        __builtin_memcpy(&dy, *(in + 3), sizeof(sb_vf));
+
+        memset(views->masks + i, 0, lanes);
+
+        for (int v = 0; v < views->views; ++v)
+        {
+            const sbcamera_t* pose = poses + v;
+            const sb_vf ex = zero + pose->x, ey = zero + pose->y;
+            const sb_vf cos_v = zero + cosf(pose->angle);
+            const sb_vf sin_v = zero + sinf(pose->angle);
+            sbprojection_t* projection = *(views->projections + v);
+            sb_vf x0, x1, w0, w1, vx0, vz0, vx1, vz1;
+            sb_vi visible;
+
+            SB_ProjectVectors(&sx, &sy, &dx, &dy,
+                              &ex, &ey,
+                              &cos_v, &sin_v,
+                              sbuffer->size,
+                              sbuffer->z_near,
+                              &visible,
+                              &x0, &x1, &w0, &w1,
+                              &vx0, &vz0, &vx1, &vz1);
+
+            for (size_t k = 0; k < lanes; ++k)
+            {
+                const size_t j = i + k;
+
+                *(views->masks + j) |= !!visible[k] << v;
+                *(projection->x0 + j) = x0[k];
+                *(projection->x1 + j) = x1[k];
+                *(projection->w0 + j) = w0[k];
+                *(projection->w1 + j) = w1[k];
+                *(projection->vx0 + j) = vx0[k];
+                *(projection->vz0 + j) = vz0[k];
+                *(projection->vx1 + j) = vx1[k];
+                *(projection->vz1 + j) = vz1[k];
+                *(projection->index + j) = (order + j)->index;
+            }
+        }
+    }
+
+    for (int v = 0; v < views->views; ++v)
+        (*(views->projections + v))->count = n;
+}
+
+SB_VARIANTS(
+void, SB_ProjectViews,
+( sbviews_t*        views,
+  const sbcamera_t* poses,
+  const sbkey_t*    order ),
+(views, poses, order))
+
+#ifndef S_BUFFER_WIDE
+
+//
+// SB_ProjectViews
+// Transform each of the `n` world space segments from `(src_x, src_y)` to
+// `(dst_x, dst_y)` into the frame of the `rig` once, and project it onto the
+// buffer of each view from there, the same way `SB_ProjectMany` does -- ready
+// to be pushed by `SB_PushViews`.
+//
+// The pose of each view is given in `poses` relative to the rig, the way that
+// of a camera is given in world space: the rig sits at the origin looking
+// toward -y, so the eyes of a stereo rig are `{ -ipd / 2, 0, 0 }` and
+// `{ ipd / 2, 0, 0 }`.
+//
+// Whether a segment is in view at all is decided once for all the views, so the
+// closer together they are the more is culled: a segment is rejected outright
+// when it is outside the wedge that all the frusta fit in -- one as much wider
+// than each of them as the views are turned, its apex pulled back far enough
+// for the views to be anywhere within as far from the rig as the farthest is.
+// The segments left are sorted once from the nearest to the farthest off from
+// the rig, and projected in that order.
+//
+// Returns how many segments were left.
+//
+size_t
+SB_ProjectViews
+( sbviews_t*        views,
+  const sbcamera_t* rig,
+  const sbcamera_t* poses,
+  const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n )
+{
+    SB_ASSERT(n <= views->capacity,
+              "[SB_ProjectViews] Not enough room for the segments!\n");
+
+    const sbuffer_t* sbuffer = *views->buffers;
+    const float cos_angle = cosf(rig->angle), sin_angle = sinf(rig->angle);
+    float reach = 0, turn = 0;
+
+    for (int v = 0; v < views->views; ++v)
+    {
+        const sbcamera_t* pose = poses + v;
+
+        reach = SB_MAX(reach, sqrtf(pose->x * pose->x + pose->y * pose->y));
+        turn = SB_MAX(turn, fabsf(pose->angle));
+    }
+
+    /* the half-angle of the wedge, and how far back its apex is -- a wedge
+     * wider than a half-plane culls nothing
+     */
+    const float half = atanf(sbuffer->size * 0.5f / sbuffer->z_near) + turn;
+    const int cull = half < SB_PI * 0.5f - SB_EPS;
+    const float cos_half = cosf(half), sin_half = sinf(half);
+    const float apex = cull ? reach / sin_half : 0;
+    sbkey_t* order = (sbkey_t*) malloc((n + 1) * sizeof(sbkey_t));
+    int* origin = (int*) malloc((n + 1) * sizeof(int));
+    size_t count = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        /* into the frame of the rig, which is its view space with y flipped */
+        const float sx = *(src_x + i) - rig->x, sy = *(src_y + i) - rig->y;
+        const float dx = *(dst_x + i) - rig->x, dy = *(dst_y + i) - rig->y;
+        const float src_fx = sx * cos_angle + sy * sin_angle;
+        const float src_fy = sy * cos_angle - sx * sin_angle;
+        const float dst_fx = dx * cos_angle + dy * sin_angle;
+        const float dst_fy = dy * cos_angle - dx * sin_angle;
+
+        if (cull)
+        {
+            /* how far out of either side of the wedge each endpoint is */
+            const float src_ahead = (apex - src_fy) * sin_half;
+            const float dst_ahead = (apex - dst_fy) * sin_half;
+            const float src_right = src_fx * cos_half - src_ahead;
+            const float dst_right = dst_fx * cos_half - dst_ahead;
+            const float src_left = -src_fx * cos_half - src_ahead;
+            const float dst_left = -dst_fx * cos_half - dst_ahead;
+
+            if ((src_right > 0 && dst_right > 0) ||
+                (src_left > 0 && dst_left > 0))
+                continue;
+        }
+
+        *(views->src_x + count) = src_fx; *(views->src_y + count) = src_fy;
+        *(views->dst_x + count) = dst_fx; *(views->dst_y + count) = dst_fy;
+        (order + count)->key = SB_NearestSq(0, 0, src_fx, src_fy,
+                                            dst_fx, dst_fy);
+        (order + count)->index = count;
+        *(origin + count++) = i;
+    }
+
+    qsort(order, count, sizeof(sbkey_t), SB_CompareIntervals);
+
+    /* lay the segments out from near to far, each with the index it had in
+     * the input
+     */
+    float* sorted = (float*) malloc((4 * count + 1) * sizeof(float));
+
+    for (size_t j = 0; j < count; ++j)
+    {
+        const int k = (order + j)->index;
+
+        *(sorted + j) = *(views->src_x + k);
+        *(sorted + count + j) = *(views->src_y + k);
+        *(sorted + 2 * count + j) = *(views->dst_x + k);
+        *(sorted + 3 * count + j) = *(views->dst_y + k);
+        (order + j)->index = *(origin + k);
+    }
+
+    memcpy(views->src_x, sorted, count * sizeof(float));
+    memcpy(views->src_y, sorted + count, count * sizeof(float));
+    memcpy(views->dst_x, sorted + 2 * count, count * sizeof(float));
+    memcpy(views->dst_y, sorted + 3 * count, count * sizeof(float));
+    free(sorted);
+    free(origin);
+
+    views->count = count;
+    SB_DISPATCH(views->isa, SB_ProjectViews, views, poses, order);
+
+    free(order);
+
+    return count;
+}
+
+//
+// SB_PushViews
+// Empty out the buffer of each view, and push what `SB_ProjectViews` left for
+// it onto it the same way `SB_PushMany` does -- a segment onto all the views it
+// is in before going on to the next, from the nearest to the farthest. `ids`
+// and `colors` are indexed the way the segments were.
+//
+// Returns how many segments were pushed in total over all the views.
+//
+size_t
+SB_PushViews
+( sbviews_t*    views,
+  const byte_t* ids,
+  const int*    colors )
+{
+    size_t pushed = 0;
+
+    for (int v = 0; v < views->views; ++v) SB_Empty(*(views->buffers + v));
+
+    for (size_t i = 0; i < views->count; ++i)
+    {
+        const int mask = *(views->masks + i);
+
+        for (int v = 0; v < views->views; ++v)
+        {
+            if (!(mask >> v & 1)) continue;
+
+            sbuffer_t* sbuffer = *(views->buffers + v);
+            const sbprojection_t* projection = *(views->projections + v);
+            const span_t* root = sbuffer->root;
+            const size_t index = *(projection->index + i);
+
+            /* see `SB_PushCameras` */
+            if (root && root->cover >= sbuffer->size - SB_EPS &&
+                root->w_far > SB_MAX(*(projection->w0 + i),
+                                     *(projection->w1 + i)))
+                continue;
+
+            const span2_t a = {
+                *(projection->vx0 + i), *(projection->vz0 + i)
+            };
+            const span2_t b = {
+                *(projection->vx1 + i), *(projection->vz1 + i)
+            };
+
+            pushed += !_SB_Push(sbuffer,
+                                *(projection->x0 + i), *(projection->x1 + i),
+                                *(projection->w0 + i), *(projection->w1 + i),
+                                a, b,
+                                0,
+                                *(ids + index),
+                                *(colors + index),
+                                (int) index);
+        }
+    }
+
+    return pushed;
+}
+
+//
+// SB_DestroyViews
+// Free up all memory allocated by the buffers, and their projections.
+//
+void SB_DestroyViews (sbviews_t* views)
+{
+    for (int i = 0; i < views->views; ++i)
+    {
+        SB_Destroy(*(views->buffers + i));
+        SB_DestroyProjection(*(views->projections + i));
+    }
+
+    free(views->masks);
+    free(views->src_x);
+    free(views);
+}
+
+// CYLINDRICAL BUFFERS /////////////////////////////////////////////////////////
+//
+
+//
+// SB_InitCylindrical
+// Initialize a buffer `size` pixels wide that the view is projected onto the
+// way it is onto a cylinder around the eye: screen space `x` goes with the
+// angle off of the heading, `z_near` pixels to the radian, and `w` with the
+// reciprocal of the distance to the eye -- neither of which change as the
+// camera turns in place, only shifting the screen over. See `SB_Init` for
+// `max_depth`; as nothing is clipped against a near plane, `z_near` only sets
+// the scale.
+//
+// The buffer needs to span less than half a turn.
+//
+sbuffer_t* SB_InitCylindrical (int size, float z_near, size_t max_depth)
+{
+    SB_ASSERT(size < SB_PI * z_near,
+              "[SB_InitCylindrical] The buffer spans half a turn or more!\n");
+
+    sbuffer_t* sbuffer = SB_Init(size, z_near, max_depth);
+
+    sbuffer->turn = 1 / z_near;
+
+    return sbuffer;
+}
+
+//
+// SB_CylindricalW
+// The reciprocal depth along `prim` at screen space `x` in the cylindrical
+// buffer it was pushed onto -- along a segment, the reciprocal of the distance
+// to the eye goes as `w0 * cos(t) + dw * sin(t)` in the angle `t` off of `x0`,
+// rather than linearly as `SB_PRIM_W` has it.
+//
+float
+SB_CylindricalW
+( const sbuffer_t* sbuffer,
+  const sbprim_t*  prim,
+  float x )
+{
+    const float t = (x - prim->x0) * sbuffer->turn;
+
+    return prim->w0 * cosf(t) + prim->dw * sinf(t);
+}
+
+//
+// SB_ClipEdge
+// Clip the segment from `a` to `b` against the half-plane where
+// `nx * x + nz * z <= 0` in view space. A non-zero return value indicates that
+// none of it is left.
+//
+static byte_t SB_ClipEdge (span2_t* a, span2_t* b, float nx, float nz)
+{
+    const float g_a = nx * a->x + nz * a->z, g_b = nx * b->x + nz * b->z;
+
+    if (g_a > 0 && g_b > 0) return 1;
+
+    const span2_t u = { b->x - a->x, b->z - a->z };
+
+    if (g_a > 0)
+    {
+        const float t = g_a / (g_a - g_b);
+        a->x += u.x * t; a->z += u.z * t;
+    }
+    else if (g_b > 0)
+    {
+        const float t = g_b / (g_b - g_a);
+        b->x -= u.x * t; b->z -= u.z * t;
+    }
+
+    return 0;
+}
+
+//
+// SB_PushCylindrical
+// Push the segment from `(x0, z0)` to `(x1, z1)` in view space -- the view
+// space of the heading the camera has now -- onto a cylindrical buffer, after
+// having clipped it to the wedge the screen spans. See `SB_Push` for what is
+// returned.
+//
+int
+SB_PushCylindrical
+( sbuffer_t* sbuffer,
+  float  x0, float z0,
+  float  x1, float z1,
+  byte_t id,
+  int    color )
+{
+    const float half = sbuffer->size * 0.5f * sbuffer->turn;
+    const float cos_half = cosf(half), sin_half = sinf(half);
+    span2_t a = { x0, z0 }, b = { x1, z1 };
+
+    if (SB_ClipEdge(&a, &b, cos_half, -sin_half) ||
+        SB_ClipEdge(&a, &b, -cos_half, -sin_half))
+        return 1;
+
+    const float r0 = sqrtf(a.x * a.x + a.z * a.z);
+    const float r1 = sqrtf(b.x * b.x + b.z * b.z);
+
+    /* right through the eye */
+    if (!(r0 > 0 && r1 > 0)) return 1;
+
+    const float middle = sbuffer->offset + sbuffer->size * 0.5f;
+    const float a_x = middle + atan2f(a.x, a.z) / sbuffer->turn;
+    const float b_x = middle + atan2f(b.x, b.z) / sbuffer->turn;
+    const byte_t a_min = a_x <= b_x;
+
+    /* the intersection tests run in the view space of the heading the buffer
+     * started out with
+     */
+    const float angle = sbuffer->offset * sbuffer->turn;
+    const float c = cosf(angle), s = sinf(angle);
+    const span2_t ra = { a.x * c + a.z * s, a.z * c - a.x * s };
+    const span2_t rb = { b.x * c + b.z * s, b.z * c - b.x * s };
+
+    /* sort the endpoints in ascending screen space x */
+    return _SB_Push(sbuffer,
+                    a_min ? a_x : b_x, a_min ? b_x : a_x,
+                    a_min ? 1 / r0 : 1 / r1, a_min ? 1 / r1 : 1 / r0,
+                    a_min ? ra : rb, a_min ? rb : ra,
+                    0,
+                    id,
+                    color,
+                    -1);
+}
+
+//
+// SB_Turn
+// Turn the camera of a cylindrical buffer in place by `angle` -- the way a
+// larger `angle` turns an `sbcamera_t` -- by shifting the screen over the spans
+// already in the buffer, in time O(1).
+//
+// The spans turned off of the screen are held on to for when the camera turns
+// back. Should the screen be turned onto a stretch that has never been pushed
+// onto, that stretch is stored in `[x0, x1)` in screen space, and a non-zero
+// value is returned: push everything again clipped to it -- see
+// `SB_PushClipWindow` -- and only the spans it exposes are inserted. Once the
+// buffer would hold on to more than a full turn, or the camera turns past the
+// stretch it holds on to altogether, it is emptied and the whole screen is
+// stored instead.
+//
+int SB_Turn (sbuffer_t* sbuffer, float angle, float* x0, float* x1)
+{
+    const float lo = sbuffer->offset + angle / sbuffer->turn;
+    const float hi = lo + sbuffer->size;
+    const float full = 2 * SB_PI / sbuffer->turn;
+
+    sbuffer->offset = lo;
+
+    if (lo >= sbuffer->seen_x0 && hi <= sbuffer->seen_x1) return 0;
+
+    if (lo > sbuffer->seen_x1 || hi < sbuffer->seen_x0 ||
+        SB_MAX(hi, sbuffer->seen_x1) - SB_MIN(lo, sbuffer->seen_x0) > full)
+    {
+        SB_ClearCylindrical(sbuffer);
+        *x0 = 0;
+        *x1 = sbuffer->size;
+
+        return 1;
+    }
+
+    if (hi > sbuffer->seen_x1)
+    {
+        *x0 = sbuffer->seen_x1 - lo;
+        *x1 = sbuffer->size;
+        sbuffer->seen_x1 = hi;
+    }
+    else
+    {
+        *x0 = 0;
+        *x1 = sbuffer->seen_x0 - lo;
+        sbuffer->seen_x0 = lo;
+    }
+
+    return 1;
+}
+
+//
+// SB_ClearCylindrical
+// Empty out a cylindrical buffer for a camera that has moved, holding on to the
+// primitive table for whatever is pushed next. The heading the camera has now
+// is the one the buffer starts out with from then on.
+//
+void SB_ClearCylindrical (sbuffer_t* sbuffer)
+{
+    SB_Empty(sbuffer);
+    sbuffer->offset = 0;
+    sbuffer->seen_x0 = 0;
+    sbuffer->seen_x1 = sbuffer->size;
+}
+
+//
+// SB_Coverage
+// Query how much of the range `[x0, x1)` is covered by the spans in the buffer,
+// and how far the farthest visible surface within that range is from the eye.
+//
+// The covered portion is stored in `covered` as a fraction of the (clipped)
+// range, whereas the view space distance to the farthest surface is stored in
+// `max_z` -- `0` if nothing within the range is covered.
+//
+// Takes time O(log n) as whole subtrees that fall inside the range are
+// accounted for by their aggregates, without visiting each span -- or time
+// proportional to the spans within the range with the x-bucket backend.
+//
+// A non-zero return value indicates that the range lies outside the buffer.
+//
+int
+SB_Coverage
+( const sbuffer_t* sbuffer,
+  float  x0, float x1,
+  float* covered,
+  float* max_z )
+{
+    // clip the range from left
+    const float lo = SB_MAX(x0, 0) + sbuffer->offset;
+    // ...and right
+    const float hi = SB_MIN(x1, sbuffer->size) + sbuffer->offset;
+
+    *covered = 0;
+    *max_z = 0;
+
+    if (hi <= lo) return 1;
+
+    if (sbuffer->buckets)
+    {
+        SB_CoverageBuckets(sbuffer, lo, hi, covered, max_z);
+
+        return 0;
+    }
+
+    // each partially overlapping span defers both of its children
+    const size_t max_depth = (sbuffer->max_depth + 1) << 1;
+    pscope_t stack[max_depth];
+    int sp = 0; // stack pointer
+    float cover = 0, w_far = FLT_MAX;
+
+    if (sbuffer->root)
+    {
+        pscope_t scope = {
+            sbuffer->root, sbuffer->seen_x0, sbuffer->seen_x1
+        };
+        *(stack + sp++) = scope;
+    }
+
+    while (sp)
+    {
+        const pscope_t scope = *(stack + --sp);
+        const span_t* span = scope.span;
+
+        /* the entire subtree is out of range */
+        if (scope.right <= lo || scope.left >= hi) continue;
+
+        /* the entire subtree is in range, its aggregates will do */
+        if (scope.left >= lo && scope.right <= hi)
+        {
+            cover += span->cover;
+            w_far = SB_MIN(w_far, span->w_far);
+
+            continue;
+        }
+
+        /* the range is partially overlapping the subtree: account for the
+         * span itself, and carry on with its children
+         */
+        const float span_lo = SB_MAX(span->x0, lo);
+        const float span_hi = SB_MIN(span->x1, hi);
+
+        if (span_hi > span_lo)
+        {
+            const sbprim_t* prim = SB_PRIM(sbuffer, span);
+            const float w_lo = SB_BUFFER_W(sbuffer, prim, span_lo);
+            const float w_hi = SB_BUFFER_W(sbuffer, prim, span_hi);
+            cover += span_hi - span_lo;
+            w_far = SB_MIN(w_far, SB_MIN(w_lo, w_hi));
+        }
+
+        SB_ASSERT(sp + 2 <= max_depth,
+                  "[SB_Coverage] Maximum buffer depth reached!\n");
+
+        if (span->prev)
+        {
+            pscope_t prev_scope = { span->prev, scope.left, span->x0 };
+            *(stack + sp++) = prev_scope;
+        }
+
+        if (span->next)
+        {
+            pscope_t next_scope = { span->next, span->x1, scope.right };
+            *(stack + sp++) = next_scope;
+        }
+    }
+
+    *covered = SB_MIN(cover / (hi - lo), 1);
+    if (cover > 0) *max_z = 1 / w_far;
+
+    return 0;
+}
+
+//
+// SB_Dump
+// Dump the spans in the buffer to `stdout` in a tree-like structure to help in
+// debugging.
+//
+// Each line in the dump follows the format:
+//     [<id>] [BF=<balance factor>] [H=<height>] [<x0>, <x1>).
+//
+// ...or, with the x-bucket backend, each non-empty bucket is followed by the
+// spans within it:
+//     [#<index>] [N=<span count>] [<left>, <right>)
+//      ├─[<id>] [<x0>, <x1>)
+//
+void SB_Dump (const sbuffer_t* sbuffer)
+{
+    if (sbuffer->buckets)
+    {
+        SB_DumpBuckets(sbuffer);
+
+        return;
+    }
+
+    if (!sbuffer->root)
+    {
+#ifdef SB_VERBOSE
+        printf("[SB_Dump] Empty S-Buffer!\n");
+#endif // SB_VERBOSE
+
+        return;
+    }
+
+    const size_t max_depth = sbuffer->max_depth + 1;
+    const span_t* curr = sbuffer->root;
+    const span_t* stack[max_depth];
+    byte_t bookmarks[max_depth];
+    byte_t visited[max_depth];
+    byte_t has_right_sibling[max_depth];
+    int sp = 0; // stack pointer
+    int cp = 0; // child pointer
+
+    *visited = 0;
+    *has_right_sibling = 0;
+
+    while (curr)
+    {
+        SB_ASSERT(sp < max_depth, "[SB_Dump] Maximum buffer depth reached!\n");
+
+        const byte_t previously_visited = *(visited + sp);
+        *(stack + sp) = curr;
+        *(bookmarks + sp) = cp;
+        *(visited + sp++) = 0xff;
+
+        if (!previously_visited)
+        {
+            const size_t self = sp - 1;
+
+            if (self) printf(" ");
+
+            for (size_t i = 1; i < self; ++i)
+            {
+                 if (*(has_right_sibling + i)) printf("%s  ", SB_REPR_ARM0);
+                 else printf("   ");
+            }
+
+            if (self)
+            {
+                if (*(bookmarks + self - 1) || !(*(stack + self - 1))->next)
                     printf(SB_REPR_RIGHT);
                 else
                     printf(SB_REPR_LEFT);
@@ -1399,14 +7608,16 @@ void SB_Dump (const sbuffer_t* sbuffer)
             if (invariant_violation_reason)
             {
                 printf("\x1b[31m [%c] [BF=%d] [H=%d] [%.3f, %.3f) \x1b[0m",
-                       curr->id, SB_BF(curr), curr->height, curr->x0, curr->x1);
+                       SB_PRIM(sbuffer, curr)->id, SB_BF(curr), curr->height,
+                       curr->x0, curr->x1);
 
                 printf("(reason: %s)\n", invariant_violation_reason);
             }
             else
             {
                 printf("[%c] [BF=%d] [H=%d] [%.3f, %.3f)\n",
-                       curr->id, SB_BF(curr), curr->height, curr->x0, curr->x1);
+                       SB_PRIM(sbuffer, curr)->id, SB_BF(curr), curr->height,
+                       curr->x0, curr->x1);
             }
         }
 
@@ -1439,13 +7650,24 @@ void SB_Dump (const sbuffer_t* sbuffer)
     }
 }
 
-static void SB_PrintSpan (byte_t* buffer, const span_t* span)
+static
+void
+SB_PrintSpan
+( const sbuffer_t* sbuffer,
+  byte_t*          buffer,
+  const span_t*    span )
 {
-    const int X0 = ceil(span->x0 - 0.5f), X1 = ceil(span->x1 - 0.5f);
+    /* cylindrical buffers hold on to spans that have been turned off of the
+     * screen
+     */
+    const float x0 = SB_MAX(span->x0 - sbuffer->offset, 0);
+    const float x1 = SB_MIN(span->x1 - sbuffer->offset, sbuffer->size);
+    const int X0 = ceil(x0 - 0.5f), X1 = ceil(x1 - 0.5f);
     const int span_size = X1 - X0;
+    const byte_t id = SB_PRIM(sbuffer, span)->id;
     int x = X0;
 
-    for (size_t i = 0; i < span_size; ++i) *(buffer + x++) = span->id;
+    for (int i = 0; i < span_size; ++i) *(buffer + x++) = id;
 }
 
 //
@@ -1479,7 +7701,7 @@ void SB_Print (const sbuffer_t* sbuffer)
         }
         else if (cp < 2 && curr->next)
         {
-            SB_PrintSpan(out, curr);
+            SB_PrintSpan(sbuffer, out, curr);
 
             cp = 0; // reset child pointer as we're about to enter a new subtree
             *(bookmarks + sp - 1) = 1; // update parent's bookmark to `next`
@@ -1490,7 +7712,7 @@ void SB_Print (const sbuffer_t* sbuffer)
          */
         else if (--sp > 0)
         {
-            if (!curr->next) SB_PrintSpan(out, curr);
+            if (!curr->next) SB_PrintSpan(sbuffer, out, curr);
 
             curr = *(stack + --sp);
             cp = *(bookmarks + sp) + 1;
@@ -1499,12 +7721,26 @@ void SB_Print (const sbuffer_t* sbuffer)
         {
             // we need to account for cases where the S-Buffer only has a single
             // `prev` child and a maximum depth of one
-            if (!curr->next) SB_PrintSpan(out, curr);
+            if (!curr->next) SB_PrintSpan(sbuffer, out, curr);
 
             curr = 0; // exit condition
         }
     }
 
+    for (int i = 0; i < sbuffer->buckets_count; ++i)
+    {
+        const sbbucket_t* bucket = sbuffer->buckets + i;
+
+        for (int j = 0; j < bucket->count; ++j)
+        {
+            const sbentry_t* span = bucket->spans + j;
+            const int X0 = ceil(span->x0 - 0.5f), X1 = ceil(span->x1 - 0.5f);
+
+            for (int x = X0; x < X1; ++x)
+                *(out + x) = SB_PRIM(sbuffer, span)->id;
+        }
+    }
+
     printf("%s\n", out);
 }
 
@@ -1556,8 +7792,52 @@ void SB_Destroy (sbuffer_t* sbuffer)
         }
     }
 
+    for (int i = 0; i < sbuffer->buckets_count; ++i)
+        free((sbuffer->buckets + i)->spans);
+
+    free(sbuffer->buckets);
+    free(sbuffer->prims);
     free(sbuffer);
 }
 
+/* the header includes itself once more to build the kernels for the AVX-512
+ * wrappers -- everything but the kernels is skipped the second time around.
+ * The kernels are built for AVX-512 themselves rather than only inlined into
+ * wrappers that are, or their vector operations are split up before they ever
+ * get there; and without contracting into fused multiply-adds, which AVX-512
+ * comes with, so that all the variants agree down to the last bit
+ */
+#pragma push_macro("SB_LANES")
+#pragma GCC push_options
+#ifdef SB_X86
+#pragma GCC target ("avx512f")
+#endif // SB_X86
+#pragma GCC optimize ("fp-contract=off")
+#define S_BUFFER_WIDE
+#include "s_buffer.h"
+#undef S_BUFFER_WIDE
+#pragma GCC pop_options
+#pragma pop_macro("SB_LANES")
+
+#undef sb_vf
+#undef sb_vi
+
+#undef SB_ProjectVectors
+#undef SB_ProjectLanes
+#undef _SB_ProjectMany
+#undef SB_IntersectLanes
+#undef _SB_IntersectMany
+#undef SB_RowLanes
+#undef _SB_PushPolygon
+#undef SB_SightLanes
+#undef _SB_SeeMany
+#undef _SB_ProjectCameras
+#undef _SB_ProjectViews
+
+#ifdef SB_REFERENCE
+#pragma GCC pop_options
+#endif // SB_REFERENCE
+
+#endif // S_BUFFER_WIDE
 #endif // S_BUFFER_DEFS_ONLY
 #endif // s_buffer_h
@@ -0,0 +1,391 @@
+/*
+ *  s_bsp.h
+ *  s-buffer
+ *
+ *  Created by agent on 2026-10-18.
+ *
+ *  SYNOPSIS:
+ *      A BSP builder for 2-D wall segments, and a driver that walks the tree
+ *      front-to-back from the eye, pushing each segment onto an S-Buffer.
+ *
+ *      Segments visited earlier can never be obscured by the ones visited
+ *      later, so any subtree whose screen extent is already fully covered in
+ *      the buffer is culled without being visited any further, and the walk
+ *      stops altogether as soon as the buffer is full.
+ *
+ *      The eye is situated at (`eye_x`, `eye_y`), looking toward (0, -1) --
+ *      the same as `S_ToScreenSpace`.
+ */
+
+#ifndef s_bsp_h
+
+#include <stdlib.h>
+#include <math.h>
+#include <float.h>
+
+#include "shared/s_helpers.h"
+#define S_BUFFER_DEFS_ONLY
+#include "s_buffer.h"
+
+#define s_bsp_h
+#define s_bsp_h_bspnode_t bspnode_t
+#define s_bsp_h_S_BuildBsp S_BuildBsp
+#define s_bsp_h_S_TraverseBsp S_TraverseBsp
+#define s_bsp_h_S_DestroyBsp S_DestroyBsp
+
+#define S_BSP_EPS 1e-3f
+// how many splitter candidates to score at each node
+#define S_BSP_CANDIDATES 8
+// how much uncovered width a range can have left and still be considered full
+#define S_BSP_COVERED_EPS 1e-2f
+
+typedef struct {
+    float   x0, y0, x1, y1; // endpoints in world space
+    color_t color;
+    byte_t  id;
+    size_t  index;          // index of the original segment it was cut from
+} bspseg_t;
+
+typedef struct bspnode {
+    struct bspnode *front, *back; // subtrees on either side of the splitter
+    bspseg_t  splitter;   // the segment that partitions the space
+    bspseg_t* segs;       // segments lying on the splitter, in original order
+    size_t    segs_count;
+    float     min_x, min_y; // bounds of every segment in this subtree
+    float     max_x, max_y; //
+} bspnode_t;
+
+//
+// S_BspSide
+// Signed distance of the point (`x`, `y`) to the line the segment `seg` lies
+// on. Positive values denote the front side.
+//
+static float S_BspSide (const bspseg_t* seg, float x, float y)
+{
+    const float dx = seg->x1 - seg->x0, dy = seg->y1 - seg->y0;
+    const float len = sqrtf(dx * dx + dy * dy);
+
+    return (dx * (y - seg->y0) - dy * (x - seg->x0)) / len;
+}
+
+//
+// S_BspScore
+// Score how good of a splitter `splitter` would be for the given segments --
+// the lower the better. Splits are penalized more heavily than imbalance as
+// they grow the tree for good.
+//
+static size_t
+S_BspScore
+( const bspseg_t* segs,
+  size_t          n,
+  const bspseg_t* splitter )
+{
+    size_t front = 0, back = 0, splits = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const bspseg_t* seg = segs + i;
+        if (seg == splitter) continue;
+
+        const float d0 = S_BspSide(splitter, seg->x0, seg->y0);
+        const float d1 = S_BspSide(splitter, seg->x1, seg->y1);
+
+        if (d0 >= -S_BSP_EPS && d1 >= -S_BSP_EPS) ++front;
+        else if (d0 <= S_BSP_EPS && d1 <= S_BSP_EPS) ++back;
+        else ++splits;
+    }
+
+    return 3 * splits + (front > back ? front - back : back - front);
+}
+
+static bspnode_t* _S_BuildBsp (bspseg_t* segs, size_t n)
+{
+    if (!n) return 0;
+
+    /* pick the best splitter among a handful of evenly distributed
+     * candidates
+     */
+    const size_t stride = n / S_BSP_CANDIDATES + 1;
+    size_t best = 0, best_score = (size_t) -1;
+
+    for (size_t i = 0; i < n; i += stride)
+    {
+        const size_t score = S_BspScore(segs, n, segs + i);
+
+        if (score < best_score)
+        {
+            best = i;
+            best_score = score;
+        }
+    }
+
+    const bspseg_t splitter = *(segs + best);
+    bspseg_t* front = (bspseg_t*) malloc(n * sizeof(bspseg_t));
+    bspseg_t* back = (bspseg_t*) malloc(n * sizeof(bspseg_t));
+    bspseg_t* on = (bspseg_t*) malloc(n * sizeof(bspseg_t));
+    size_t front_count = 0, back_count = 0, on_count = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const bspseg_t seg = *(segs + i);
+        const float d0 = S_BspSide(&splitter, seg.x0, seg.y0);
+        const float d1 = S_BspSide(&splitter, seg.x1, seg.y1);
+
+        /* collinear segments stay with the splitter: they are at the exact
+         * same depth, so the one that comes first in the original order has to
+         * be pushed first to win the tie -- the same way it would, had the
+         * segments been pushed without a BSP tree
+         */
+        if ((i == best) ||
+            (d0 >= -S_BSP_EPS && d0 <= S_BSP_EPS &&
+             d1 >= -S_BSP_EPS && d1 <= S_BSP_EPS))
+        {
+            size_t j = on_count++;
+
+            for (; j && (on + j - 1)->index > seg.index; --j)
+                *(on + j) = *(on + j - 1);
+
+            *(on + j) = seg;
+        }
+        /* the ones merely touching the splitter go to the side they're on */
+        else if (d0 >= -S_BSP_EPS && d1 >= -S_BSP_EPS)
+        {
+            *(front + front_count++) = seg;
+        }
+        else if (d0 <= S_BSP_EPS && d1 <= S_BSP_EPS)
+        {
+            *(back + back_count++) = seg;
+        }
+        /* the segment is crossing the splitter, split it in two */
+        else
+        {
+            const float t = d0 / (d0 - d1);
+            const float split_x = seg.x0 + (seg.x1 - seg.x0) * t;
+            const float split_y = seg.y0 + (seg.y1 - seg.y0) * t;
+            bspseg_t head = seg, tail = seg;
+            head.x1 = split_x; head.y1 = split_y;
+            tail.x0 = split_x; tail.y0 = split_y;
+
+            if (d0 > 0)
+            {
+                *(front + front_count++) = head;
+                *(back + back_count++) = tail;
+            }
+            else
+            {
+                *(back + back_count++) = head;
+                *(front + front_count++) = tail;
+            }
+        }
+    }
+
+    bspnode_t* node = (bspnode_t*) malloc(sizeof(bspnode_t));
+    node->splitter = splitter;
+    node->segs = (bspseg_t*) realloc(on, on_count * sizeof(bspseg_t));
+    node->segs_count = on_count;
+    node->front = _S_BuildBsp(front, front_count);
+    node->back = _S_BuildBsp(back, back_count);
+
+    free(front);
+    free(back);
+
+    /* grow the bounds to enclose the segments on the splitter as well as both
+     * subtrees
+     */
+    node->min_x = node->min_y = FLT_MAX;
+    node->max_x = node->max_y = -FLT_MAX;
+
+    for (size_t i = 0; i < on_count; ++i)
+    {
+        const bspseg_t* seg = node->segs + i;
+        node->min_x = SB_MIN(node->min_x, SB_MIN(seg->x0, seg->x1));
+        node->min_y = SB_MIN(node->min_y, SB_MIN(seg->y0, seg->y1));
+        node->max_x = SB_MAX(node->max_x, SB_MAX(seg->x0, seg->x1));
+        node->max_y = SB_MAX(node->max_y, SB_MAX(seg->y0, seg->y1));
+    }
+
+    const bspnode_t* children[2] = { node->front, node->back };
+
+    for (size_t i = 0; i < 2; ++i)
+    {
+        const bspnode_t* child = *(children + i);
+        if (!child) continue;
+
+        node->min_x = SB_MIN(node->min_x, child->min_x);
+        node->min_y = SB_MIN(node->min_y, child->min_y);
+        node->max_x = SB_MAX(node->max_x, child->max_x);
+        node->max_y = SB_MAX(node->max_y, child->max_y);
+    }
+
+    return node;
+}
+
+//
+// S_BuildBsp
+// Build a BSP tree out of the given segments. Each segment is assigned the id
+// `first_id + i`, where `i` is its index in `segs`; segments that end up split
+// retain the id of the original.
+//
+bspnode_t* S_BuildBsp (const seg2_t* segs, size_t n, byte_t first_id)
+{
+    bspseg_t* work = (bspseg_t*) malloc((n ? n : 1) * sizeof(bspseg_t));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t* seg = segs + i;
+        bspseg_t bspseg = { seg->src.x, seg->src.y,
+                            seg->dst.x, seg->dst.y,
+                            seg->color,
+                            (byte_t) (first_id + i),
+                            i };
+        *(work + i) = bspseg;
+    }
+
+    bspnode_t* root = _S_BuildBsp(work, n);
+    free(work);
+
+    return root;
+}
+
+//
+// S_BspCovered
+// Whether the range `[x0, x1)` is fully covered in the buffer.
+//
+static byte_t S_BspCovered (const sbuffer_t* sbuffer, float x0, float x1)
+{
+    float covered, max_z;
+    if (SB_Coverage(sbuffer, x0, x1, &covered, &max_z)) return 0xff;
+
+    const float lo = SB_MAX(x0, 0), hi = SB_MIN(x1, sbuffer->size);
+
+    return (1 - covered) * (hi - lo) < S_BSP_COVERED_EPS;
+}
+
+//
+// S_BspOccluded
+// Whether every segment in the subtree under `node` is guaranteed to be hidden
+// from the eye -- either because it falls outside the view frustum, or because
+// its screen extent is fully covered already.
+//
+static byte_t
+S_BspOccluded
+( const sbuffer_t*  sbuffer,
+  const bspnode_t*  node,
+  float eye_x, float eye_y )
+{
+    const float halfwidth = sbuffer->size * 0.5f, z_near = sbuffer->z_near;
+    const float xs[2] = { node->min_x, node->max_x };
+    const float ys[2] = { node->min_y, node->max_y };
+    float lo = FLT_MAX, hi = -FLT_MAX, max_z = -FLT_MAX;
+    byte_t straddling = 0;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        const float view_x = *(xs + (i & 1)) - eye_x;
+        const float view_z = eye_y - *(ys + (i >> 1));
+        max_z = SB_MAX(max_z, view_z);
+
+        if (view_z < z_near)
+        {
+            straddling = 0xff;
+
+            continue;
+        }
+
+        const float screen_x = halfwidth + view_x * z_near / view_z;
+        lo = SB_MIN(lo, screen_x);
+        hi = SB_MAX(hi, screen_x);
+    }
+
+    // the subtree lies entirely behind the near-clipping plane
+    if (max_z < z_near) return 0xff;
+    // the bounds are crossing the near-clipping plane, so there's no telling
+    // where they span on screen -- better to be conservative
+    if (straddling) return 0;
+    // the subtree is outside the view frustum
+    if (hi <= 0 || lo >= sbuffer->size) return 0xff;
+
+    return S_BspCovered(sbuffer, lo, hi);
+}
+
+//
+// S_BspPush
+// Transform the segment `seg` into view space and push it onto the buffer.
+//
+static void
+S_BspPush
+( sbuffer_t*      sbuffer,
+  const bspseg_t* seg,
+  float eye_x, float eye_y )
+{
+    SB_PushView(sbuffer,
+                seg->x0 - eye_x, eye_y - seg->y0,
+                seg->x1 - eye_x, eye_y - seg->y1,
+                seg->id,
+                seg->color);
+}
+
+static byte_t
+_S_TraverseBsp
+( sbuffer_t*       sbuffer,
+  const bspnode_t* node,
+  float   eye_x, float eye_y,
+  size_t* visited )
+{
+    if (!node) return 0;
+
+    ++*visited;
+
+    if (S_BspOccluded(sbuffer, node, eye_x, eye_y)) return 0;
+
+    const byte_t eye_in_front = S_BspSide(&node->splitter, eye_x, eye_y) >= 0;
+    const bspnode_t* near_side = eye_in_front ? node->front : node->back;
+    const bspnode_t* far_side = eye_in_front ? node->back : node->front;
+
+    if (_S_TraverseBsp(sbuffer, near_side, eye_x, eye_y, visited)) return 0xff;
+
+    for (size_t i = 0; i < node->segs_count; ++i)
+        S_BspPush(sbuffer, node->segs + i, eye_x, eye_y);
+
+    /* stop as soon as the buffer is full */
+    if (S_BspCovered(sbuffer, 0, sbuffer->size)) return 0xff;
+
+    return _S_TraverseBsp(sbuffer, far_side, eye_x, eye_y, visited);
+}
+
+//
+// S_TraverseBsp
+// Walk the BSP tree front-to-back as seen from the eye at (`eye_x`, `eye_y`),
+// pushing each segment onto the buffer.
+//
+// Returns the number of BSP nodes visited, which is only a fraction of the
+// whole tree in densely occluded scenes.
+//
+size_t
+S_TraverseBsp
+( sbuffer_t*       sbuffer,
+  const bspnode_t* root,
+  float eye_x, float eye_y )
+{
+    size_t visited = 0;
+
+    _S_TraverseBsp(sbuffer, root, eye_x, eye_y, &visited);
+
+    return visited;
+}
+
+//
+// S_DestroyBsp
+// Free up all memory allocated by the BSP tree.
+//
+void S_DestroyBsp (bspnode_t* node)
+{
+    if (!node) return;
+
+    S_DestroyBsp(node->front);
+    S_DestroyBsp(node->back);
+    free(node->segs);
+    free(node);
+}
+
+#endif
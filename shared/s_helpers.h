@@ -11,6 +11,8 @@
 
 #ifndef s_helpers_h
 
+#include <stdlib.h>
+
 #define S_BUFFER_DEFS_ONLY
 #include "s_buffer.h"
 
@@ -20,6 +22,7 @@
 #define s_helpers_h_seg2_t seg2_t
 #define s_helpers_h_S_ZToScreenSpace S_ZToScreenSpace
 #define s_helpers_h_S_ToScreenSpace S_ToScreenSpace
+#define s_helpers_h_S_ProjectSegs S_ProjectSegs
 
 typedef unsigned int color_t;
 
@@ -64,4 +67,32 @@ S_ToScreenSpace
     return (float) halfwidth + view_x * z_near / view_y;
 }
 
+//
+// S_ProjectSegs
+// Project `n` world space segments onto the buffer as seen by the camera via
+// `SB_ProjectMany`, which takes its input as a structure of arrays.
+//
+void
+S_ProjectSegs
+( const sbuffer_t*  sbuffer,
+  const sbcamera_t* camera,
+  const seg2_t*     segs,
+  size_t            n,
+  sbprojection_t*   out )
+{
+    float* soa = (float*) malloc(((n << 2) + 1) * sizeof(float));
+    float *src_x = soa, *src_y = src_x + n;
+    float *dst_x = src_y + n, *dst_y = dst_x + n;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t* seg = segs + i;
+        *(src_x + i) = seg->src.x; *(src_y + i) = seg->src.y;
+        *(dst_x + i) = seg->dst.x; *(dst_y + i) = seg->dst.y;
+    }
+
+    SB_ProjectMany(sbuffer, camera, src_x, src_y, dst_x, dst_y, n, out);
+    free(soa);
+}
+
 #endif
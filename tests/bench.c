@@ -0,0 +1,875 @@
+/*
+ *  bench.c
+ *  s-buffer
+ *
+ *  Created by agent on 2026-10-18.
+ *
+ *  SYNOPSIS:
+ *     Micro-benchmarks for the S-Buffer. Each benchmark pushes randomly
+ *     generated scenes onto the buffer over and over again, and reports the
+ *     average time it took per push.
+ *
+ *     Run under `perf stat` (see `bench.sh`) to see the branch misses as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "s_buffer.h"
+
+#define SCREEN_HALFWIDTH 400
+#define SCREEN_HEIGHT 800
+#define Z_NEAR 96
+#define MAX_DEPTH 64
+
+#define N_SCENES 64
+#define N_SEGS 256
+#define N_ROUNDS 16
+#define N_DENSITIES 4
+#define N_ROWS 128
+
+#define WALLS_ROW_BY_ROW 0
+#define WALLS_LOCKSTEP 1
+#define WALLS_COHERENT 2
+#define WALLS_INTERPOLATED 3
+#define WALLS_STRIDE 4
+
+typedef struct {
+    float x0, z0, x1, z1;
+} viewseg_t;
+
+static unsigned int seed = 0x5eed;
+
+static float Random (float lo, float hi)
+{
+    seed = seed * 1103515245 + 12345;
+
+    return lo + (hi - lo) * ((seed >> 8) & 0xffff) / 65535.0f;
+}
+
+//
+// GenerateScene
+// Short walls scattered all around in front of the eye -- the kind of scene
+// that sends the push routine down a different path at almost every span.
+//
+static void GenerateScene (viewseg_t* segs, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const float x = Random(-SCREEN_HALFWIDTH, SCREEN_HALFWIDTH);
+        const float z = Random(Z_NEAR, SCREEN_HEIGHT);
+        const viewseg_t seg = { x, z,
+                                x + Random(-96, 96), z + Random(-96, 96) };
+        *(segs + i) = seg;
+    }
+}
+
+static double Now ()
+{
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+//
+// PushScenes
+// Push every scene `N_ROUNDS` times over, either in view space or in clip
+// space, and report how long a push took on average. With `batched` set, each
+// scene is pushed as a batch, rebalanced only once it's all pushed.
+//
+static void PushScenes (const viewseg_t* scenes, byte_t homogeneous,
+                        byte_t batched)
+{
+    size_t heights = 0;
+    const double start = Now();
+
+    for (size_t round = 0; round < N_ROUNDS; ++round)
+    {
+        for (size_t i = 0; i < N_SCENES; ++i)
+        {
+            sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR,
+                                         MAX_DEPTH);
+
+            if (batched) SB_BeginBatch(sbuffer, MAX_DEPTH);
+
+            for (size_t j = 0; j < N_SEGS; ++j)
+            {
+                const viewseg_t* seg = scenes + i * N_SEGS + j;
+
+                if (homogeneous)
+                    SB_PushHomogeneous(sbuffer,
+                                       seg->x0, seg->z0,
+                                       seg->x1, seg->z1,
+                                       (byte_t) j,
+                                       0);
+                else
+                    SB_PushView(sbuffer,
+                                seg->x0, seg->z0,
+                                seg->x1, seg->z1,
+                                (byte_t) j,
+                                0);
+            }
+
+            if (batched) SB_EndBatch(sbuffer);
+
+            heights += sbuffer->root ? sbuffer->root->height : 0;
+            SB_Destroy(sbuffer);
+        }
+    }
+
+    const double elapsed = Now() - start;
+    const size_t pushes = (size_t) N_ROUNDS * N_SCENES * N_SEGS;
+
+    printf("[bench] random scenes (%s%s): %zu pushes, %.1f ns/push "
+           "(checksum %zu)\n",
+           homogeneous ? "clip space" : "view space",
+           batched ? ", batched" : "",
+           pushes, elapsed / pushes * 1e9, heights);
+}
+
+//
+// PushDensities
+// Push ever denser scenes onto the tree as well as onto x-buckets of a couple
+// of widths, and report how long a push took on average with each. Every one
+// of them should come up with about the same checksum (the total width
+// covered) -- give or take the slivers the tree drops.
+//
+static void PushDensities (const viewseg_t* scenes, size_t n_segs)
+{
+    const size_t densities[N_DENSITIES] = { 32, 128, 512, 2048 };
+    const int shifts[] = { 0, 5, 6 }; // zero stands for the tree
+
+    for (size_t d = 0; d < N_DENSITIES; ++d)
+    {
+        const size_t n = *(densities + d);
+        /* about as many pushes for each density */
+        const size_t rounds = SB_MAX(N_ROUNDS * N_SEGS / n, 1);
+
+        for (size_t k = 0; k < sizeof(shifts) / sizeof(int); ++k)
+        {
+            const int shift = *(shifts + k);
+            double cover = 0;
+            const double start = Now();
+
+            for (size_t round = 0; round < rounds; ++round)
+            {
+                for (size_t i = 0; i < N_SCENES; ++i)
+                {
+                    sbuffer_t* sbuffer =
+                        shift ? SB_InitBuckets(SCREEN_HALFWIDTH << 1, Z_NEAR,
+                                               shift)
+                              : SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR,
+                                        MAX_DEPTH);
+                    float covered, max_z;
+
+                    for (size_t j = 0; j < n; ++j)
+                    {
+                        const viewseg_t* seg = scenes + i * n_segs + j;
+
+                        SB_PushView(sbuffer,
+                                    seg->x0, seg->z0,
+                                    seg->x1, seg->z1,
+                                    (byte_t) j,
+                                    0);
+                    }
+
+                    SB_Coverage(sbuffer, 0, SCREEN_HALFWIDTH << 1,
+                                &covered, &max_z);
+                    cover += covered * (SCREEN_HALFWIDTH << 1);
+                    SB_Destroy(sbuffer);
+                }
+            }
+
+            const double elapsed = Now() - start;
+            const size_t pushes = rounds * N_SCENES * n;
+
+            if (shift)
+                printf("[bench] %4zu segments, %2d px buckets: ",
+                       n, 1 << shift);
+            else
+                printf("[bench] %4zu segments, tree:          ", n);
+
+            printf("%.1f ns/push (checksum %.0f)\n",
+                   elapsed / pushes * 1e9, cover / rounds);
+        }
+    }
+}
+
+//
+// PushWalls
+// Raise a wall out of each segment of every scene, tall enough to span most of
+// the rows, and push them onto a stack of rows -- scan-converted and pushed one
+// row at a time (`WALLS_ROW_BY_ROW`), as polygons eight rows at a time
+// (`WALLS_LOCKSTEP`), as polygons all at once, each row derived from the one
+// above it (`WALLS_COHERENT`), or onto every `WALLS_STRIDE`-th row only, the
+// rest interpolated (`WALLS_INTERPOLATED`). Report how long it took on average
+// per wall.
+//
+static void PushWalls (const viewseg_t* scenes, int mode)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const float floor = Z_NEAR * N_ROWS, height = 2 * floor;
+    size_t spans = 0, pushed = 0, shared = 0;
+    double elapsed = 0;
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+    {
+        sbrows_t* rows = SB_InitRows(size, N_ROWS, Z_NEAR, MAX_DEPTH);
+        float x[N_SEGS << 2], y[N_SEGS << 2], w[N_SEGS << 2];
+        sbpolygon_t polygons[N_SEGS];
+        int count = 0;
+        const double start = Now();
+
+        for (size_t j = 0; j < N_SEGS; ++j)
+        {
+            const viewseg_t* seg = scenes + i * N_SEGS + j;
+            float w0 = 1 / seg->z0, w1 = 1 / seg->z1;
+            float x0 = SCREEN_HALFWIDTH + seg->x0 * Z_NEAR * w0;
+            float x1 = SCREEN_HALFWIDTH + seg->x1 * Z_NEAR * w1;
+
+            if (x1 < x0)
+            {
+                float tmp = x0; x0 = x1; x1 = tmp;
+                tmp = w0; w0 = w1; w1 = tmp;
+            }
+
+            if (!(x1 > x0)) continue;
+
+            if (mode != WALLS_ROW_BY_ROW)
+            {
+                float* wall_x = x + (count << 2);
+                float* wall_y = y + (count << 2);
+                float* wall_w = w + (count << 2);
+                const sbpolygon_t polygon =
+                    { wall_x, wall_y, wall_w, 4, (byte_t) j, 0 };
+
+                *wall_x = *(wall_x + 3) = x0;
+                *(wall_x + 1) = *(wall_x + 2) = x1;
+                *wall_y = N_ROWS / 2 + (floor - height) * w0;
+                *(wall_y + 1) = N_ROWS / 2 + (floor - height) * w1;
+                *(wall_y + 2) = N_ROWS / 2 + floor * w1;
+                *(wall_y + 3) = N_ROWS / 2 + floor * w0;
+                *wall_w = *(wall_w + 3) = w0;
+                *(wall_w + 1) = *(wall_w + 2) = w1;
+                *(polygons + count++) = polygon;
+
+                if (mode == WALLS_LOCKSTEP)
+                    pushed += SB_PushPolygon(rows,
+                                             wall_x, wall_y,
+                                             wall_w,
+                                             4,
+                                             (byte_t) j,
+                                             0);
+
+                continue;
+            }
+
+            const float dw = (w1 - w0) / (x1 - x0);
+
+            for (int row = 0; row < N_ROWS; ++row)
+            {
+                /* the row lies under the top edge, and above the bottom one */
+                const float c = row + 0.5f - N_ROWS / 2;
+                const float k[2] = { floor - height, -floor };
+                const float cs[2] = { c, -c };
+                float lo = SB_MAX(x0, 0), hi = SB_MIN(x1, size);
+
+                for (int l = 0; l < 2; ++l)
+                {
+                    const float p = *(cs + l) - *(k + l) * w0;
+                    const float q = -*(k + l) * dw;
+
+                    if (q > 0) lo = SB_MAX(lo, x0 - p / q);
+                    else if (q < 0) hi = SB_MIN(hi, x0 - p / q);
+                    else if (p < 0) hi = lo;
+                }
+
+                if (hi > lo)
+                    pushed += !SB_Push(*(rows->rows + row),
+                                       lo, hi,
+                                       w0 + (lo - x0) * dw, w0 + (hi - x0) * dw,
+                                       (byte_t) j,
+                                       0);
+            }
+        }
+
+        if (mode == WALLS_COHERENT)
+            pushed += SB_PushCoherent(rows, polygons, count);
+
+        /* ...counting the rows pushed onto for real instead */
+        if (mode == WALLS_INTERPOLATED)
+            pushed += SB_PushInterpolated(rows, polygons, count, WALLS_STRIDE);
+
+        elapsed += Now() - start;
+
+        for (int row = 0; row < N_ROWS; ++row)
+        {
+            const span_t* root = (*(rows->rows + row))->root;
+            spans += root ? root->height : 0;
+        }
+
+        /* rows pushed all at once come out shared already */
+        if (mode != WALLS_COHERENT) SB_ShareRows(rows);
+
+        for (int row = 1; row < N_ROWS; ++row)
+            shared += *(rows->rows + row) == *(rows->rows + row - 1);
+
+        SB_DestroyRows(rows);
+    }
+
+    const size_t walls = (size_t) N_SCENES * N_SEGS;
+
+    printf("[bench] walls on %d rows (%s): %.1f ns/wall, %zu rows pushed, "
+           "%zu shared (checksum %zu)\n",
+           N_ROWS,
+           mode == WALLS_INTERPOLATED ? "interpolated" :
+           mode == WALLS_COHERENT ? "coherent" :
+           mode == WALLS_LOCKSTEP ? "8 rows at a time" : "row by row",
+           elapsed / walls * 1e9, pushed, shared, spans);
+}
+
+//
+// PushColumnWalls
+// Raise the same walls as `PushWalls` does, and push them onto a row of column
+// buffers instead, a slice at a time. Report how long it took on average per
+// wall.
+//
+static void PushColumnWalls (const viewseg_t* scenes)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const float floor = Z_NEAR * N_ROWS, height = 2 * floor;
+    size_t spans = 0, pushed = 0;
+    double elapsed = 0;
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+    {
+        sbcolumns_t* columns = SB_InitColumns(size, N_ROWS, Z_NEAR, MAX_DEPTH);
+        const double start = Now();
+
+        for (size_t j = 0; j < N_SEGS; ++j)
+        {
+            const viewseg_t* seg = scenes + i * N_SEGS + j;
+            float w0 = 1 / seg->z0, w1 = 1 / seg->z1;
+            float x0 = SCREEN_HALFWIDTH + seg->x0 * Z_NEAR * w0;
+            float x1 = SCREEN_HALFWIDTH + seg->x1 * Z_NEAR * w1;
+
+            if (x1 < x0)
+            {
+                float tmp = x0; x0 = x1; x1 = tmp;
+                tmp = w0; w0 = w1; w1 = tmp;
+            }
+
+            pushed += SB_PushWall(columns,
+                                  x0, x1,
+                                  N_ROWS / 2 + (floor - height) * w0,
+                                  N_ROWS / 2 + (floor - height) * w1,
+                                  N_ROWS / 2 + floor * w0,
+                                  N_ROWS / 2 + floor * w1,
+                                  w0, w1,
+                                  (byte_t) j,
+                                  0);
+        }
+
+        elapsed += Now() - start;
+
+        for (int column = 0; column < size; ++column)
+        {
+            const span_t* root = (*(columns->columns + column))->root;
+            spans += root ? root->height : 0;
+        }
+
+        SB_DestroyColumns(columns);
+    }
+
+    const size_t walls = (size_t) N_SCENES * N_SEGS;
+
+    printf("[bench] walls on %d columns: %.1f ns/wall, %zu slices pushed "
+           "(checksum %zu)\n",
+           size, elapsed / walls * 1e9, pushed, spans);
+}
+
+//
+// PushPolar
+// Push every scene onto a polar buffer around the eye, and walk it for the
+// visibility polygon. Report how long it took on average per segment, and per
+// polygon.
+//
+static void PushPolar (const viewseg_t* scenes)
+{
+    size_t vertices = 0;
+    double elapsed = 0, walked = 0;
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+    {
+        sbpolar_t* polar = SB_InitPolar(0, 0, 512, 1, MAX_DEPTH);
+        double start = Now();
+
+        for (size_t j = 0; j < N_SEGS; ++j)
+        {
+            const viewseg_t* seg = scenes + i * N_SEGS + j;
+            SB_PushPolar(polar,
+                         seg->x0, seg->z0,
+                         seg->x1, seg->z1,
+                         (byte_t) j,
+                         0);
+        }
+
+        elapsed += Now() - start;
+        start = Now();
+
+        const size_t n = SB_VisibilityPolygon(polar, 4096, 0, 0);
+        float x[n + 1], y[n + 1];
+
+        vertices += SB_VisibilityPolygon(polar, 4096, x, y);
+        walked += Now() - start;
+
+        SB_DestroyPolar(polar);
+    }
+
+    printf("[bench] polar: %.1f ns/seg, %.1f ns/visibility polygon "
+           "(checksum %zu)\n",
+           elapsed / (N_SCENES * N_SEGS) * 1e9,
+           walked / N_SCENES * 1e9,
+           vertices);
+}
+
+//
+// PushLights
+// Light each of the first few scenes `n_segs` segments dense up from a few
+// hundred lights scattered all over it at once, on `threads` threads. Report
+// how long it took on average per light, and how many of the segments each
+// light ended up pushing.
+//
+static void PushLights (const viewseg_t* scenes, size_t n_segs, int threads)
+{
+    const size_t n_scenes = 8, n_lights = 256, capacity = 1024;
+    float src_x[n_segs], src_y[n_segs], dst_x[n_segs], dst_y[n_segs];
+    float light_x[n_lights], light_y[n_lights];
+    float* poly_x = malloc(n_lights * capacity * sizeof(float));
+    float* poly_y = malloc(n_lights * capacity * sizeof(float));
+    size_t counts[n_lights], pushed = 0, vertices = 0;
+    double elapsed = 0;
+
+    for (size_t i = 0; i < n_scenes; ++i)
+    {
+        for (size_t j = 0; j < n_segs; ++j)
+        {
+            const viewseg_t* seg = scenes + i * n_segs + j;
+
+            *(src_x + j) = seg->x0; *(src_y + j) = seg->z0;
+            *(dst_x + j) = seg->x1; *(dst_y + j) = seg->z1;
+        }
+
+        for (size_t j = 0; j < n_lights; ++j)
+        {
+            *(light_x + j) = Random(-SCREEN_HALFWIDTH, SCREEN_HALFWIDTH);
+            *(light_y + j) = Random(Z_NEAR, SCREEN_HEIGHT);
+        }
+
+        sblights_t lights = {
+            light_x, light_y, poly_x, poly_y, counts, n_lights, capacity
+        };
+        const double start = Now();
+        sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, n_segs, 64);
+
+        pushed += SB_LightMany(grid, &lights, 128, 512, 0.1f, MAX_DEPTH,
+                               threads);
+        elapsed += Now() - start;
+
+        for (size_t j = 0; j < n_lights; ++j) vertices += *(counts + j);
+
+        SB_DestroyGrid(grid);
+    }
+
+    printf("[bench] %zu lights on %zu segments (%d threads): %.1f ns/light, "
+           "%.1f segments pushed per light (checksum %zu)\n",
+           n_lights, n_segs, threads,
+           elapsed / (n_scenes * n_lights) * 1e9,
+           (double) pushed / (n_scenes * n_lights),
+           vertices);
+
+    free(poly_x);
+    free(poly_y);
+}
+
+//
+// SeeAgents
+// Have a few hundred agents scattered all over each of the first few scenes
+// `n_segs` segments dense look at a few dozen points each, over a few ticks --
+// all of them new on the first, none of them moving on the second, and one in
+// eight of them moving on the third. Report how long each tick took per query,
+// and how many of the buffers were built on it.
+//
+static void SeeAgents (const viewseg_t* scenes, size_t n_segs)
+{
+    const size_t n_scenes = 8, n_agents = 256, per_agent = 32;
+    const size_t n = n_agents * per_agent;
+    float src_x[n_segs], src_y[n_segs], dst_x[n_segs], dst_y[n_segs];
+    float agent_x[n_agents], agent_y[n_agents];
+    float* tx = malloc(n * sizeof(float));
+    float* ty = malloc(n * sizeof(float));
+    int* agents = malloc(n * sizeof(int));
+    byte_t* out = malloc(n);
+    double elapsed[3] = { 0 };
+    size_t built[3] = { 0 }, seen = 0;
+
+    for (size_t i = 0; i < n; ++i) *(agents + i) = i / per_agent;
+
+    for (size_t i = 0; i < n_scenes; ++i)
+    {
+        for (size_t j = 0; j < n_segs; ++j)
+        {
+            const viewseg_t* seg = scenes + i * n_segs + j;
+
+            *(src_x + j) = seg->x0; *(src_y + j) = seg->z0;
+            *(dst_x + j) = seg->x1; *(dst_y + j) = seg->z1;
+        }
+
+        for (size_t j = 0; j < n_agents; ++j)
+        {
+            *(agent_x + j) = Random(-SCREEN_HALFWIDTH, SCREEN_HALFWIDTH);
+            *(agent_y + j) = Random(Z_NEAR, SCREEN_HEIGHT);
+        }
+
+        sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, n_segs, 64);
+        sbsight_t* sight = SB_InitSight(grid, n_agents, 128, 512, 0.1f,
+                                        MAX_DEPTH);
+
+        for (int tick = 0; tick < 3; ++tick)
+        {
+            for (size_t j = 0; tick == 2 && j < n_agents; j += 8)
+                *(agent_x + j) += Random(-8, 8);
+
+            for (size_t j = 0; j < n; ++j)
+            {
+                *(tx + j) = *(agent_x + j / per_agent) + Random(-128, 128);
+                *(ty + j) = *(agent_y + j / per_agent) + Random(-128, 128);
+            }
+
+            SB_PlaceAgents(sight, agent_x, agent_y);
+
+            const double start = Now();
+
+            *(built + tick) += SB_SeeMany(sight, agents, tx, ty, n, out);
+            *(elapsed + tick) += Now() - start;
+
+            for (size_t j = 0; j < n; ++j) seen += !!*(out + j);
+        }
+
+        SB_DestroySight(sight);
+        SB_DestroyGrid(grid);
+    }
+
+    for (int tick = 0; tick < 3; ++tick)
+        printf("[bench] %zu agents on %zu segments (tick %d): %.1f ns/query, "
+               "%.1f buffers built per scene (checksum %zu)\n",
+               n_agents, n_segs, tick,
+               *(elapsed + tick) / (n_scenes * n) * 1e9,
+               (double) *(built + tick) / n_scenes,
+               seen);
+
+    free(tx);
+    free(ty);
+    free(agents);
+    free(out);
+}
+
+//
+// ProjectCameras
+// Look at each of the first few scenes from 64 cameras scattered around the eye,
+// each turned a little some other way -- projecting and pushing for each camera
+// one after another, and then for all of them at once. Report how long each
+// took per camera, projecting alone and projecting and pushing both, and how
+// many segments made it past projecting and culling into the buffers.
+//
+static void ProjectCameras (const viewseg_t* scenes)
+{
+    const size_t n_scenes = 8, n_cameras = 64;
+    float src_x[N_SEGS], src_y[N_SEGS], dst_x[N_SEGS], dst_y[N_SEGS];
+    byte_t ids[N_SEGS];
+    int colors[N_SEGS];
+    sbcamera_t poses[n_cameras];
+    double project[2] = { 0 }, total[2] = { 0 };
+    size_t pushed[2] = { 0 };
+    sbcameras_t* cameras = SB_InitCameras(n_cameras, SCREEN_HALFWIDTH << 1,
+                                          Z_NEAR, MAX_DEPTH, N_SEGS);
+    sbprojection_t* projection = SB_InitProjection(N_SEGS);
+
+    for (size_t j = 0; j < N_SEGS; ++j)
+    {
+        *(ids + j) = j;
+        *(colors + j) = j;
+    }
+
+    for (size_t i = 0; i < n_scenes; ++i)
+    {
+        /* the eye sits at the origin looking toward -y, the scenes out in
+         * front of it
+         */
+        for (size_t j = 0; j < N_SEGS; ++j)
+        {
+            const viewseg_t* seg = scenes + i * N_SEGS + j;
+
+            *(src_x + j) = seg->x0; *(src_y + j) = -seg->z0;
+            *(dst_x + j) = seg->x1; *(dst_y + j) = -seg->z1;
+        }
+
+        for (size_t j = 0; j < n_cameras; ++j)
+        {
+            const sbcamera_t pose = {
+                Random(-64, 64), Random(-64, 64), Random(-0.3f, 0.3f)
+            };
+
+            *(poses + j) = pose;
+        }
+
+        for (size_t j = 0; j < n_cameras; ++j)
+        {
+            const double start = Now();
+            sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR,
+                                         MAX_DEPTH);
+
+            SB_ProjectMany(sbuffer, poses + j, src_x, src_y, dst_x, dst_y,
+                           N_SEGS, projection);
+            *project += Now() - start;
+            *pushed += SB_PushMany(sbuffer, projection, ids, colors);
+            SB_Destroy(sbuffer);
+            *total += Now() - start;
+        }
+
+        const double start = Now();
+
+        SB_ProjectCameras(cameras, poses, src_x, src_y, dst_x, dst_y, N_SEGS);
+        *(project + 1) += Now() - start;
+        *(pushed + 1) += SB_PushCameras(cameras, ids, colors);
+        *(total + 1) += Now() - start;
+    }
+
+    for (int k = 0; k < 2; ++k)
+        printf("[bench] %zu cameras (%s): %.1f ns/camera projecting, "
+               "%.1f ns/camera in all, %.1f segments pushed per camera\n",
+               n_cameras, k ? "all at once" : "one by one",
+               *(project + k) / (n_scenes * n_cameras) * 1e9,
+               *(total + k) / (n_scenes * n_cameras) * 1e9,
+               (double)*(pushed + k) / (n_scenes * n_cameras));
+
+    SB_DestroyProjection(projection);
+    SB_DestroyCameras(cameras);
+}
+
+//
+// PushViews
+// Look at each of the scenes through a rig of `n_views` views a few units
+// apart, each turned a little some other way, as the eyes of a stereo rig or
+// the players of a split-screen game would be -- projecting and pushing for
+// each view on its own, and then for all of them at once. Report how long each
+// took per view, and how many segments made it into the buffers.
+//
+static void PushViews (const viewseg_t* scenes, int n_views)
+{
+    float src_x[N_SEGS], src_y[N_SEGS], dst_x[N_SEGS], dst_y[N_SEGS];
+    byte_t ids[N_SEGS];
+    int colors[N_SEGS];
+    sbcamera_t poses[SB_MAX_VIEWS];
+    double total[2] = { 0 };
+    size_t pushed[2] = { 0 };
+    sbviews_t* views = SB_InitViews(n_views, SCREEN_HALFWIDTH << 1, Z_NEAR,
+                                    MAX_DEPTH, N_SEGS);
+    sbprojection_t* projection = SB_InitProjection(N_SEGS);
+
+    for (size_t j = 0; j < N_SEGS; ++j)
+    {
+        *(ids + j) = j;
+        *(colors + j) = j;
+    }
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+    {
+        /* the rig sits at the origin looking toward -y, the same as the eye
+         * the scenes were made for
+         */
+        const sbcamera_t rig = { 0, 0, 0 };
+
+        for (size_t j = 0; j < N_SEGS; ++j)
+        {
+            const viewseg_t* seg = scenes + i * N_SEGS + j;
+
+            *(src_x + j) = seg->x0; *(src_y + j) = -seg->z0;
+            *(dst_x + j) = seg->x1; *(dst_y + j) = -seg->z1;
+        }
+
+        for (int v = 0; v < n_views; ++v)
+        {
+            const sbcamera_t pose = {
+                Random(-4, 4), Random(-4, 4), Random(-0.05f, 0.05f)
+            };
+
+            *(poses + v) = pose;
+        }
+
+        const double start = Now();
+
+        for (int v = 0; v < n_views; ++v)
+        {
+            sbuffer_t* sbuffer = *(views->buffers + v);
+
+            SB_Empty(sbuffer);
+            SB_ProjectMany(sbuffer, poses + v, src_x, src_y, dst_x, dst_y,
+                           N_SEGS, projection);
+            *pushed += SB_PushMany(sbuffer, projection, ids, colors);
+        }
+
+        const double middle = Now();
+
+        SB_ProjectViews(views, &rig, poses, src_x, src_y, dst_x, dst_y,
+                        N_SEGS);
+        *(pushed + 1) += SB_PushViews(views, ids, colors);
+        *total += middle - start;
+        *(total + 1) += Now() - middle;
+    }
+
+    for (int k = 0; k < 2; ++k)
+        printf("[bench] %d views (%s): %.1f ns/view, "
+               "%.1f segments pushed per view\n",
+               n_views, k ? "all at once" : "one by one",
+               *(total + k) / (N_SCENES * n_views) * 1e9,
+               (double)*(pushed + k) / (N_SCENES * n_views));
+
+    SB_DestroyProjection(projection);
+    SB_DestroyViews(views);
+}
+
+//
+// TurnCylindrical
+// Turn a camera in place over each of the first few scenes, a little every
+// frame, with the view projected onto a cylindrical buffer -- emptying the
+// buffer out and pushing everything on every frame, and then turning the
+// buffer along with the camera and pushing only onto the stretch each turn
+// exposes. Report how long a frame took, and how many segments made it into
+// the buffer per frame.
+//
+static void TurnCylindrical (const viewseg_t* scenes)
+{
+    const size_t n_scenes = 8, n_frames = 64;
+    const int size = SCREEN_HALFWIDTH << 1;
+    const float step = 0.01f;
+    float vx0[N_SEGS], vz0[N_SEGS], vx1[N_SEGS], vz1[N_SEGS];
+    double total[2] = { 0 };
+    size_t pushed[2] = { 0 };
+    sbuffer_t* sbuffer = SB_InitCylindrical(size, size / 2.5f, MAX_DEPTH);
+
+    for (int k = 0; k < 2; ++k)
+    {
+        for (size_t i = 0; i < n_scenes; ++i)
+        {
+            const viewseg_t* scene = scenes + i * N_SEGS;
+
+            SB_ClearCylindrical(sbuffer);
+
+            for (size_t f = 0; f < n_frames; ++f)
+            {
+                const float angle = step * f;
+                const float c = cosf(angle), s = sinf(angle);
+                float x0 = 0, x1 = size;
+
+                /* the scene as seen by the camera turned by `angle` */
+                for (size_t j = 0; j < N_SEGS; ++j)
+                {
+                    const viewseg_t* seg = scene + j;
+
+                    *(vx0 + j) = seg->x0 * c - seg->z0 * s;
+                    *(vz0 + j) = seg->z0 * c + seg->x0 * s;
+                    *(vx1 + j) = seg->x1 * c - seg->z1 * s;
+                    *(vz1 + j) = seg->z1 * c + seg->x1 * s;
+                }
+
+                const double start = Now();
+                int exposed = 1;
+
+                if (!k) SB_ClearCylindrical(sbuffer);
+                else if (f) exposed = SB_Turn(sbuffer, step, &x0, &x1);
+
+                if (exposed)
+                {
+                    SB_PushClipWindow(sbuffer, x0, x1);
+
+                    for (size_t j = 0; j < N_SEGS; ++j)
+                        *(pushed + k) +=
+                            !SB_PushCylindrical(sbuffer,
+                                                *(vx0 + j), *(vz0 + j),
+                                                *(vx1 + j), *(vz1 + j),
+                                                j, j);
+
+                    SB_PopClipWindow(sbuffer);
+                }
+
+                *(total + k) += Now() - start;
+            }
+        }
+    }
+
+    for (int k = 0; k < 2; ++k)
+        printf("[bench] cylindrical (%s): %.1f ns/frame, "
+               "%.1f segments pushed per frame\n",
+               k ? "turned" : "rebuilt",
+               *(total + k) / (n_scenes * n_frames) * 1e9,
+               (double)*(pushed + k) / (n_scenes * n_frames));
+
+    SB_Destroy(sbuffer);
+}
+
+int main ()
+{
+    viewseg_t* scenes = malloc(N_SCENES * N_SEGS * sizeof(viewseg_t));
+    viewseg_t* clip_scenes = malloc(N_SCENES * N_SEGS * sizeof(viewseg_t));
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+        GenerateScene(scenes + i * N_SEGS, N_SEGS);
+
+    /* the very same scenes in clip space -- see `SB_PushHomogeneous` */
+    for (size_t i = 0; i < N_SCENES * N_SEGS; ++i)
+    {
+        const viewseg_t seg = *(scenes + i);
+        const viewseg_t clip_seg = {
+            Z_NEAR * seg.x0 + SCREEN_HALFWIDTH * seg.z0, seg.z0,
+            Z_NEAR * seg.x1 + SCREEN_HALFWIDTH * seg.z1, seg.z1
+        };
+        *(clip_scenes + i) = clip_seg;
+    }
+
+    PushScenes(scenes, 0, 0);
+    PushScenes(clip_scenes, 0xff, 0);
+    PushScenes(scenes, 0, 0xff);
+
+    /* a scene for each density, as dense as the densest one -- sparser ones
+     * are made up of the first so many segments of it
+     */
+    const size_t n_segs = 2048;
+    viewseg_t* dense_scenes = malloc(N_SCENES * n_segs * sizeof(viewseg_t));
+
+    for (size_t i = 0; i < N_SCENES; ++i)
+        GenerateScene(dense_scenes + i * n_segs, n_segs);
+
+    PushDensities(dense_scenes, n_segs);
+    PushWalls(scenes, WALLS_ROW_BY_ROW);
+    PushWalls(scenes, WALLS_LOCKSTEP);
+    PushWalls(scenes, WALLS_COHERENT);
+    PushWalls(scenes, WALLS_INTERPOLATED);
+    PushColumnWalls(scenes);
+    PushPolar(scenes);
+    ProjectCameras(scenes);
+    PushViews(scenes, 2);
+    PushViews(scenes, 4);
+    TurnCylindrical(scenes);
+    PushLights(dense_scenes, n_segs, 1);
+    PushLights(dense_scenes, n_segs, 4);
+    SeeAgents(dense_scenes, n_segs);
+
+    free(scenes);
+    free(clip_scenes);
+    free(dense_scenes);
+
+    return 0;
+}
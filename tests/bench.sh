@@ -0,0 +1,20 @@
+#!/bin/bash
+
+#  tests/bench.sh
+#  s-buffer
+#
+#  Created by agent on 2026-10-18.
+#
+#  SYNOPSIS:
+#      Builds the benchmarks with optimizations on and runs them -- under
+#      `perf stat` if it is available, so the branch misses are reported too.
+
+cd "$(dirname "$0")"
+
+gcc -O2 -o ./bench ./bench.c -I.. -lm -pthread || exit 1
+
+if command -v perf > /dev/null; then
+    perf stat -e instructions,branches,branch-misses ./bench
+else
+    ./bench
+fi
@@ -9,14 +9,14 @@ TEST_ROOT="$(pwd -P)"
 # ==============================================================================
 cd "$TEST_ROOT/.."
 
-./build.sh -d
+./build.sh -d || exit 1
 
 # ==============================================================================
 # build the test suite
 # ==============================================================================
 cd "$TEST_ROOT"
 
-gcc -o ./test ./test.c -I.. -L../dist -lsbuffer -g
+gcc -o ./test ./test.c -I.. -L../dist -lsbuffer -lm -g || exit 1
 
 # ==============================================================================
 # run the test suite
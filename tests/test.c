@@ -9,17 +9,24 @@
  */
 
 #include <stdio.h>
+#include <math.h>
+#include <string.h>
 #include <unistd.h>
 #include <sys/wait.h>
 
 #include "shared/s_helpers.h"
 #include "shared/s_prepop.h"
+#include "shared/s_bsp.h"
 #define S_BUFFER_DEFS_ONLY
 #include "s_buffer.h"
 
 #define SCREEN_HALFWIDTH 400
 #define SCREEN_HEIGHT 800
 #define Z_NEAR 96
+#define ROWS 64
+#define INTERPOLATION_ERROR 0.05f
+#define COLUMN_ERROR 0.002f
+#define LIGHTS 9
 
 static void PushSpans (sbuffer_t* sbuffer, const test_case_t* tc)
 {
@@ -62,6 +69,1757 @@ static void PushSpans (sbuffer_t* sbuffer, const test_case_t* tc)
     }
 }
 
+static void
+CoverageBruteForce
+( const sbuffer_t* sbuffer,
+  const span_t*    span,
+  float  x0, float x1,
+  float* cover,
+  float* w_far )
+{
+    if (!span) return;
+
+    const float lo = SB_MAX(span->x0, x0), hi = SB_MIN(span->x1, x1);
+
+    if (hi > lo)
+    {
+        const sbprim_t* prim = SB_PRIM(sbuffer, span);
+        const float w_lo = SB_PRIM_W(prim, lo), w_hi = SB_PRIM_W(prim, hi);
+        *cover += hi - lo;
+        *w_far = SB_MIN(*w_far, SB_MIN(w_lo, w_hi));
+    }
+
+    CoverageBruteForce(sbuffer, span->prev, x0, x1, cover, w_far);
+    CoverageBruteForce(sbuffer, span->next, x0, x1, cover, w_far);
+}
+
+//
+// VerifyCoverage
+// Cross-check `SB_Coverage` against summing up every span in the buffer, over
+// a sweep of ranges of varying widths.
+//
+static int VerifyCoverage (const sbuffer_t* sbuffer)
+{
+    const int widths[4] = { 1, 48, 320, SCREEN_HALFWIDTH << 1 };
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        for (int x = -16; x < (SCREEN_HALFWIDTH << 1); x += 37)
+        {
+            const float x0 = x, x1 = x + *(widths + i);
+            const float lo = SB_MAX(x0, 0);
+            const float hi = SB_MIN(x1, SCREEN_HALFWIDTH << 1);
+            float covered, max_z, cover = 0, w_far = 1e30f;
+
+            SB_Coverage(sbuffer, x0, x1, &covered, &max_z);
+            CoverageBruteForce(sbuffer, sbuffer->root, lo, hi, &cover, &w_far);
+
+            if (fabsf(covered - cover / (hi - lo)) > 1e-3f) return 0;
+            if (cover > 0 && fabsf(max_z - 1 / w_far) > 1e-2f) return 0;
+        }
+    }
+
+    return 1;
+}
+
+static void
+RasterizeIds
+( const sbuffer_t* sbuffer,
+  const span_t*    span,
+  byte_t*          out )
+{
+    if (!span) return;
+
+    const int X0 = ceil(span->x0 - 0.5f), X1 = ceil(span->x1 - 0.5f);
+    for (int x = X0; x < X1; ++x) *(out + x) = SB_PRIM(sbuffer, span)->id;
+
+    RasterizeIds(sbuffer, span->prev, out);
+    RasterizeIds(sbuffer, span->next, out);
+}
+
+static void RasterizeBucketIds (const sbuffer_t* sbuffer, byte_t* out)
+{
+    for (int i = 0; i < sbuffer->buckets_count; ++i)
+    {
+        const sbbucket_t* bucket = sbuffer->buckets + i;
+
+        for (int j = 0; j < bucket->count; ++j)
+        {
+            const sbentry_t* span = bucket->spans + j;
+            const int X0 = ceil(span->x0 - 0.5f), X1 = ceil(span->x1 - 0.5f);
+
+            for (int x = X0; x < X1; ++x)
+                *(out + x) = SB_PRIM(sbuffer, span)->id;
+        }
+    }
+}
+
+//
+// CountMismatches
+// How many pixels `actual` covers with another id than `expected` does, spans
+// kept either in a tree or in x-buckets. How many pixels `expected` covers at
+// all goes into `covered`, unless it is null.
+//
+static
+int
+CountMismatches
+( const sbuffer_t* expected,
+  const sbuffer_t* actual,
+  int*             covered )
+{
+    const int size = expected->size;
+    byte_t lhs[size], rhs[size];
+    int mismatches = 0;
+
+    memset(lhs, 0, size);
+    memset(rhs, 0, size);
+
+    if (expected->buckets) RasterizeBucketIds(expected, lhs);
+    else RasterizeIds(expected, expected->root, lhs);
+
+    if (actual->buckets) RasterizeBucketIds(actual, rhs);
+    else RasterizeIds(actual, actual->root, rhs);
+
+    for (int x = 0; x < size; ++x)
+    {
+        mismatches += *(lhs + x) != *(rhs + x);
+        if (covered) *covered += !!*(lhs + x);
+    }
+
+    return mismatches;
+}
+
+//
+// VerifyClipWindow
+// Push the test case through a portal-like clip window. Nothing should leak
+// outside of it, and inside of it, nothing should be dropped or shifted next
+// to what pushing without a window leaves there.
+//
+static int VerifyClipWindow (const sbuffer_t* reference, const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const int left = SCREEN_HALFWIDTH >> 1, right = SCREEN_HALFWIDTH + left;
+    sbuffer_t* sbuffer = SB_Init(size, Z_NEAR, 10);
+    byte_t expected[size], actual[size];
+    float covered_left, covered_right, max_z;
+    int mismatches = 0;
+
+    SB_PushClipWindow(sbuffer, left, right);
+    PushSpans(sbuffer, tc);
+    SB_PopClipWindow(sbuffer);
+
+    SB_Coverage(sbuffer, 0, left, &covered_left, &max_z);
+    SB_Coverage(sbuffer, right, size, &covered_right, &max_z);
+
+    memset(expected, 0, size);
+    memset(actual, 0, size);
+    RasterizeIds(reference, reference->root, expected);
+    RasterizeIds(sbuffer, sbuffer->root, actual);
+    for (int x = left; x < right; ++x)
+        mismatches += *(expected + x) != *(actual + x);
+
+    SB_Destroy(sbuffer);
+
+    return covered_left == 0 && covered_right == 0 && !mismatches;
+}
+
+//
+// VerifyPushView
+// Push the test case in view space, leaving the projection onto the screen to
+// the buffer. It should come out just the way projecting each segment by hand
+// and pushing it in screen space does.
+//
+static int VerifyPushView (const sbuffer_t* reference, const test_case_t* tc)
+{
+    sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 10);
+    byte_t ID = 65;
+
+    for (size_t i = 0; i < tc->segs_count; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        SB_PushView(sbuffer,
+                    seg.src.x - SCREEN_HALFWIDTH, SCREEN_HEIGHT - seg.src.y,
+                    seg.dst.x - SCREEN_HALFWIDTH, SCREEN_HEIGHT - seg.dst.y,
+                    ID++,
+                    seg.color);
+    }
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
+//
+// VerifyBsp
+// Render the test case front-to-back through a BSP tree. The order segments go
+// in should make no difference to which of them end up in sight.
+//
+static int VerifyBsp (const sbuffer_t* reference, const test_case_t* tc)
+{
+    sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 10);
+    bspnode_t* bsp = S_BuildBsp(tc->segs, tc->segs_count, 65);
+
+    S_TraverseBsp(sbuffer, bsp, SCREEN_HALFWIDTH, SCREEN_HEIGHT);
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+
+    S_DestroyBsp(bsp);
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
+//
+// VerifyProjectMany
+// Project the test case in bulk and push it in one go. Culling, clipping and
+// dividing by depth all at once, ahead of pushing, should cost no precision.
+//
+static int VerifyProjectMany (const sbuffer_t* reference, const test_case_t* tc)
+{
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 10);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    byte_t ids[tc->segs_count];
+    int colors[tc->segs_count];
+
+    for (size_t i = 0; i < tc->segs_count; ++i)
+    {
+        *(ids + i) = 65 + i;
+        *(colors + i) = (tc->segs + i)->color;
+    }
+
+    S_ProjectSegs(sbuffer, &camera, tc->segs, tc->segs_count, projection);
+    SB_PushMany(sbuffer, projection, ids, colors);
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+
+    SB_DestroyProjection(projection);
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
+//
+// VerifyHomogeneous
+// Push the test case in clip space, leaving the divide by depth to the buffer.
+// Where the divide happens should not move an edge by as much as a pixel.
+//
+static int VerifyHomogeneous (const sbuffer_t* reference, const test_case_t* tc)
+{
+    sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 10);
+    byte_t ID = 65;
+
+    for (size_t i = 0; i < tc->segs_count; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+        const float x0 = seg.src.x - SCREEN_HALFWIDTH;
+        const float z0 = SCREEN_HEIGHT - seg.src.y;
+        const float x1 = seg.dst.x - SCREEN_HALFWIDTH;
+        const float z1 = SCREEN_HEIGHT - seg.dst.y;
+
+        SB_PushHomogeneous(sbuffer,
+                           Z_NEAR * x0 + SCREEN_HALFWIDTH * z0, z0,
+                           Z_NEAR * x1 + SCREEN_HALFWIDTH * z1, z1,
+                           ID++,
+                           seg.color);
+    }
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
+//
+// VerifyBuckets
+// Push the test case onto the x-bucket backend. Spans split up across buckets
+// should hide what spans kept in a tree do, and add up to the same coverage.
+//
+static int VerifyBuckets (const sbuffer_t* reference, const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    sbuffer_t* sbuffer = SB_InitBuckets(size, Z_NEAR, 5);
+    int ok = 1;
+
+    PushSpans(sbuffer, tc);
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+
+    for (int x = 0; x < size; x += 37)
+    {
+        float covered, max_z, expected_covered, expected_max_z;
+
+        SB_Coverage(sbuffer, x, x + 48, &covered, &max_z);
+        SB_Coverage(reference, x, x + 48, &expected_covered, &expected_max_z);
+
+        ok &= fabsf(covered - expected_covered) < 1e-3f;
+        ok &= fabsf(max_z - expected_max_z) < 1e-2f;
+    }
+
+    SB_Destroy(sbuffer);
+
+    return ok && !mismatches;
+}
+
+//
+// VerifyBatch
+// Push the test case in a batch, with rebalancing deferred until its end. The
+// tree may grow lopsided in the meantime, but not lose or misplace any spans;
+// debug builds check that it is back in balance once the batch ends.
+//
+static int VerifyBatch (const sbuffer_t* reference, const test_case_t* tc)
+{
+    sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 16);
+
+    SB_BeginBatch(sbuffer, 6);
+    PushSpans(sbuffer, tc);
+    SB_EndBatch(sbuffer);
+
+    const int mismatches = CountMismatches(reference, sbuffer, 0);
+    const int coverage_ok = VerifyCoverage(sbuffer);
+    SB_Destroy(sbuffer);
+
+    return coverage_ok && !mismatches;
+}
+
+//
+// VerifyRows
+// Raise a wall of varying height out of each segment of the test case, and
+// push them onto a stack of rows as polygons. Make sure it resolves to the very
+// same picture as scan-converting each wall and pushing it row by row does.
+//
+static int VerifyRows (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbrows_t* rows = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbrows_t* reference = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    int mismatches = 0;
+
+    S_ProjectSegs(*rows->rows, &camera, tc->segs, tc->segs_count, projection);
+
+    for (size_t i = 0; i < projection->count; ++i)
+    {
+        const byte_t id = 65 + *(projection->index + i);
+        const float x0 = *(projection->x0 + i), x1 = *(projection->x1 + i);
+        const float w0 = *(projection->w0 + i), w1 = *(projection->w1 + i);
+        /* walls stand on the floor, and grow taller every now and then */
+        const float height = Z_NEAR * (16 + (id % 3) * 24);
+        const float floor = Z_NEAR * 32;
+        const float x[4] = { x0, x1, x1, x0 };
+        const float y[4] = { ROWS / 2 + (floor - height) * w0,
+                             ROWS / 2 + (floor - height) * w1,
+                             ROWS / 2 + floor * w1,
+                             ROWS / 2 + floor * w0 };
+        const float w[4] = { w0, w1, w1, w0 };
+
+        SB_PushPolygon(rows, x, y, w, 4, id, 0);
+
+        for (int row = 0; row < ROWS; ++row)
+        {
+            /* the center of the row lies under the top edge, and above the
+             * bottom one: `k * w(x) <= c` for both `(k, c)` below
+             */
+            const float c = row + 0.5f - ROWS / 2;
+            const float k[2] = { floor - height, -floor }, cs[2] = { c, -c };
+            const float dw = (w1 - w0) / (x1 - x0);
+            float lo = SB_MAX(x0, 0), hi = SB_MIN(x1, size);
+
+            for (int j = 0; j < 2; ++j)
+            {
+                const float p = *(cs + j) - *(k + j) * w0, q = -*(k + j) * dw;
+
+                if (q > 0) lo = SB_MAX(lo, x0 - p / q);
+                else if (q < 0) hi = SB_MIN(hi, x0 - p / q);
+                else if (p < 0) hi = lo;
+            }
+
+            if (hi > lo)
+                SB_Push(*(reference->rows + row),
+                        lo, hi,
+                        w0 + (lo - x0) * dw, w0 + (hi - x0) * dw,
+                        id,
+                        0);
+        }
+    }
+
+    for (int row = 0; row < ROWS; ++row)
+        mismatches += CountMismatches(*(reference->rows + row),
+                                      *(rows->rows + row),
+                                      0);
+
+    SB_DestroyProjection(projection);
+    SB_DestroyRows(reference);
+    SB_DestroyRows(rows);
+
+    return !mismatches;
+}
+
+//
+// RaiseWalls
+// Raise the walls of `VerifyRows` out of each projected segment, as polygons
+// with four vertices each -- `x`, `y` and `w` have room for all of them.
+//
+static
+void
+RaiseWalls
+( const sbprojection_t* projection,
+  float* x, float* y,
+  float* w,
+  sbpolygon_t* out )
+{
+    for (size_t i = 0; i < projection->count; ++i)
+    {
+        const byte_t id = 65 + *(projection->index + i);
+        const float x0 = *(projection->x0 + i), x1 = *(projection->x1 + i);
+        const float w0 = *(projection->w0 + i), w1 = *(projection->w1 + i);
+        const float height = Z_NEAR * (16 + (id % 3) * 24);
+        const float floor = Z_NEAR * 32;
+        float* wall_x = x + (i << 2);
+        float* wall_y = y + (i << 2);
+        float* wall_w = w + (i << 2);
+        const sbpolygon_t polygon = { wall_x, wall_y, wall_w, 4, id, 0 };
+
+        *wall_x = *(wall_x + 3) = x0;
+        *(wall_x + 1) = *(wall_x + 2) = x1;
+        *wall_y = ROWS / 2 + (floor - height) * w0;
+        *(wall_y + 1) = ROWS / 2 + (floor - height) * w1;
+        *(wall_y + 2) = ROWS / 2 + floor * w1;
+        *(wall_y + 3) = ROWS / 2 + floor * w0;
+        *wall_w = *(wall_w + 3) = w0;
+        *(wall_w + 1) = *(wall_w + 2) = w1;
+        *(out + i) = polygon;
+    }
+}
+
+//
+// VerifyCoherent
+// Raise the same walls as `VerifyRows` does, and push them onto a stack of rows
+// all at once, each row derived from the previous one. Make sure it resolves to
+// the very same picture as pushing them one polygon at a time onto rows of the
+// x-bucket backend does, as that is how overlaps are resolved either way.
+//
+static int VerifyCoherent (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbrows_t* rows = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbrows_t* reference = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    int mismatches = 0;
+
+    for (int row = 0; row < ROWS; ++row)
+    {
+        SB_Destroy(*(reference->rows + row));
+        *(reference->rows + row) = SB_InitBuckets(size, Z_NEAR, 5);
+    }
+
+    S_ProjectSegs(*rows->rows, &camera, tc->segs, tc->segs_count, projection);
+
+    const size_t count = projection->count;
+    float x[(count << 2) + 1], y[(count << 2) + 1], w[(count << 2) + 1];
+    sbpolygon_t polygons[count + 1];
+
+    RaiseWalls(projection, x, y, w, polygons);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+
+        SB_PushPolygon(reference,
+                       polygon->x, polygon->y,
+                       polygon->w,
+                       4,
+                       polygon->id,
+                       0);
+    }
+
+    SB_PushCoherent(rows, polygons, count);
+
+    for (int row = 0; row < ROWS; ++row)
+        mismatches += CountMismatches(*(reference->rows + row),
+                                      *(rows->rows + row),
+                                      0);
+
+    SB_DestroyProjection(projection);
+    SB_DestroyRows(reference);
+    SB_DestroyRows(rows);
+
+    return !mismatches;
+}
+
+//
+// VerifyInterpolated
+// Raise the walls of `VerifyRows`, and push them onto every few rows only,
+// interpolating the rest. Make sure the picture is no farther off from pushing
+// them onto every row than `INTERPOLATION_ERROR` of the pixels covered, and
+// that pushing onto every row matches it exactly.
+//
+static int VerifyInterpolated (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbrows_t* reference = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    int ok = 1;
+
+    S_ProjectSegs(*reference->rows, &camera,
+                  tc->segs, tc->segs_count,
+                  projection);
+
+    const size_t count = projection->count;
+    float x[(count << 2) + 1], y[(count << 2) + 1], w[(count << 2) + 1];
+    sbpolygon_t polygons[count + 1];
+
+    RaiseWalls(projection, x, y, w, polygons);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+
+        SB_PushPolygon(reference,
+                       polygon->x, polygon->y,
+                       polygon->w,
+                       4,
+                       polygon->id,
+                       0);
+    }
+
+    for (int stride = 1; stride <= 8; stride <<= 1)
+    {
+        sbrows_t* rows = SB_InitRows(size, ROWS, Z_NEAR, 16);
+        const size_t pushed =
+            SB_PushInterpolated(rows, polygons, count, stride);
+        int mismatches = 0, covered = 0;
+
+        for (int row = 0; row < ROWS; ++row)
+            mismatches += CountMismatches(*(reference->rows + row),
+                                          *(rows->rows + row),
+                                          &covered);
+
+        /* each row pushed onto for real, and no more than that */
+        if (stride == 1) ok &= !mismatches && pushed == ROWS;
+        else ok &= mismatches <= covered * INTERPOLATION_ERROR &&
+                   pushed <= ROWS;
+
+        SB_DestroyRows(rows);
+    }
+
+    SB_DestroyProjection(projection);
+    SB_DestroyRows(reference);
+
+    return ok;
+}
+
+//
+// VerifyColumns
+// Raise the walls of `VerifyRows`, and push them onto a row of column buffers
+// one slice at a time. Make sure it resolves to the same picture as pushing
+// them as polygons onto rows of the x-bucket backend, column by column -- but
+// for no more than `COLUMN_ERROR` of the pixels covered, the edges and depths
+// being interpolated along the other axis, and rounding off differently.
+//
+static int VerifyColumns (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbcolumns_t* columns = SB_InitColumns(size, ROWS, Z_NEAR, 16);
+    sbrows_t* reference = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    int mismatches = 0, covered = 0;
+
+    for (int row = 0; row < ROWS; ++row)
+    {
+        SB_Destroy(*(reference->rows + row));
+        *(reference->rows + row) = SB_InitBuckets(size, Z_NEAR, 5);
+    }
+
+    S_ProjectSegs(*columns->columns, &camera,
+                  tc->segs, tc->segs_count,
+                  projection);
+
+    const size_t count = projection->count;
+    float x[(count << 2) + 1], y[(count << 2) + 1], w[(count << 2) + 1];
+    sbpolygon_t polygons[count + 1];
+    byte_t expected[ROWS][size];
+
+    RaiseWalls(projection, x, y, w, polygons);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+
+        SB_PushPolygon(reference,
+                       polygon->x, polygon->y,
+                       polygon->w,
+                       4,
+                       polygon->id,
+                       0);
+        SB_PushWall(columns,
+                    *polygon->x, *(polygon->x + 1),
+                    *polygon->y, *(polygon->y + 1),
+                    *(polygon->y + 3), *(polygon->y + 2),
+                    *polygon->w, *(polygon->w + 1),
+                    polygon->id,
+                    0);
+    }
+
+    for (int row = 0; row < ROWS; ++row)
+    {
+        for (int x = 0; x < size; ++x) *(*(expected + row) + x) = 0;
+        RasterizeBucketIds(*(reference->rows + row), *(expected + row));
+    }
+
+    for (int x = 0; x < size; ++x)
+    {
+        const sbuffer_t* column = *(columns->columns + x);
+        byte_t actual[ROWS];
+
+        for (int row = 0; row < ROWS; ++row) *(actual + row) = 0;
+        RasterizeIds(column, column->root, actual);
+        for (int row = 0; row < ROWS; ++row)
+        {
+            mismatches += *(*(expected + row) + x) != *(actual + row);
+            covered += !!*(*(expected + row) + x);
+        }
+    }
+
+    SB_DestroyProjection(projection);
+    SB_DestroyRows(reference);
+    SB_DestroyColumns(columns);
+
+    return mismatches <= covered * COLUMN_ERROR;
+}
+
+//
+// RayDistance
+// How far along the ray from `(x, y)` toward `(dx, dy)` it runs into the
+// segment from `(x0, y0)` to `(x1, y1)` -- negative if it misses the segment.
+//
+static
+float
+RayDistance
+( float x,  float y,
+  float dx, float dy,
+  float x0, float y0,
+  float x1, float y1 )
+{
+    const float ex = x1 - x0, ey = y1 - y0;
+    const float denom = dx * ey - dy * ex;
+
+    if (fabsf(denom) < 1e-9f) return -1;
+
+    const float t = ((x0 - x) * ey - (y0 - y) * ex) / denom;
+    const float u = ((x0 - x) * dy - (y0 - y) * dx) / denom;
+
+    return t > 0 && u >= 0 && u <= 1 ? t : -1;
+}
+
+//
+// PolygonDistance
+// How far along the ray from `(x, y)` toward `(dx, dy)` it runs into the edges
+// of the polygon with `n` vertices `xs` and `ys` -- negative if it misses them.
+//
+static
+float
+PolygonDistance
+( const float* xs, const float* ys,
+  size_t n,
+  float  x,  float y,
+  float  dx, float dy )
+{
+    float distance = -1;
+
+    for (size_t j = 0; j < n; ++j)
+    {
+        const size_t k = (j + 1) % n;
+        const float t = RayDistance(x, y,
+                                    dx, dy,
+                                    *(xs + j), *(ys + j),
+                                    *(xs + k), *(ys + k));
+
+        if (t >= 0 && (distance < 0 || t < distance)) distance = t;
+    }
+
+    return distance;
+}
+
+//
+// VerifyPolar
+// Push the test case onto a polar buffer around the eye, along with a segment
+// straddling the seam at `2π` behind it. Cast rays all around, and make sure
+// both the distances queried and the visibility polygon agree with running
+// each ray against every segment -- and the square the polygon is boxed in by.
+//
+static int VerifyPolar (const test_case_t* tc)
+{
+    const float eye_x = SCREEN_HALFWIDTH, eye_y = SCREEN_HEIGHT;
+    const float range = SCREEN_HEIGHT << 2, corner = range * sqrtf(2);
+    const size_t count = tc->segs_count + 1;
+    sbpolar_t* polar = SB_InitPolar(eye_x, eye_y, 512, 1, 16);
+    float segs[count + 4][4];
+    int mismatches = 0;
+
+    for (size_t i = 0; i < tc->segs_count; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+        float* out = *(segs + i);
+
+        *out = seg.src.x; *(out + 1) = seg.src.y;
+        *(out + 2) = seg.dst.x; *(out + 3) = seg.dst.y;
+    }
+
+    *(*(segs + count - 1)) = eye_x + 200;
+    *(*(segs + count - 1) + 1) = eye_y - 100;
+    *(*(segs + count - 1) + 2) = eye_x + 200;
+    *(*(segs + count - 1) + 3) = eye_y + 100;
+
+    /* the square left uncovered parts of the polygon are walled off by */
+    for (int i = 0; i < 4; ++i)
+    {
+        float* out = *(segs + count + i);
+
+        *out = eye_x + corner * cosf(i * M_PI / 2);
+        *(out + 1) = eye_y + corner * sinf(i * M_PI / 2);
+        *(out + 2) = eye_x + corner * cosf((i + 1) * M_PI / 2);
+        *(out + 3) = eye_y + corner * sinf((i + 1) * M_PI / 2);
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float* seg = *(segs + i);
+        SB_PushPolar(polar,
+                     *seg, *(seg + 1),
+                     *(seg + 2), *(seg + 3),
+                     65 + i,
+                     0);
+    }
+
+    const size_t n = SB_VisibilityPolygon(polar, range, 0, 0);
+    float xs[n + 1], ys[n + 1];
+
+    if (SB_VisibilityPolygon(polar, range, xs, ys) != n) mismatches = 1;
+
+    for (int i = 0; i < 720; ++i)
+    {
+        const float angle = (i + 0.37f) * M_PI / 360;
+        const float dx = cosf(angle), dy = sinf(angle);
+        const float distance = SB_PolarDistance(polar, angle);
+        const float polygon = PolygonDistance(xs, ys, n, eye_x, eye_y, dx, dy);
+        float expected = -1, boxed = -1;
+
+        for (size_t j = 0; j < count + 4; ++j)
+        {
+            const float* seg = *(segs + j);
+            const float t = RayDistance(eye_x, eye_y,
+                                        dx, dy,
+                                        *seg, *(seg + 1),
+                                        *(seg + 2), *(seg + 3));
+
+            if (t < 0) continue;
+            if (j < count && (expected < 0 || t < expected)) expected = t;
+            if (boxed < 0 || t < boxed) boxed = t;
+        }
+
+        if ((expected < 0) != (distance < 0) ||
+            (expected >= 0 &&
+             fabsf(distance - expected) > expected * 1e-2f) ||
+            fabsf(polygon - boxed) > boxed * 1e-2f)
+            ++mismatches;
+    }
+
+    SB_DestroyPolar(polar);
+
+    return !mismatches;
+}
+
+//
+// VerifyLights
+// Light the test case up from a ring of lights around the eye, and the eye
+// itself, all at once over a few threads. Cast rays all around each light,
+// and make sure its polygon agrees with running each ray against every
+// segment -- and the square the polygon is boxed in and cut off by. The lights
+// should have pushed no more segments than there are for all of them.
+//
+static int VerifyLights (const test_case_t* tc)
+{
+    const float eye_x = SCREEN_HALFWIDTH, eye_y = SCREEN_HEIGHT;
+    const float range = SCREEN_HALFWIDTH, corner = range * sqrtf(2);
+    const size_t n = tc->segs_count, capacity = 1024;
+    float src_x[n + 1], src_y[n + 1], dst_x[n + 1], dst_y[n + 1];
+    float light_x[LIGHTS], light_y[LIGHTS];
+    float* poly_x = malloc(LIGHTS * capacity * sizeof(float));
+    float* poly_y = malloc(LIGHTS * capacity * sizeof(float));
+    size_t counts[LIGHTS];
+    int mismatches = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        *(src_x + i) = seg.src.x; *(src_y + i) = seg.src.y;
+        *(dst_x + i) = seg.dst.x; *(dst_y + i) = seg.dst.y;
+    }
+
+    for (int i = 0; i < LIGHTS; ++i)
+    {
+        const float angle = i * 2 * M_PI / (LIGHTS - 1);
+        const float radius = i ? 150 : 0;
+
+        *(light_x + i) = eye_x + radius * cosf(angle);
+        *(light_y + i) = eye_y - radius * sinf(angle);
+    }
+
+    sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, n, 64);
+    sblights_t lights = {
+        light_x, light_y, poly_x, poly_y, counts, LIGHTS, capacity
+    };
+    const size_t pushed = SB_LightMany(grid, &lights, range, 512, 0.1f, 16, 4);
+
+    for (int i = 0; i < LIGHTS; ++i)
+    {
+        const float lx = *(light_x + i), ly = *(light_y + i);
+        const float* xs = poly_x + i * capacity;
+        const float* ys = poly_y + i * capacity;
+
+        if (*(counts + i) > capacity) ++mismatches;
+
+        for (int j = 0; j < 360; ++j)
+        {
+            const float angle = (j + 0.37f) * M_PI / 180;
+            const float dx = cosf(angle), dy = sinf(angle);
+            const float polygon =
+                PolygonDistance(xs, ys, *(counts + i), lx, ly, dx, dy);
+            float expected = -1;
+
+            for (size_t k = 0; k < n + 4; ++k)
+            {
+                const int side = k - n;
+                const float t = k < n
+                    ? RayDistance(lx, ly,
+                                  dx, dy,
+                                  *(src_x + k), *(src_y + k),
+                                  *(dst_x + k), *(dst_y + k))
+                    : RayDistance(lx, ly,
+                                  dx, dy,
+                                  lx + corner * cosf(side * M_PI / 2),
+                                  ly + corner * sinf(side * M_PI / 2),
+                                  lx + corner * cosf((side + 1) * M_PI / 2),
+                                  ly + corner * sinf((side + 1) * M_PI / 2));
+
+                if (t >= 0 && (expected < 0 || t < expected)) expected = t;
+            }
+
+            mismatches += fabsf(polygon - expected) > expected * 1e-2f;
+        }
+    }
+
+    SB_DestroyGrid(grid);
+    free(poly_x);
+    free(poly_y);
+
+    return !mismatches && pushed <= n * LIGHTS;
+}
+
+//
+// SightLine
+// Whether `(tx, ty)` can be seen from `(x, y)` as far as `range` goes along the
+// axis of the face it falls on, running the line in between against each of
+// the `n` segments but `skip` -- the target turned by `turn` radians around the
+// viewer and pulled in by `scale`.
+//
+static
+int
+SightLine
+( const float* src_x, const float* src_y,
+  const float* dst_x, const float* dst_y,
+  size_t n, size_t skip,
+  float  range,
+  float  x,  float y,
+  float  tx, float ty,
+  float  turn, float scale )
+{
+    const float c = cosf(turn) * scale, s = sinf(turn) * scale;
+    const float dx = (tx - x) * c - (ty - y) * s;
+    const float dy = (tx - x) * s + (ty - y) * c;
+
+    if ((fabsf(dx) + fabsf(dy)) * M_SQRT1_2 > range) return 0;
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (k == skip) continue;
+
+        const float t = RayDistance(x, y,
+                                    dx, dy,
+                                    *(src_x + k), *(src_y + k),
+                                    *(dst_x + k), *(dst_y + k));
+
+        if (t >= 0 && t < 1) return 0;
+    }
+
+    return 1;
+}
+
+//
+// VerifySight
+// Have a ring of agents around the eye, and the eye itself, look at a square of
+// points around each of them, and at each segment of the test case. Make sure
+// they see what running each line of sight against every segment does, for
+// the points and for any of a few points along each segment -- unless nudging
+// the points by a hair would make it go either way -- both segment by segment
+// and gathered into bit sets. Asking again should build no buffers, and moving
+// one of the agents should build just its buffer.
+//
+static int VerifySight (const test_case_t* tc)
+{
+    const float eye_x = SCREEN_HALFWIDTH, eye_y = SCREEN_HEIGHT;
+    const float range = SCREEN_HALFWIDTH;
+    const float turns[3] = { -1e-2f, 0, 1e-2f };
+    const float scales[3] = { 0.98f, 1, 1.02f };
+    const size_t n = tc->segs_count, side = 24, points = side * side;
+    float src_x[n + 1], src_y[n + 1], dst_x[n + 1], dst_y[n + 1];
+    float agent_x[LIGHTS], agent_y[LIGHTS];
+    float* tx = malloc(LIGHTS * (points + n) * sizeof(float));
+    float* ty = malloc(LIGHTS * (points + n) * sizeof(float));
+    int* agents = malloc(LIGHTS * (points + n) * sizeof(int));
+    byte_t* out = malloc(LIGHTS * (points + n));
+    int mismatches = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        *(src_x + i) = seg.src.x; *(src_y + i) = seg.src.y;
+        *(dst_x + i) = seg.dst.x; *(dst_y + i) = seg.dst.y;
+    }
+
+    for (int i = 0; i < LIGHTS; ++i)
+    {
+        const float angle = i * 2 * M_PI / (LIGHTS - 1);
+        const float radius = i ? 150 : 0;
+
+        *(agent_x + i) = eye_x + radius * cosf(angle);
+        *(agent_y + i) = eye_y - radius * sinf(angle);
+
+        for (size_t j = 0; j < points; ++j)
+        {
+            *(agents + i * points + j) = i;
+            *(tx + i * points + j) =
+                *(agent_x + i) + range * (2 * (j % side + 0.37f) / side - 1);
+            *(ty + i * points + j) =
+                *(agent_y + i) + range * (2 * (j / side + 0.61f) / side - 1);
+        }
+    }
+
+    sbgrid_t* grid = SB_InitGrid(src_x, src_y, dst_x, dst_y, n, 64);
+    sbsight_t* sight = SB_InitSight(grid, LIGHTS, range, 512, 0.1f, 16);
+
+    SB_PlaceAgents(sight, agent_x, agent_y);
+
+    const size_t built =
+        SB_SeeMany(sight, agents, tx, ty, LIGHTS * points, out);
+
+    for (size_t i = 0; i < LIGHTS * points; ++i)
+    {
+        const int agent = *(agents + i);
+        int strict = 1, loose = 0;
+
+        for (int t = 0; t < 9; ++t)
+        {
+            const int seen = SightLine(src_x, src_y, dst_x, dst_y, n, n,
+                                       range,
+                                       *(agent_x + agent), *(agent_y + agent),
+                                       *(tx + i), *(ty + i),
+                                       *(turns + t % 3), *(scales + t / 3));
+
+            strict &= seen; loose |= seen;
+        }
+
+        mismatches += (strict && !*(out + i)) || (!loose && *(out + i));
+    }
+
+    /* each agent looks at each segment, which it is level with where it sees
+     * it
+     */
+    for (size_t i = 0; i < LIGHTS * n; ++i) *(agents + i) = i / n;
+
+    for (int i = 0; i < LIGHTS; ++i)
+    {
+        memcpy(tx + i * n, src_x, n * sizeof(float));
+        memcpy(ty + i * n, src_y, n * sizeof(float));
+    }
+
+    float* ex = malloc(LIGHTS * n * sizeof(float));
+    float* ey = malloc(LIGHTS * n * sizeof(float));
+
+    for (int i = 0; i < LIGHTS; ++i)
+    {
+        memcpy(ex + i * n, dst_x, n * sizeof(float));
+        memcpy(ey + i * n, dst_y, n * sizeof(float));
+    }
+
+    const size_t rebuilt =
+        SB_SeeSegments(sight, agents, tx, ty, ex, ey, LIGHTS * n, out);
+    const size_t bytes = (n + 7) >> 3;
+    byte_t* bits = calloc(LIGHTS * bytes, 1);
+
+    for (int i = 0; i < LIGHTS; ++i) SB_SeenBy(sight, i, bits + i * bytes);
+
+    for (size_t i = 0; i < LIGHTS * n; ++i)
+    {
+        const int agent = *(agents + i);
+        const size_t k = i % n;
+        int strict = 0, loose = 0;
+
+        /* only look closer when it takes a closer look to tell */
+        for (int j = 0; j < 512 && !(*(out + i) ? loose : strict);
+             j += *(out + i) ? 1 : 16)
+        {
+            const float u = (j + 0.5f) / 512;
+            const float px = *(src_x + k) + u * (*(dst_x + k) - *(src_x + k));
+            const float py = *(src_y + k) + u * (*(dst_y + k) - *(src_y + k));
+            int all = 1, any = 0;
+
+            for (int t = 0; t < 9; ++t)
+            {
+                const int seen = SightLine(src_x, src_y, dst_x, dst_y, n, k,
+                                           range,
+                                           *(agent_x + agent),
+                                           *(agent_y + agent),
+                                           px, py,
+                                           *(turns + t % 3), *(scales + t / 3));
+
+                all &= seen; any |= seen;
+            }
+
+            strict |= all; loose |= any;
+        }
+
+        const int marked = *(bits + agent * bytes + (k >> 3)) >> (k & 7) & 1;
+
+        mismatches += (strict && !*(out + i)) || (!loose && *(out + i));
+        mismatches += (strict && !marked) || (!loose && marked);
+    }
+
+    /* nobody moved, and then just the one agent did */
+    const size_t cached = SB_SeeMany(sight, agents, tx, ty, LIGHTS * n, out);
+
+    *(agent_x + 1) += 5;
+    SB_PlaceAgents(sight, agent_x, agent_y);
+
+    const size_t moved = SB_SeeMany(sight, agents, tx, ty, LIGHTS * n, out);
+
+    SB_DestroySight(sight);
+    SB_DestroyGrid(grid);
+    free(tx); free(ty); free(ex); free(ey); free(agents); free(out); free(bits);
+
+    return !mismatches &&
+           built == LIGHTS && !rebuilt && !cached && moved == 1;
+}
+
+//
+// VerifyShareRows
+// Raise the walls of `VerifyRows`, and have the rows that came out the same
+// share their buffers. Make sure they look just the same afterwards, and that
+// pushing onto one of the shared rows leaves the rest of them be -- the last row
+// of a run, as well as the middle one of a run of three or more followed by the
+// row above it. Pushed all at once, the walls should leave nothing but empty
+// rows left to share.
+//
+static int VerifyShareRows (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbrows_t* rows = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbrows_t* coherent = SB_InitRows(size, ROWS, Z_NEAR, 16);
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    int mismatches = 0;
+
+    S_ProjectSegs(*rows->rows, &camera, tc->segs, tc->segs_count, projection);
+
+    const size_t count = projection->count;
+    float x[(count << 2) + 1], y[(count << 2) + 1], w[(count << 2) + 1];
+    sbpolygon_t polygons[count + 1];
+    byte_t expected[ROWS][size], actual[size];
+
+    RaiseWalls(projection, x, y, w, polygons);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const sbpolygon_t* polygon = polygons + i;
+
+        SB_PushPolygon(rows,
+                       polygon->x, polygon->y,
+                       polygon->w,
+                       4,
+                       polygon->id,
+                       0);
+    }
+
+    for (int row = 0; row < ROWS; ++row)
+    {
+        const sbuffer_t* sbuffer = *(rows->rows + row);
+
+        for (int x = 0; x < size; ++x) *(*(expected + row) + x) = 0;
+        RasterizeIds(sbuffer, sbuffer->root, *(expected + row));
+    }
+
+    const size_t shared = SB_ShareRows(rows);
+    size_t sharing = 0;
+    int victim = -1, middle = -1;
+
+    for (int row = 1; row < ROWS; ++row)
+    {
+        if (*(rows->rows + row) != *(rows->rows + row - 1)) continue;
+
+        ++sharing;
+        victim = row;
+
+        if (middle < 0 && row + 1 < ROWS &&
+            *(rows->rows + row + 1) == *(rows->rows + row))
+            middle = row;
+    }
+
+    mismatches += !shared || shared != sharing;
+
+    /* pushing onto a shared row copies it first, and leaves the rows that
+     * still share the original next to one another
+     */
+    if (middle >= 0)
+    {
+        SB_Push(SB_Row(rows, middle), 0, size, 1, 1, 'Y', 0);
+        SB_Push(SB_Row(rows, middle - 1), 0, size, 1, 1, 'X', 0);
+    }
+
+    if (victim >= 0)
+        SB_Push(SB_Row(rows, victim), 0, size, 1, 1, 'Z', 0);
+
+    for (int row = 0; row < ROWS; ++row)
+    {
+        const sbuffer_t* sbuffer = *(rows->rows + row);
+
+        for (int x = 0; x < size; ++x) *(actual + x) = 0;
+        RasterizeIds(sbuffer, sbuffer->root, actual);
+
+        for (int x = 0; x < size; ++x)
+        {
+            const byte_t id = row == victim ? 'Z'
+                            : row == middle ? 'Y'
+                            : row == middle - 1 ? 'X'
+                            : *(*(expected + row) + x);
+            mismatches += *(actual + x) != id;
+        }
+    }
+
+    SB_PushCoherent(coherent, polygons, count);
+
+    /* ...already shared by `SB_PushCoherent` unless empty */
+    sharing = 0;
+    for (int row = 1; row < ROWS; ++row)
+        sharing += !(*(coherent->rows + row))->root &&
+                   !(*(coherent->rows + row - 1))->root;
+
+    mismatches += SB_ShareRows(coherent) != sharing;
+
+    SB_DestroyProjection(projection);
+    SB_DestroyRows(coherent);
+    SB_DestroyRows(rows);
+
+    return !mismatches;
+}
+
+//
+// SameProjection
+// Whether two projections hold the very same segments, down to the last bit.
+//
+static int SameProjection (const sbprojection_t* a, const sbprojection_t* b)
+{
+    const float* lhs[] = { a->x0, a->x1, a->w0, a->w1,
+                           a->vx0, a->vz0, a->vx1, a->vz1 };
+    const float* rhs[] = { b->x0, b->x1, b->w0, b->w1,
+                           b->vx0, b->vz0, b->vx1, b->vz1 };
+    const size_t count = b->count;
+    int ok = a->count == count;
+
+    for (size_t i = 0; ok && i < SB_PROJECTION_FLOATS; ++i)
+        ok &= !memcmp(*(lhs + i), *(rhs + i), count * sizeof(float));
+
+    return ok && !memcmp(a->index, b->index, count * sizeof(size_t));
+}
+
+//
+// VerifyDispatch
+// Project the test case with every instruction set the host supports, once
+// from a single camera and once from more cameras than fit in the widest set of
+// lanes, and make sure they all agree with the generic build down to the last
+// bit.
+//
+static int VerifyDispatch (const test_case_t* tc)
+{
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0.25f };
+    const int size = SCREEN_HALFWIDTH << 1, count = SB_WIDE_LANES + 3;
+    const size_t n = tc->segs_count;
+    float src_x[n + 1], src_y[n + 1], dst_x[n + 1], dst_y[n + 1];
+    sbcamera_t poses[count];
+    sbuffer_t* sbuffer = SB_Init(size, Z_NEAR, 10);
+    sbprojection_t* expected = SB_InitProjection(n);
+    sbprojection_t* actual = SB_InitProjection(n);
+    sbcameras_t* generic = SB_InitCameras(count, size, Z_NEAR, 10, n);
+    sbcameras_t* cameras = SB_InitCameras(count, size, Z_NEAR, 10, n);
+    const int isa = sbuffer->isa;
+    int ok = 1;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        *(src_x + i) = seg.src.x; *(src_y + i) = seg.src.y;
+        *(dst_x + i) = seg.dst.x; *(dst_y + i) = seg.dst.y;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sbcamera_t pose = {
+            SCREEN_HALFWIDTH + 40 * cosf(i), SCREEN_HEIGHT - 40 * sinf(i),
+            (i - count / 2) * 0.15f
+        };
+
+        *(poses + i) = pose;
+    }
+
+    sbuffer->isa = SB_ISA_GENERIC;
+    S_ProjectSegs(sbuffer, &camera, tc->segs, tc->segs_count, expected);
+
+    generic->isa = SB_ISA_GENERIC;
+    SB_ProjectCameras(generic, poses, src_x, src_y, dst_x, dst_y, n);
+
+    for (sbuffer->isa = SB_ISA_GENERIC + 1; sbuffer->isa <= isa; ++sbuffer->isa)
+    {
+        S_ProjectSegs(sbuffer, &camera, tc->segs, tc->segs_count, actual);
+        ok &= SameProjection(actual, expected);
+
+        cameras->isa = sbuffer->isa;
+        SB_ProjectCameras(cameras, poses, src_x, src_y, dst_x, dst_y, n);
+
+        for (int i = 0; i < count; ++i)
+            ok &= SameProjection(*(cameras->projections + i),
+                                 *(generic->projections + i));
+    }
+
+    SB_DestroyCameras(cameras);
+    SB_DestroyCameras(generic);
+    SB_DestroyProjection(expected);
+    SB_DestroyProjection(actual);
+    SB_Destroy(sbuffer);
+
+    return ok;
+}
+
+static void CollectSpans (const span_t* span, const span_t** out, size_t* n)
+{
+    if (!span) return;
+
+    CollectSpans(span->prev, out, n);
+    if (out) *(out + *n) = span;
+    ++*n;
+    CollectSpans(span->next, out, n);
+}
+
+//
+// VerifyIntersectMany
+// Intersect every segment of the test case with every span it resolved to in
+// bulk. Debug builds check the results against the scalar path bit-for-bit;
+// here, intersections are only checked to lie within both spans.
+//
+static int VerifyIntersectMany (const sbuffer_t* sbuffer, const test_case_t* tc)
+{
+    const sbcamera_t camera = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0 };
+    sbprojection_t* projection = SB_InitProjection(tc->segs_count);
+    size_t spans_count = 0;
+    int ok = 1;
+
+    CollectSpans(sbuffer->root, 0, &spans_count);
+    const span_t** spans = malloc((spans_count + 1) * sizeof(span_t*));
+    spans_count = 0;
+    CollectSpans(sbuffer->root, spans, &spans_count);
+    S_ProjectSegs(sbuffer, &camera, tc->segs, tc->segs_count, projection);
+
+    const size_t n = projection->count * spans_count;
+    float* floats = malloc(n * SB_PAIRS_FLOATS * sizeof(float));
+    float* arrays[SB_PAIRS_FLOATS];
+    byte_t* codes = malloc(n);
+    float* out = malloc(n * sizeof(float));
+    float* leftness = malloc(n * sizeof(float));
+
+    for (size_t i = 0; i < SB_PAIRS_FLOATS; ++i) *(arrays + i) = floats + i * n;
+
+    for (size_t i = 0, k = 0; i < projection->count; ++i)
+    {
+        for (size_t j = 0; j < spans_count; ++j, ++k)
+        {
+            const span_t* span = *(spans + j);
+            const sbprim_t* prim = SB_PRIM(sbuffer, span);
+            const float pair[SB_PAIRS_FLOATS] = {
+                *(projection->vx0 + i), *(projection->vz0 + i),
+                *(projection->vx1 + i), *(projection->vz1 + i),
+                *(projection->x0 + i), *(projection->x1 + i),
+                span->x0, SB_PRIM_W(prim, span->x0),
+                span->x1, SB_PRIM_W(prim, span->x1)
+            };
+
+            for (size_t l = 0; l < SB_PAIRS_FLOATS; ++l)
+                *(*(arrays + l) + k) = *(pair + l);
+        }
+    }
+
+    const sbpairs_t pairs = { *arrays, *(arrays + 1), *(arrays + 2),
+                              *(arrays + 3), *(arrays + 4), *(arrays + 5),
+                              *(arrays + 6), *(arrays + 7), *(arrays + 8),
+                              *(arrays + 9) };
+    SB_IntersectMany(sbuffer, &pairs, n, codes, out, leftness);
+
+    for (size_t k = 0; k < n; ++k)
+    {
+        if (*(codes + k) != SB_INTERSECTING) continue;
+
+        ok &= *(out + k) > *(pairs.u_x0 + k) && *(out + k) < *(pairs.u_x1 + k);
+        ok &= *(out + k) > *(pairs.v_x0 + k) && *(out + k) < *(pairs.v_x1 + k);
+    }
+
+    free(floats); free(codes); free(out); free(leftness); free(spans);
+    SB_DestroyProjection(projection);
+
+    return ok;
+}
+
+//
+// RasterizePrims
+// The primitive each pixel of the screen is covered by, zero if none -- spans
+// a cylindrical buffer has turned off of the screen are left out.
+//
+static void
+RasterizePrims
+( const sbuffer_t* sbuffer,
+  const span_t*    span,
+  const sbprim_t** out )
+{
+    if (!span) return;
+
+    const float x0 = SB_MAX(span->x0 - sbuffer->offset, 0);
+    const float x1 = SB_MIN(span->x1 - sbuffer->offset, sbuffer->size);
+    const int X0 = ceil(x0 - 0.5f), X1 = ceil(x1 - 0.5f);
+    for (int x = X0; x < X1; ++x) *(out + x) = SB_PRIM(sbuffer, span);
+
+    RasterizePrims(sbuffer, span->prev, out);
+    RasterizePrims(sbuffer, span->next, out);
+}
+
+//
+// NearestW
+// The reciprocal depth of the nearest of the segments in the projection at `x`
+// in screen space, zero if there is none.
+//
+static float NearestW (const sbprojection_t* projection, float x)
+{
+    float w = 0;
+
+    for (size_t k = 0; k < projection->count; ++k)
+    {
+        const float x0 = *(projection->x0 + k), x1 = *(projection->x1 + k);
+
+        if (x < x0 || x >= x1) continue;
+
+        const float w0 = *(projection->w0 + k), w1 = *(projection->w1 + k);
+
+        w = SB_MAX(w, w0 + (w1 - w0) * (x - x0) / (x1 - x0));
+    }
+
+    return w;
+}
+
+//
+// VerifyCameras
+// Look at the test case from a few more cameras than fit in a set of lanes,
+// each somewhere around the eye and turned some other way, all at once. Make
+// sure each camera's buffer holds, at each pixel, whatever is nearest of what
+// projecting for that camera alone gives -- which holds no matter the order
+// segments go in, unlike comparing against a buffer pushed one by one -- that
+// each pixel keeps the color of its segment, and that the camera sees every
+// segment in its picture.
+//
+static int VerifyCameras (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1, count = SB_LANES + 3;
+    const size_t n = tc->segs_count, bytes = (n + 7) >> 3;
+    float src_x[n + 1], src_y[n + 1], dst_x[n + 1], dst_y[n + 1];
+    byte_t ids[n + 1], bits[bytes + 1];
+    int colors[n + 1];
+    const sbprim_t* actual[size];
+    sbcamera_t poses[count];
+    size_t spans[count];
+    int mismatches = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        *(src_x + i) = seg.src.x; *(src_y + i) = seg.src.y;
+        *(dst_x + i) = seg.dst.x; *(dst_y + i) = seg.dst.y;
+        *(ids + i) = 65 + i;
+        *(colors + i) = seg.color;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sbcamera_t pose = {
+            SCREEN_HALFWIDTH + 40 * cosf(i), SCREEN_HEIGHT - 40 * sinf(i),
+            (i - count / 2) * 0.15f
+        };
+
+        *(poses + i) = pose;
+    }
+
+    sbcameras_t* cameras = SB_InitCameras(count, size, Z_NEAR, 10, n);
+    sbprojection_t* projection = SB_InitProjection(n);
+    sbuffer_t* reference = SB_Init(size, Z_NEAR, 10);
+
+    SB_ProjectCameras(cameras, poses, src_x, src_y, dst_x, dst_y, n);
+    SB_PushCameras(cameras, ids, colors);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sbuffer_t* sbuffer = *(cameras->buffers + i);
+
+        SB_ProjectMany(reference, poses + i, src_x, src_y, dst_x, dst_y, n,
+                       projection);
+
+        memset(actual, 0, sizeof(actual));
+        RasterizePrims(sbuffer, sbuffer->root, actual);
+
+        memset(bits, 0, bytes);
+        SB_CameraSeen(cameras, i, bits);
+
+        for (int x = 0; x < size; ++x)
+        {
+            const sbprim_t* prim = *(actual + x);
+            const float c = x + 0.5f;
+            const float w = NearestW(projection, c);
+
+            if (!prim)
+            {
+                mismatches += w > 0;
+                continue;
+            }
+
+            const int s = prim->payload;
+
+            mismatches += fabsf(SB_PRIM_W(prim, c) - w) > w * SB_EPS;
+            mismatches += prim->color != *(colors + s);
+            mismatches += !(*(bits + (s >> 3)) >> (s & 7) & 1);
+        }
+
+        *(spans + i) = 0;
+        CollectSpans(sbuffer->root, 0, spans + i);
+    }
+
+    /* pushing again starts the buffers over */
+    SB_PushCameras(cameras, ids, colors);
+
+    for (int i = 0; i < count; ++i)
+    {
+        size_t again = 0;
+
+        CollectSpans((*(cameras->buffers + i))->root, 0, &again);
+        mismatches += again != *(spans + i);
+    }
+
+    SB_Destroy(reference);
+    SB_DestroyProjection(projection);
+    SB_DestroyCameras(cameras);
+
+    return !mismatches;
+}
+
+//
+// VerifyViews
+// Look at the test case through a rig of a few views close to the eye -- two a
+// little to either side, as a stereo rig would, and one a little ahead and
+// turned -- all at once. Make sure each view's buffer holds, at each pixel,
+// whatever is nearest of what projecting for a camera where the view is gives,
+// the same way `VerifyCameras` does -- culling segments once for all the views
+// having left none of them out -- and that pushing again starts over.
+//
+static int VerifyViews (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1, count = 3;
+    const size_t n = tc->segs_count;
+    float src_x[n + 1], src_y[n + 1], dst_x[n + 1], dst_y[n + 1];
+    byte_t ids[n + 1];
+    int colors[n + 1];
+    const sbprim_t* actual[size];
+    const sbcamera_t rig = { SCREEN_HALFWIDTH, SCREEN_HEIGHT, 0.1f };
+    const sbcamera_t poses[] = { { -3, 0, 0 }, { 3, 0, 0 }, { 1, -8, -0.2f } };
+    size_t spans[count];
+    int mismatches = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const seg2_t seg = *(tc->segs + i);
+
+        *(src_x + i) = seg.src.x; *(src_y + i) = seg.src.y;
+        *(dst_x + i) = seg.dst.x; *(dst_y + i) = seg.dst.y;
+        *(ids + i) = 65 + i;
+        *(colors + i) = i;
+    }
+
+    sbviews_t* views = SB_InitViews(count, size, Z_NEAR, 10, n);
+    sbprojection_t* projection = SB_InitProjection(n);
+    sbuffer_t* reference = SB_Init(size, Z_NEAR, 10);
+
+    mismatches += SB_ProjectViews(views, &rig, poses,
+                                  src_x, src_y, dst_x, dst_y, n) > n;
+    SB_PushViews(views, ids, colors);
+
+    for (int i = 0; i < count; ++i)
+    {
+        const sbuffer_t* sbuffer = *(views->buffers + i);
+        const sbcamera_t* pose = poses + i;
+        const float c = cosf(rig.angle), s = sinf(rig.angle);
+        const sbcamera_t camera = {
+            rig.x + pose->x * c - pose->y * s,
+            rig.y + pose->x * s + pose->y * c,
+            rig.angle + pose->angle
+        };
+
+        SB_ProjectMany(reference, &camera, src_x, src_y, dst_x, dst_y, n,
+                       projection);
+
+        memset(actual, 0, sizeof(actual));
+        RasterizePrims(sbuffer, sbuffer->root, actual);
+
+        for (int x = 0; x < size; ++x)
+        {
+            const sbprim_t* prim = *(actual + x);
+            const float c = x + 0.5f;
+            const float w = NearestW(projection, c);
+
+            if (!prim) mismatches += w > 0;
+            else mismatches += fabsf(SB_PRIM_W(prim, c) - w) > w * SB_EPS;
+        }
+
+        *(spans + i) = 0;
+        CollectSpans(sbuffer->root, 0, spans + i);
+    }
+
+    SB_ProjectViews(views, &rig, poses, src_x, src_y, dst_x, dst_y, n);
+    SB_PushViews(views, ids, colors);
+
+    for (int i = 0; i < count; ++i)
+    {
+        size_t again = 0;
+
+        CollectSpans((*(views->buffers + i))->root, 0, &again);
+        mismatches += again != *(spans + i);
+    }
+
+    SB_Destroy(reference);
+    SB_DestroyProjection(projection);
+    SB_DestroyViews(views);
+
+    return !mismatches;
+}
+
+//
+// CylindricalMismatches
+// How many pixels of the screen of a cylindrical buffer hold anything else but
+// the nearest of the `n` segments in view space along the ray through them.
+//
+static
+int
+CylindricalMismatches
+( const sbuffer_t* sbuffer,
+  float z_near,
+  const float* vx0, const float* vz0,
+  const float* vx1, const float* vz1,
+  size_t n )
+{
+    const int size = sbuffer->size;
+    const sbprim_t* actual[size];
+    int mismatches = 0;
+
+    memset(actual, 0, sizeof(actual));
+    RasterizePrims(sbuffer, sbuffer->root, actual);
+
+    for (int x = 0; x < size; ++x)
+    {
+        const float phi = (x + 0.5f - size * 0.5f) / z_near;
+        const float dx = sinf(phi), dz = cosf(phi);
+        float w = 0;
+
+        /* how far along the ray each segment is, if at all */
+        for (size_t i = 0; i < n; ++i)
+        {
+            const float ex = *(vx1 + i) - *(vx0 + i);
+            const float ez = *(vz1 + i) - *(vz0 + i);
+            const float den = dx * ez - dz * ex;
+
+            if (den == 0) continue;
+
+            const float r = (*(vx0 + i) * ez - *(vz0 + i) * ex) / den;
+            const float u = (*(vx0 + i) * dz - *(vz0 + i) * dx) / den;
+
+            if (r > 0 && u >= 0 && u < 1) w = SB_MAX(w, 1 / r);
+        }
+
+        const sbprim_t* prim = *(actual + x);
+
+        if (!prim) mismatches += w > 0;
+        else
+            mismatches += fabsf(SB_CylindricalW(sbuffer, prim,
+                                                x + 0.5f + sbuffer->offset)
+                                - w) > w * SB_EPS;
+    }
+
+    return mismatches;
+}
+
+//
+// VerifyCylindrical
+// Push the test case onto a cylindrical buffer, and turn the camera this way
+// and that: a little at a time, back onto what the buffer has already seen,
+// and all the way around. Make sure that the buffer holds, at each pixel of the
+// screen, the nearest of the segments along the ray through it -- having only
+// pushed what each turn exposed -- and that turning back exposes nothing.
+//
+static int VerifyCylindrical (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const float z_near = size / 2.5f; // a little over 140 degrees across
+    const float turns[] = {
+        0.05f, 0.05f, 0.05f, 0.1f, 0.2f, -0.45f, -0.3f, -0.2f, 3
+    };
+    const int n_turns = sizeof(turns) / sizeof(*turns);
+    const size_t n = tc->segs_count;
+    float vx0[n + 1], vz0[n + 1], vx1[n + 1], vz1[n + 1];
+    float angle = -0.2f;
+    int mismatches = 0;
+    sbuffer_t* sbuffer = SB_InitCylindrical(size, z_near, 32);
+
+    for (int t = -1; t < n_turns; ++t)
+    {
+        float x0 = 0, x1 = size;
+        int exposed = 1;
+
+        if (t >= 0)
+        {
+            angle += *(turns + t);
+            exposed = SB_Turn(sbuffer, *(turns + t), &x0, &x1);
+            /* turning back within what was seen exposes nothing */
+            mismatches += t == 5 && exposed;
+        }
+
+        const float c = cosf(angle), s = sinf(angle);
+
+        /* into the view space of the camera, the way `SB_ProjectMany` does */
+        for (size_t i = 0; i < n; ++i)
+        {
+            const seg2_t seg = *(tc->segs + i);
+            const float sx = seg.src.x - SCREEN_HALFWIDTH;
+            const float sy = seg.src.y - SCREEN_HEIGHT;
+            const float dx = seg.dst.x - SCREEN_HALFWIDTH;
+            const float dy = seg.dst.y - SCREEN_HEIGHT;
+
+            *(vx0 + i) = sx * c + sy * s; *(vz0 + i) = sx * s - sy * c;
+            *(vx1 + i) = dx * c + dy * s; *(vz1 + i) = dx * s - dy * c;
+        }
+
+        if (exposed)
+        {
+            SB_PushClipWindow(sbuffer, x0, x1);
+
+            for (size_t i = 0; i < n; ++i)
+                SB_PushCylindrical(sbuffer,
+                                   *(vx0 + i), *(vz0 + i),
+                                   *(vx1 + i), *(vz1 + i),
+                                   65 + i, i);
+
+            SB_PopClipWindow(sbuffer);
+        }
+
+        mismatches += CylindricalMismatches(sbuffer, z_near,
+                                            vx0, vz0, vx1, vz1,
+                                            n);
+    }
+
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
+/* 1 if the verifier fails, naming it in the failure line -- on stderr, which
+ * needs no flushing before the child process leaves through `_exit`
+ */
+#define VERIFY(tc, verifier)                                                 \
+    ((verifier) ? 0 : (fprintf(stderr, "[test] ❌ Case %td/%d: %s failed\n", \
+                               (tc) - TEST_CASES + 1, N_CASES, #verifier), 1))
+
+//
+// VerifyTurnedRebalance
+// Turn a cylindrical buffer to the right, by a little more for each test case,
+// and raise five walls close by -- shaped into a tree leaning left at the root
+// -- with a wall far behind them all across the screen. Filling the leftmost
+// gap rotates the root in the middle of the push, and the rest of the gaps
+// should be filled all the way up to the right edge of what has been seen.
+//
+static int VerifyTurnedRebalance (const test_case_t* tc)
+{
+    const int size = SCREEN_HALFWIDTH << 1;
+    const float z_near = size / 2.5f;
+    /* in the order that leaves the tree leaning left: the root, its children,
+     * and then the children of its left child -- in screen space
+     */
+    const float walls[5][2] = {
+        { 400, 450 }, { 200, 250 }, { 500, 550 }, { 100, 150 }, { 300, 350 }
+    };
+    float vx0[6], vz0[6], vx1[6], vz1[6];
+    float x0, x1;
+    sbuffer_t* sbuffer = SB_InitCylindrical(size, z_near, 16);
+
+    SB_Turn(sbuffer, 0.1f + 0.05f * (tc - TEST_CASES), &x0, &x1);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        const float phi0 = (**(walls + i) - size * 0.5f) / z_near;
+        const float phi1 = (*(*(walls + i) + 1) - size * 0.5f) / z_near;
+
+        *(vx0 + i) = 100 * sinf(phi0); *(vz0 + i) = 100 * cosf(phi0);
+        *(vx1 + i) = 100 * sinf(phi1); *(vz1 + i) = 100 * cosf(phi1);
+    }
+
+    /* far enough to be behind the walls, and wide enough to fill the screen */
+    *(vx0 + 5) = -4000; *(vz0 + 5) = 1000;
+    *(vx1 + 5) = 4000; *(vz1 + 5) = 1000;
+
+    for (int i = 0; i < 6; ++i)
+        SB_PushCylindrical(sbuffer,
+                           *(vx0 + i), *(vz0 + i),
+                           *(vx1 + i), *(vz1 + i),
+                           65 + i, i);
+
+    const int mismatches = CylindricalMismatches(sbuffer, z_near,
+                                                 vx0, vz0, vx1, vz1,
+                                                 6);
+
+    SB_Destroy(sbuffer);
+
+    return !mismatches;
+}
+
 static int RunTestCase (const test_case_t* tc)
 {
     /* fork and run the test case in a separate process: it may fail or exit
@@ -72,10 +1830,39 @@ static int RunTestCase (const test_case_t* tc)
     if (!pid)
     {
         sbuffer_t* sbuffer = SB_Init(SCREEN_HALFWIDTH << 1, Z_NEAR, 10);
+        int failed = 0;
+
         PushSpans(sbuffer, tc);
+
+        /* run every verifier, rather than stopping at the first to fail, and
+         * name each one that does
+         */
+        failed += VERIFY(tc, VerifyCoverage(sbuffer));
+        failed += VERIFY(tc, VerifyPushView(sbuffer, tc));
+        failed += VERIFY(tc, VerifyBsp(sbuffer, tc));
+        failed += VERIFY(tc, VerifyProjectMany(sbuffer, tc));
+        failed += VERIFY(tc, VerifyIntersectMany(sbuffer, tc));
+        failed += VERIFY(tc, VerifyHomogeneous(sbuffer, tc));
+        failed += VERIFY(tc, VerifyBuckets(sbuffer, tc));
+        failed += VERIFY(tc, VerifyBatch(sbuffer, tc));
+        failed += VERIFY(tc, VerifyClipWindow(sbuffer, tc));
         SB_Destroy(sbuffer);
 
-        _exit(0);
+        failed += VERIFY(tc, VerifyDispatch(tc));
+        failed += VERIFY(tc, VerifyRows(tc));
+        failed += VERIFY(tc, VerifyCoherent(tc));
+        failed += VERIFY(tc, VerifyShareRows(tc));
+        failed += VERIFY(tc, VerifyInterpolated(tc));
+        failed += VERIFY(tc, VerifyColumns(tc));
+        failed += VERIFY(tc, VerifyPolar(tc));
+        failed += VERIFY(tc, VerifyLights(tc));
+        failed += VERIFY(tc, VerifySight(tc));
+        failed += VERIFY(tc, VerifyCameras(tc));
+        failed += VERIFY(tc, VerifyViews(tc));
+        failed += VERIFY(tc, VerifyCylindrical(tc));
+        failed += VERIFY(tc, VerifyTurnedRebalance(tc));
+
+        _exit(failed > 0);
     }
 
     int code;               // wait for the child process that executes the test